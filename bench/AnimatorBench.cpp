@@ -0,0 +1,120 @@
+/*
+* Copyright 2018-2022 Membrane Software <author@membranesoftware.com> https://membranesoftware.com
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+* this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+* this list of conditions and the following disclaimer in the documentation
+* and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors
+* may be used to endorse or promote products derived from this software without
+* specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*/
+// Program that measures Animator update throughput with a large number of concurrent Position and Color tweens
+
+#include "Config.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include "SDL2/SDL.h"
+#include "OsUtil.h"
+#include "Position.h"
+#include "Color.h"
+#include "Animator.h"
+
+static const int DefaultTweenCount = 10000;
+static const int UpdateCount = 1000;
+static const int UpdateDelay = 1; // milliseconds
+static const int TweenDuration = 3600000; // milliseconds
+
+// Start tweenCount tweens in animator, half on positions and half on colors, cycling through all easing curves
+static void startTweens (Animator *animator, Position *positions, Color *colors, int tweenCount) {
+	int i;
+
+	Animator::instance = animator;
+	for (i = 0; i < (tweenCount / 2); ++i) {
+		positions[i].assign (0.0f, 0.0f);
+		positions[i].setEasing ((Animator::Easing) (i % 4));
+		positions[i].translate ((float) i, (float) -i, TweenDuration);
+		colors[i].assign (0.0f, 0.0f, 0.0f, 1.0f);
+		colors[i].setEasing ((Animator::Easing) ((i + 1) % 4));
+		colors[i].translate (1.0f, 0.5f, 0.25f, 0.5f, TweenDuration);
+	}
+}
+
+// Run UpdateCount updates on animator and return the number of tweens evaluated per millisecond
+static double runUpdates (Animator *animator) {
+	int64_t t, t1, t2;
+	int i, count;
+
+	count = animator->getTweenCount ();
+	t = animator->currentTime;
+	t1 = OsUtil::getMonotonicTime ();
+	for (i = 0; i < UpdateCount; ++i) {
+		t += ((int64_t) UpdateDelay) * 1000000;
+		animator->update (t);
+	}
+	t2 = OsUtil::getMonotonicTime ();
+	if (t2 <= t1) {
+		return (0.0);
+	}
+	return (((double) count) * ((double) UpdateCount) / (((double) (t2 - t1)) / 1000000.0));
+}
+
+int main (int argc, char **argv) {
+	Animator *animator;
+	Position *positions;
+	Color *colors;
+	int tweencount;
+	double scalarrate, simdrate;
+
+	tweencount = DefaultTweenCount;
+	if (argc > 1) {
+		tweencount = atoi (argv[1]);
+		if (tweencount < 2) {
+			tweencount = 2;
+		}
+	}
+
+	positions = new Position[tweencount / 2];
+	colors = new Color[tweencount / 2];
+
+	animator = new Animator ();
+	animator->isSimdEnabled = false;
+	startTweens (animator, positions, colors, tweencount);
+	scalarrate = runUpdates (animator);
+	Animator::instance = NULL;
+	delete (animator);
+
+	simdrate = 0.0;
+	if (Animator::isSimdSupported ()) {
+		animator = new Animator ();
+		animator->isSimdEnabled = true;
+		startTweens (animator, positions, colors, tweencount);
+		simdrate = runUpdates (animator);
+		Animator::instance = NULL;
+		delete (animator);
+	}
+
+	printf ("animator.update tweens=%i updates=%i scalarTweensPerMs=%.0f simdTweensPerMs=%.0f isSimdSupported=%s\n", tweencount, UpdateCount, scalarrate, simdrate, BOOL_STRING (Animator::isSimdSupported ()));
+
+	delete[] positions;
+	delete[] colors;
+	return (0);
+}
@@ -0,0 +1,528 @@
+/*
+* Copyright 2018-2022 Membrane Software <author@membranesoftware.com> https://membranesoftware.com
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+* this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+* this list of conditions and the following disclaimer in the documentation
+* and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors
+* may be used to endorse or promote products derived from this software without
+* specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*/
+// Program that measures throughput of the core utility classes (StdString, StringList, Buffer, HashMap, Json, SystemInterface) and optionally compares results against a baseline file
+
+#include "Config.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <list>
+#include "SDL2/SDL.h"
+#include "StdString.h"
+#include "StringList.h"
+#include "OsUtil.h"
+#include "Prng.h"
+#include "Buffer.h"
+#include "HashMap.h"
+#include "Json.h"
+#include "SystemInterface.h"
+
+static const uint32_t PrngSeed = 1;
+static const int TextLength = 1024; // characters
+static const int SplitFieldCount = 100;
+static const int HashMapKeyCount = 1000;
+static const int JsonKeyCount = 1000;
+static const int BufferTargetLength = 1048576; // bytes
+static const int BufferChunkLength = 64; // bytes
+static const char *HashMapFilename = "util-bench-hashmap.tmp";
+static const char *AuthSecret = "util-bench-secret";
+static const char *TextWords[] = { "Media", "Library", "Stream", "Thumbnail", "Playlist", "Camera", "Monitor", "Agent", "Broadcast", "Catalog" };
+static const int TextWordCount = 10;
+static const char TextPunctuation[] = { ' ', '/', '&', '"', '\\', '\n', '?', '=' };
+static const int TextPunctuationCount = 8;
+
+struct BenchData {
+	Prng prng;
+	StdString text;
+	StdString splitText;
+	StdString jsonText;
+	StringList keys;
+	HashMap hashMap;
+	Json *jsonObject;
+	Json *command;
+	std::list<SystemInterface::Param> commandParamList;
+	SystemInterface *systemInterface;
+	BenchData ():
+		jsonObject (NULL),
+		command (NULL),
+		systemInterface (NULL) { }
+};
+
+typedef int (*BenchFunction) (BenchData *data, int iterations);
+
+struct BenchCase {
+	const char *name;
+	BenchFunction fn;
+	int iterations;
+};
+
+// Values derived from benchmark results, accumulated so that the compiler can't discard the measured operations
+static volatile int64_t resultSink = 0;
+
+// Context and functions used to provide SystemInterface with an FNV-1a hash
+struct HashContext {
+	uint64_t hash;
+	HashContext (): hash (14695981039346656037ULL) { }
+};
+static void hashUpdate (void *contextPtr, unsigned char *data, int dataLength) {
+	HashContext *context;
+	int i;
+
+	context = (HashContext *) contextPtr;
+	for (i = 0; i < dataLength; ++i) {
+		context->hash ^= (uint64_t) data[i];
+		context->hash *= 1099511628211ULL;
+	}
+}
+static StdString hashDigest (void *contextPtr) {
+	return (StdString::createSprintf ("%016llx", (unsigned long long) ((HashContext *) contextPtr)->hash));
+}
+
+// Return the number of milliseconds elapsed since the provided monotonic clock value
+static double getElapsedMs (int64_t startTime) {
+	return (((double) (OsUtil::getMonotonicTime () - startTime)) / 1000000.0);
+}
+
+// Return ops divided by ms, or zero if ms is not positive
+static double getRate (double ops, double ms) {
+	if (ms <= 0.0) {
+		return (0.0);
+	}
+	return (ops / ms);
+}
+
+// Populate data with the inputs used by all benchmark cases, choosing text content with data->prng
+static void setupData (BenchData *data) {
+	StdString key;
+	Json *item;
+	int i;
+
+	data->prng.seed (PrngSeed);
+	data->text.assign ("");
+	while ((int) data->text.length () < TextLength) {
+		data->text.append (TextWords[data->prng.getRandomValue (0, TextWordCount - 1)]);
+		data->text.append (1, TextPunctuation[data->prng.getRandomValue (0, TextPunctuationCount - 1)]);
+	}
+
+	data->splitText.assign ("");
+	for (i = 0; i < SplitFieldCount; ++i) {
+		if (i > 0) {
+			data->splitText.append (",");
+		}
+		data->splitText.append (TextWords[data->prng.getRandomValue (0, TextWordCount - 1)]);
+	}
+
+	data->keys.clear ();
+	data->hashMap.clear ();
+	for (i = 0; i < HashMapKeyCount; ++i) {
+		key.sprintf ("%s_%i", TextWords[i % TextWordCount], i);
+		data->keys.push_back (key);
+		data->hashMap.insert (key, data->prng.getRandomValue (0, 1000000));
+	}
+
+	data->jsonObject = new Json ();
+	for (i = 0; i < JsonKeyCount; ++i) {
+		key.sprintf ("key%i", i);
+		switch (i % 4) {
+			case 0: {
+				data->jsonObject->set (key, TextWords[i % TextWordCount]);
+				break;
+			}
+			case 1: {
+				data->jsonObject->set (key, (int64_t) data->prng.getRandomValue (0, 1000000));
+				break;
+			}
+			case 2: {
+				data->jsonObject->set (key, (double) data->prng.getRandomValue (0.0f, 1.0f));
+				break;
+			}
+			default: {
+				item = new Json ();
+				item->set ("id", StdString::createSprintf ("%i", i));
+				item->set ("name", TextWords[i % TextWordCount]);
+				item->set ("isEnabled", (i % 2) == 0);
+				data->jsonObject->set (key, item);
+				break;
+			}
+		}
+	}
+	data->jsonText = data->jsonObject->toString ();
+
+	data->systemInterface = new SystemInterface ();
+	SystemInterface::instance = data->systemInterface;
+	data->systemInterface->getType (SystemInterface::Command_FindMediaItems, &(data->commandParamList));
+	item = new Json ();
+	item->set ("searchKey", StdString (data->text.substr (0, 64)));
+	item->set ("resultOffset", 0);
+	item->set ("maxResults", 100);
+	data->command = data->systemInterface->createCommand (SystemInterface::Prefix (), SystemInterface::Command_FindMediaItems, item);
+}
+
+// Free objects held by data
+static void clearData (BenchData *data) {
+	if (data->command) {
+		delete (data->command);
+		data->command = NULL;
+	}
+	if (data->jsonObject) {
+		delete (data->jsonObject);
+		data->jsonObject = NULL;
+	}
+	SystemInterface::instance = NULL;
+	if (data->systemInterface) {
+		delete (data->systemInterface);
+		data->systemInterface = NULL;
+	}
+}
+
+static int runStdStringSprintf (BenchData *data, int iterations) {
+	StdString s;
+	int i;
+
+	for (i = 0; i < iterations; ++i) {
+		s.sprintf ("%s/%i/%.3f/%llx", TextWords[i % TextWordCount], i, (double) i / 7.0f, (unsigned long long) i * 31);
+		resultSink += s.length ();
+	}
+	return (iterations);
+}
+
+static int runStdStringAppendSprintf (BenchData *data, int iterations) {
+	StdString s;
+	int i;
+
+	for (i = 0; i < iterations; ++i) {
+		if ((i % 1000) == 0) {
+			resultSink += s.length ();
+			s.assign ("");
+		}
+		s.appendSprintf ("%s=%i;", TextWords[i % TextWordCount], i);
+	}
+	resultSink += s.length ();
+	return (iterations);
+}
+
+static int runStdStringReplace (BenchData *data, int iterations) {
+	StdString s;
+	int i;
+
+	for (i = 0; i < iterations; ++i) {
+		s.assign (data->text);
+		s.replace (StdString ("Media"), StdString ("Item"));
+		s.replace (StdString ("/"), StdString ("%2F"));
+		resultSink += s.length ();
+	}
+	return (iterations);
+}
+
+static int runStdStringSplit (BenchData *data, int iterations) {
+	std::list<StdString> parts;
+	int i;
+
+	for (i = 0; i < iterations; ++i) {
+		data->splitText.split (",", &parts);
+		resultSink += parts.size ();
+	}
+	return (iterations);
+}
+
+static int runStdStringUrlEncode (BenchData *data, int iterations) {
+	int i;
+
+	for (i = 0; i < iterations; ++i) {
+		resultSink += data->text.urlEncoded ().length ();
+	}
+	return (iterations);
+}
+
+static int runStdStringBase64Encode (BenchData *data, int iterations) {
+	int i;
+
+	for (i = 0; i < iterations; ++i) {
+		resultSink += data->text.base64Encoded ().length ();
+	}
+	return (iterations);
+}
+
+static int runStdStringJsonEscape (BenchData *data, int iterations) {
+	int i;
+
+	for (i = 0; i < iterations; ++i) {
+		resultSink += data->text.jsonEscaped ().length ();
+	}
+	return (iterations);
+}
+
+static int runStringListInsertInOrder (BenchData *data, int iterations) {
+	StringList list;
+	StringList::const_iterator pos;
+	int i;
+
+	pos = data->keys.cbegin ();
+	for (i = 0; i < iterations; ++i) {
+		if ((i % 1000) == 0) {
+			resultSink += list.size ();
+			list.clear ();
+		}
+		list.insertInOrder (data->keys.loopNext (&pos));
+	}
+	resultSink += list.size ();
+	return (iterations);
+}
+
+static int runStringListJoin (BenchData *data, int iterations) {
+	int i;
+
+	for (i = 0; i < iterations; ++i) {
+		resultSink += data->keys.join (",").length ();
+	}
+	return (iterations);
+}
+
+static int runBufferAdd (BenchData *data, int iterations) {
+	Buffer *buffer;
+	uint8_t chunk[BufferChunkLength];
+	int i, count;
+
+	for (i = 0; i < BufferChunkLength; ++i) {
+		chunk[i] = (uint8_t) i;
+	}
+	count = 0;
+	for (i = 0; i < iterations; ++i) {
+		buffer = new Buffer ();
+		while (buffer->length < BufferTargetLength) {
+			buffer->add (chunk, BufferChunkLength);
+			++count;
+		}
+		resultSink += buffer->length;
+		delete (buffer);
+	}
+	return (count);
+}
+
+static int runHashMapWrite (BenchData *data, int iterations) {
+	int i;
+
+	for (i = 0; i < iterations; ++i) {
+		if (data->hashMap.write (HashMapFilename) != OsUtil::Success) {
+			return (0);
+		}
+	}
+	return (iterations);
+}
+
+static int runHashMapRead (BenchData *data, int iterations) {
+	HashMap map;
+	int i;
+
+	if (data->hashMap.write (HashMapFilename) != OsUtil::Success) {
+		return (0);
+	}
+	for (i = 0; i < iterations; ++i) {
+		if (map.read (HashMapFilename, true) != OsUtil::Success) {
+			return (0);
+		}
+		resultSink += map.size ();
+	}
+	remove (HashMapFilename);
+	return (iterations);
+}
+
+static int runHashMapFind (BenchData *data, int iterations) {
+	StringList::const_iterator pos;
+	int i;
+
+	pos = data->keys.cbegin ();
+	for (i = 0; i < iterations; ++i) {
+		resultSink += data->hashMap.find (data->keys.loopNext (&pos), (int) 0);
+	}
+	return (iterations);
+}
+
+static int runJsonParse (BenchData *data, int iterations) {
+	Json json;
+	int i;
+
+	for (i = 0; i < iterations; ++i) {
+		if (! json.parse (data->jsonText)) {
+			return (0);
+		}
+	}
+	resultSink += json.getNumber ("key1", (int) 0);
+	return (iterations);
+}
+
+static int runJsonToString (BenchData *data, int iterations) {
+	int i;
+
+	for (i = 0; i < iterations; ++i) {
+		resultSink += data->jsonObject->toString ().length ();
+	}
+	return (iterations);
+}
+
+static int runJsonGetString (BenchData *data, int iterations) {
+	StdString key;
+	int i;
+
+	for (i = 0; i < iterations; ++i) {
+		key.sprintf ("key%i", (i % (JsonKeyCount / 4)) * 4);
+		resultSink += data->jsonObject->getString (key, "").length ();
+	}
+	return (iterations);
+}
+
+static int runSystemInterfaceCreateCommand (BenchData *data, int iterations) {
+	SystemInterface::Prefix prefix;
+	Json *params, *cmd;
+	int i;
+
+	prefix.agentId.assign ("util-bench");
+	prefix.createTime = OsUtil::getTime ();
+	for (i = 0; i < iterations; ++i) {
+		params = new Json ();
+		params->set ("searchKey", TextWords[i % TextWordCount]);
+		params->set ("maxResults", 100);
+		cmd = data->systemInterface->createCommand (prefix, SystemInterface::Command_FindMediaItems, params);
+		if (! cmd) {
+			return (0);
+		}
+		resultSink += data->systemInterface->getCommandId (cmd);
+		delete (cmd);
+	}
+	return (iterations);
+}
+
+static int runSystemInterfaceFieldsValid (BenchData *data, int iterations) {
+	Json params;
+	int i;
+
+	if ((! data->command) || (! data->command->getObject ("params", &params))) {
+		return (0);
+	}
+	for (i = 0; i < iterations; ++i) {
+		if (! data->systemInterface->fieldsValid (&params, &(data->commandParamList))) {
+			return (0);
+		}
+	}
+	return (iterations);
+}
+
+static int runSystemInterfaceAuthorizationHash (BenchData *data, int iterations) {
+	HashContext context;
+	int i;
+
+	if (! data->command) {
+		return (0);
+	}
+	for (i = 0; i < iterations; ++i) {
+		context = HashContext ();
+		resultSink += data->systemInterface->getCommandAuthorizationHash (data->command, AuthSecret, StdString ("util-bench-token"), hashUpdate, hashDigest, &context).length ();
+	}
+	return (iterations);
+}
+
+static const BenchCase BenchCases[] = {
+	{ "util.stdString.sprintf", runStdStringSprintf, 200000 },
+	{ "util.stdString.appendSprintf", runStdStringAppendSprintf, 200000 },
+	{ "util.stdString.replace", runStdStringReplace, 20000 },
+	{ "util.stdString.split", runStdStringSplit, 20000 },
+	{ "util.stdString.urlEncode", runStdStringUrlEncode, 20000 },
+	{ "util.stdString.base64Encode", runStdStringBase64Encode, 20000 },
+	{ "util.stdString.jsonEscape", runStdStringJsonEscape, 20000 },
+	{ "util.stringList.insertInOrder", runStringListInsertInOrder, 20000 },
+	{ "util.stringList.join", runStringListJoin, 2000 },
+	{ "util.buffer.add", runBufferAdd, 50 },
+	{ "util.hashMap.write", runHashMapWrite, 200 },
+	{ "util.hashMap.read", runHashMapRead, 200 },
+	{ "util.hashMap.find", runHashMapFind, 500000 },
+	{ "util.json.parse", runJsonParse, 200 },
+	{ "util.json.toString", runJsonToString, 200 },
+	{ "util.json.getString", runJsonGetString, 20000 },
+	{ "util.systemInterface.createCommand", runSystemInterfaceCreateCommand, 20000 },
+	{ "util.systemInterface.fieldsValid", runSystemInterfaceFieldsValid, 100000 },
+	{ "util.systemInterface.getCommandAuthorizationHash", runSystemInterfaceAuthorizationHash, 50000 }
+};
+static const int BenchCaseCount = (int) (sizeof (BenchCases) / sizeof (BenchCases[0]));
+
+// Usage: util-bench [baseline-file] or util-bench -w baseline-file. With a baseline file, each result line includes the baseline opsPerMs value and the ratio of measured to baseline throughput; -w writes the measured values as a new baseline file instead.
+int main (int argc, char **argv) {
+	BenchData data;
+	HashMap baseline, results;
+	StdString baselinefile, writefile;
+	int64_t t1;
+	double ms, rate, baserate;
+	int i, ops, failcount;
+
+	if ((argc == 3) && StdString (argv[1]).equals ("-w")) {
+		writefile.assign (argv[2]);
+	}
+	else if ((argc == 2) && (argv[1][0] != '-')) {
+		baselinefile.assign (argv[1]);
+		if (baseline.read (baselinefile) != OsUtil::Success) {
+			printf ("Failed to read baseline file %s\n", baselinefile.c_str ());
+			return (1);
+		}
+	}
+	else if (argc != 1) {
+		fprintf (stderr, "Usage: %s [baseline-file]\n       %s -w baseline-file\n", argv[0], argv[0]);
+		return (1);
+	}
+
+	setupData (&data);
+	failcount = 0;
+	for (i = 0; i < BenchCaseCount; ++i) {
+		t1 = OsUtil::getMonotonicTime ();
+		ops = BenchCases[i].fn (&data, BenchCases[i].iterations);
+		ms = getElapsedMs (t1);
+		if (ops <= 0) {
+			printf ("%s failed\n", BenchCases[i].name);
+			++failcount;
+			continue;
+		}
+
+		rate = getRate ((double) ops, ms);
+		results.insert (BenchCases[i].name, StdString::createSprintf ("%.1f", rate));
+		if (! baselinefile.empty ()) {
+			baserate = baseline.find (BenchCases[i].name, (double) 0.0);
+			printf ("%s iterations=%i ops=%i ms=%.3f opsPerMs=%.1f baselineOpsPerMs=%.1f ratio=%.2f\n", BenchCases[i].name, BenchCases[i].iterations, ops, ms, rate, baserate, (baserate > 0.0) ? (rate / baserate) : 0.0);
+		}
+		else {
+			printf ("%s iterations=%i ops=%i ms=%.3f opsPerMs=%.1f\n", BenchCases[i].name, BenchCases[i].iterations, ops, ms, rate);
+		}
+	}
+	clearData (&data);
+
+	if (! writefile.empty ()) {
+		if (results.write (writefile) != OsUtil::Success) {
+			printf ("Failed to write baseline file %s\n", writefile.c_str ());
+			return (1);
+		}
+	}
+	return ((failcount > 0) ? 1 : 0);
+}
@@ -0,0 +1,297 @@
+/*
+* Copyright 2018-2022 Membrane Software <author@membranesoftware.com> https://membranesoftware.com
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+* this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+* this list of conditions and the following disclaimer in the documentation
+* and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors
+* may be used to endorse or promote products derived from this software without
+* specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*/
+// Program that measures widget tree update, layout, hit-test, and draw throughput using the SDL dummy video driver and software renderer
+
+#include "Config.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <vector>
+#include "SDL2/SDL.h"
+#include "SDL2/SDL_image.h"
+#include "StdString.h"
+#include "OsUtil.h"
+#include "App.h"
+#include "Prng.h"
+#include "Resource.h"
+#include "UiConfiguration.h"
+#include "DrawList.h"
+#include "Widget.h"
+#include "Panel.h"
+#include "Label.h"
+#include "Image.h"
+
+static const int DefaultLabelCount = 10000;
+static const int LabelsPerPanel = 10;
+static const int PanelsPerGroup = 10;
+static const int WindowWidth = 1280;
+static const int WindowHeight = 720;
+static const uint32_t PrngSeed = 1;
+static const int UpdateCount = 100;
+static const int UpdateDelay = 16; // milliseconds
+static const int LayoutCount = 10;
+static const int PartialLayoutCount = 100;
+static const int PartialLayoutLabelStride = 100; // Partial layout passes change the text of one label in this many
+static const int HitTestCount = 100000;
+static const int DrawCount = 100;
+static const char *LabelWords[] = { "Media", "Library", "Stream", "Thumbnail", "Playlist", "Camera", "Monitor", "Agent", "Broadcast", "Catalog" };
+static const int LabelWordCount = 10;
+
+struct BenchTree {
+	Panel *rootPanel;
+	std::vector<Label *> labels;
+	int panelCount;
+	int imageCount;
+	BenchTree ():
+		rootPanel (NULL),
+		panelCount (0),
+		imageCount (0) { }
+};
+
+// Return the number of milliseconds elapsed since the provided monotonic clock value
+static double getElapsedMs (int64_t startTime) {
+	return (((double) (OsUtil::getMonotonicTime () - startTime)) / 1000000.0);
+}
+
+// Return ops divided by ms, or zero if ms is not positive
+static double getRate (double ops, double ms) {
+	if (ms <= 0.0) {
+		return (0.0);
+	}
+	return (ops / ms);
+}
+
+// Populate tree with labelCount labels held in nested panels, placing widgets at positions chosen by prng. Group panels stack their panels vertically, and each innermost panel holds an image followed by its labels in a horizontal row.
+static void buildTree (BenchTree *tree, Prng *prng, int labelCount) {
+	Panel *group, *panel;
+	Label *label;
+	Sprite *sprite;
+	int i;
+
+	tree->rootPanel = new Panel ();
+	tree->rootPanel->retain ();
+	tree->rootPanel->setFixedSize (true, (float) WindowWidth, (float) WindowHeight);
+	App::instance->rootPanel = tree->rootPanel;
+	sprite = UiConfiguration::instance->coreSprites.getSprite (UiConfiguration::OkButtonSprite);
+
+	group = NULL;
+	panel = NULL;
+	for (i = 0; i < labelCount; ++i) {
+		if ((i % (LabelsPerPanel * PanelsPerGroup)) == 0) {
+			group = (Panel *) tree->rootPanel->addWidget (new Panel (), (float) prng->getRandomValue (0, WindowWidth / 2), (float) prng->getRandomValue (0, WindowHeight / 2));
+			group->setLayout (Panel::VerticalLayout);
+			++(tree->panelCount);
+		}
+		if ((i % LabelsPerPanel) == 0) {
+			panel = (Panel *) group->addWidget (new Panel (), (float) prng->getRandomValue (0, WindowWidth / 4), (float) prng->getRandomValue (0, WindowHeight / 4));
+			panel->setLayout (Panel::HorizontalLayout);
+			++(tree->panelCount);
+			if (sprite) {
+				panel->addWidget (new Image (sprite), 0.0f, 0.0f);
+				++(tree->imageCount);
+			}
+		}
+		label = (Label *) panel->addWidget (new Label (StdString (LabelWords[prng->getRandomValue (0, LabelWordCount - 1)]), UiConfiguration::CaptionFont, UiConfiguration::instance->primaryTextColor), (float) prng->getRandomValue (0, WindowWidth / 4), (float) prng->getRandomValue (0, WindowHeight / 4));
+		tree->labels.push_back (label);
+	}
+
+	// The first update moves newly added widgets into each panel's widget list, and the first refresh lays them out
+	tree->rootPanel->update (0, 0.0f, 0.0f);
+	tree->rootPanel->refresh ();
+}
+
+int main (int argc, char **argv) {
+	BenchTree tree;
+	Prng prng;
+	App *app;
+	DrawList drawlist;
+	SDL_Window *window;
+	SDL_Renderer *render;
+	StdString path;
+	std::vector<Label *>::iterator li, lend;
+	int64_t t, t2;
+	double ms, recordms, executems;
+	int labelcount, widgetcount, hitcount, changecount, result, i;
+
+	labelcount = DefaultLabelCount;
+	if (argc > 1) {
+		labelcount = atoi (argv[1]);
+		if (labelcount < 1) {
+			labelcount = 1;
+		}
+	}
+
+	OsUtil::setEnvValue (StdString ("SDL_VIDEODRIVER"), StdString ("dummy"));
+	SDL_SetHint (SDL_HINT_RENDER_DRIVER, "software");
+	if (SDL_Init (SDL_INIT_VIDEO | SDL_INIT_TIMER) != 0) {
+		fprintf (stderr, "Failed to start SDL: %s\n", SDL_GetError ());
+		return (1);
+	}
+	IMG_Init (IMG_INIT_JPG | IMG_INIT_PNG);
+	window = SDL_CreateWindow ("WidgetBench", 0, 0, WindowWidth, WindowHeight, SDL_WINDOW_HIDDEN);
+	if (! window) {
+		fprintf (stderr, "Failed to create window: %s\n", SDL_GetError ());
+		return (1);
+	}
+	render = SDL_CreateRenderer (window, -1, SDL_RENDERER_SOFTWARE);
+	if (! render) {
+		fprintf (stderr, "Failed to create software renderer: %s\n", SDL_GetError ());
+		return (1);
+	}
+
+	App::createInstance (true);
+	app = App::instance;
+	app->window = window;
+	app->render = render;
+	app->windowWidth = WindowWidth;
+	app->windowHeight = WindowHeight;
+	app->clipRect.x = 0;
+	app->clipRect.y = 0;
+	app->clipRect.w = WindowWidth;
+	app->clipRect.h = WindowHeight;
+
+	path = OsUtil::getEnvValue ("RESOURCE_PATH", "");
+	if (path.empty ()) {
+		path.sprintf ("%s.dat", APPLICATION_PACKAGE_NAME);
+	}
+	app->resource.setSource (path);
+	result = app->resource.open ();
+	if (result != OsUtil::Success) {
+		fprintf (stderr, "Failed to open application resources; path=\"%s\" err=%i\n", path.c_str (), result);
+		return (1);
+	}
+	app->uiConfig.resetScale ();
+	result = app->uiConfig.load (1.0f);
+	if (result != OsUtil::Success) {
+		fprintf (stderr, "Failed to load application resources; err=%i\n", result);
+		return (1);
+	}
+
+	prng.seed (PrngSeed);
+	t = OsUtil::getMonotonicTime ();
+	buildTree (&tree, &prng, labelcount);
+	ms = getElapsedMs (t);
+	widgetcount = labelcount + tree.panelCount + tree.imageCount + 1;
+	printf ("widget.build labels=%i panels=%i images=%i widgets=%i ms=%.3f widgetsPerMs=%.1f\n", labelcount, tree.panelCount, tree.imageCount, widgetcount, ms, getRate ((double) widgetcount, ms));
+
+	t = OsUtil::getMonotonicTime ();
+	for (i = 0; i < UpdateCount; ++i) {
+		tree.rootPanel->update (UpdateDelay, 0.0f, 0.0f);
+	}
+	ms = getElapsedMs (t);
+	printf ("widget.update widgets=%i iterations=%i msPerIteration=%.3f widgetsPerMs=%.1f\n", widgetcount, UpdateCount, ms / UpdateCount, getRate ((double) widgetcount * UpdateCount, ms));
+
+	// Each layout pass sets new text on every label, invalidating the layout of every panel, and refreshes the tree
+	t = OsUtil::getMonotonicTime ();
+	for (i = 0; i < LayoutCount; ++i) {
+		li = tree.labels.begin ();
+		lend = tree.labels.end ();
+		while (li != lend) {
+			(*li)->setText (StdString (LabelWords[prng.getRandomValue (0, LabelWordCount - 1)]));
+			++li;
+		}
+		tree.rootPanel->refresh ();
+		tree.rootPanel->update (0, 0.0f, 0.0f);
+	}
+	ms = getElapsedMs (t);
+	printf ("widget.layout labels=%i iterations=%i msPerIteration=%.3f labelsPerMs=%.1f\n", labelcount, LayoutCount, ms / LayoutCount, getRate ((double) labelcount * LayoutCount, ms));
+
+	// Each partial layout pass changes a small fraction of labels, so that the refresh lays out only the panels along their paths to the root
+	changecount = 0;
+	t = OsUtil::getMonotonicTime ();
+	for (i = 0; i < PartialLayoutCount; ++i) {
+		li = tree.labels.begin () + (i % PartialLayoutLabelStride);
+		while (li < tree.labels.end ()) {
+			(*li)->setText (StdString (LabelWords[prng.getRandomValue (0, LabelWordCount - 1)]));
+			++changecount;
+			if ((tree.labels.end () - li) <= PartialLayoutLabelStride) {
+				break;
+			}
+			li += PartialLayoutLabelStride;
+		}
+		tree.rootPanel->refresh ();
+		tree.rootPanel->update (0, 0.0f, 0.0f);
+	}
+	ms = getElapsedMs (t);
+	printf ("widget.layoutPartial labels=%i changedLabels=%i iterations=%i msPerIteration=%.3f\n", labelcount, changecount, PartialLayoutCount, ms / PartialLayoutCount);
+
+	hitcount = 0;
+	t = OsUtil::getMonotonicTime ();
+	for (i = 0; i < HitTestCount; ++i) {
+		if (tree.rootPanel->findWidget ((float) prng.getRandomValue (0, WindowWidth - 1), (float) prng.getRandomValue (0, WindowHeight - 1))) {
+			++hitcount;
+		}
+	}
+	ms = getElapsedMs (t);
+	printf ("widget.hitTest widgets=%i queries=%i hits=%i queriesPerMs=%.1f\n", widgetcount, HitTestCount, hitcount, getRate ((double) HitTestCount, ms));
+
+	t = OsUtil::getMonotonicTime ();
+	for (i = 0; i < DrawCount; ++i) {
+		SDL_RenderClear (render);
+		drawlist.begin (WindowWidth, WindowHeight, render);
+		tree.rootPanel->draw (&drawlist);
+		drawlist.end ();
+		SDL_RenderPresent (render);
+	}
+	ms = getElapsedMs (t);
+	printf ("widget.draw widgets=%i frames=%i msPerFrame=%.3f drawnWidgets=%i culledWidgets=%i framesPerSecond=%.1f\n", widgetcount, DrawCount, ms / DrawCount, drawlist.drawnWidgetCount, drawlist.culledWidgetCount, getRate ((double) DrawCount * 1000.0, ms));
+
+	// Recorded frames follow the draw list path used by the update thread, replaying retained commands for widgets unchanged since the previous frame
+	recordms = 0.0;
+	executems = 0.0;
+	for (i = 0; i < DrawCount; ++i) {
+		t = OsUtil::getMonotonicTime ();
+		drawlist.sequence = i + 1;
+		drawlist.begin (WindowWidth, WindowHeight);
+		tree.rootPanel->draw (&drawlist);
+		drawlist.end ();
+		t2 = OsUtil::getMonotonicTime ();
+		recordms += ((double) (t2 - t)) / 1000000.0;
+		SDL_RenderClear (render);
+		drawlist.execute (render);
+		SDL_RenderPresent (render);
+		executems += getElapsedMs (t2);
+	}
+	printf ("widget.drawRecorded widgets=%i frames=%i recordMsPerFrame=%.3f executeMsPerFrame=%.3f commands=%i drawnWidgets=%i culledWidgets=%i cachedWidgets=%i framesPerSecond=%.1f\n", widgetcount, DrawCount, recordms / DrawCount, executems / DrawCount, drawlist.getCommandCount (), drawlist.drawnWidgetCount, drawlist.culledWidgetCount, drawlist.cachedWidgetCount, getRate ((double) DrawCount * 1000.0, recordms + executems));
+
+	tree.labels.clear ();
+	tree.rootPanel->release ();
+	tree.rootPanel = NULL;
+	app->rootPanel = NULL;
+	app->uiConfig.unload ();
+	app->resource.compact ();
+	app->resource.close ();
+	SDL_DestroyRenderer (render);
+	app->render = NULL;
+	SDL_DestroyWindow (window);
+	app->window = NULL;
+	App::freeInstance ();
+
+	return (0);
+}
@@ -0,0 +1,483 @@
+/*
+* Copyright 2018-2022 Membrane Software <author@membranesoftware.com> https://membranesoftware.com
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+* this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+* this list of conditions and the following disclaimer in the documentation
+* and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors
+* may be used to endorse or promote products derived from this software without
+* specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "Config.h"
+#include <stdlib.h>
+#include <vector>
+#if defined (__SSE2__) || defined (_M_X64) || (defined (_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define ANIMATOR_SSE2 1
+#include <emmintrin.h>
+#else
+#define ANIMATOR_SSE2 0
+#endif
+#include "SDL2/SDL.h"
+#include "OsUtil.h"
+#include "Position.h"
+#include "Color.h"
+#include "Animator.h"
+
+Animator *Animator::instance = NULL;
+
+const int Animator::InitialTweenCapacity = 64;
+
+Animator::Animator ()
+: isSimdEnabled (true)
+, currentTime (0)
+, tweenMutex (NULL)
+{
+	int i;
+
+	currentTime = OsUtil::getMonotonicTime ();
+	tweenMutex = SDL_CreateMutex ();
+	tweenContexts.reserve (Animator::InitialTweenCapacity);
+	tweenEasings.reserve (Animator::InitialTweenCapacity);
+	tweenProgress.reserve (Animator::InitialTweenCapacity);
+	for (i = 0; i < Animator::ChannelCount; ++i) {
+		tweenStartValues[i].reserve (Animator::InitialTweenCapacity);
+		tweenTargetValues[i].reserve (Animator::InitialTweenCapacity);
+		tweenValues[i].reserve (Animator::InitialTweenCapacity);
+	}
+}
+
+Animator::~Animator () {
+	std::vector<Animator::TweenContext>::iterator i, end;
+
+	// Detach any objects that still hold tweens, since they may outlive the animator
+	i = tweenContexts.begin ();
+	end = tweenContexts.end ();
+	while (i != end) {
+		if (i->position) {
+			i->position->isTranslating = false;
+			i->position->tweenIndex = -1;
+		}
+		if (i->color) {
+			i->color->isTranslating = false;
+			i->color->isAnimating = false;
+			i->color->tweenIndex = -1;
+		}
+		++i;
+	}
+	tweenContexts.clear ();
+
+	if (tweenMutex) {
+		SDL_DestroyMutex (tweenMutex);
+		tweenMutex = NULL;
+	}
+}
+
+bool Animator::isSimdSupported () {
+	return (ANIMATOR_SSE2 ? true : false);
+}
+
+float Animator::ease (Animator::Easing easing, float progress) {
+	if (progress <= 0.0f) {
+		return (0.0f);
+	}
+	if (progress >= 1.0f) {
+		return (1.0f);
+	}
+	switch (easing) {
+		case Animator::EaseInEasing: {
+			return (progress * progress);
+		}
+		case Animator::EaseOutEasing: {
+			return (progress * (2.0f - progress));
+		}
+		case Animator::EaseInOutEasing: {
+			if (progress < 0.5f) {
+				return (2.0f * progress * progress);
+			}
+			return (-1.0f + ((4.0f - (2.0f * progress)) * progress));
+		}
+		default: {
+			break;
+		}
+	}
+	return (progress);
+}
+
+int Animator::getTweenCount () {
+	int count;
+
+	SDL_LockMutex (tweenMutex);
+	count = (int) tweenContexts.size ();
+	SDL_UnlockMutex (tweenMutex);
+	return (count);
+}
+
+int Animator::addTween () {
+	int i;
+
+	tweenContexts.push_back (Animator::TweenContext ());
+	tweenEasings.push_back (Animator::LinearEasing);
+	tweenProgress.push_back (0.0f);
+	for (i = 0; i < Animator::ChannelCount; ++i) {
+		tweenStartValues[i].push_back (0.0f);
+		tweenTargetValues[i].push_back (0.0f);
+		tweenValues[i].push_back (0.0f);
+	}
+	return ((int) tweenContexts.size () - 1);
+}
+
+void Animator::removeTween (int index) {
+	Animator::TweenContext *ctx;
+	int last, i;
+
+	ctx = &(tweenContexts[index]);
+	if (ctx->position) {
+		ctx->position->tweenIndex = -1;
+	}
+	if (ctx->color) {
+		ctx->color->tweenIndex = -1;
+	}
+
+	last = ((int) tweenContexts.size ()) - 1;
+	if (index != last) {
+		tweenContexts[index] = tweenContexts[last];
+		tweenEasings[index] = tweenEasings[last];
+		tweenProgress[index] = tweenProgress[last];
+		for (i = 0; i < Animator::ChannelCount; ++i) {
+			tweenStartValues[i][index] = tweenStartValues[i][last];
+			tweenTargetValues[i][index] = tweenTargetValues[i][last];
+			tweenValues[i][index] = tweenValues[i][last];
+		}
+		ctx = &(tweenContexts[index]);
+		if (ctx->position) {
+			ctx->position->tweenIndex = index;
+		}
+		if (ctx->color) {
+			ctx->color->tweenIndex = index;
+		}
+	}
+
+	tweenContexts.pop_back ();
+	tweenEasings.pop_back ();
+	tweenProgress.pop_back ();
+	for (i = 0; i < Animator::ChannelCount; ++i) {
+		tweenStartValues[i].pop_back ();
+		tweenTargetValues[i].pop_back ();
+		tweenValues[i].pop_back ();
+	}
+}
+
+void Animator::update (int64_t updateTime) {
+	int i, count;
+	bool complete;
+
+	SDL_LockMutex (tweenMutex);
+	if (updateTime > currentTime) {
+		currentTime = updateTime;
+	}
+	count = (int) tweenContexts.size ();
+	if (count <= 0) {
+		SDL_UnlockMutex (tweenMutex);
+		return;
+	}
+
+	for (i = 0; i < count; ++i) {
+		updateProgress (i);
+	}
+	evaluateValues (count);
+
+	// Completed tweens are replaced by the last tween in storage, whose values were evaluated above and must then be applied at the same index
+	i = 0;
+	while (i < count) {
+		applyValues (i);
+		complete = (tweenContexts[i].repeatDelay < 0) && (tweenProgress[i] >= 1.0f);
+		if (complete) {
+			if (tweenContexts[i].position) {
+				tweenContexts[i].position->isTranslating = false;
+			}
+			if (tweenContexts[i].color) {
+				tweenContexts[i].color->isTranslating = false;
+			}
+			removeTween (i);
+			--count;
+		}
+		else {
+			++i;
+		}
+	}
+	SDL_UnlockMutex (tweenMutex);
+}
+
+void Animator::updateProgress (int index) {
+	Animator::TweenContext *ctx;
+	Animator::PositionSegment *segment;
+	int64_t elapsed, half;
+	float p;
+
+	ctx = &(tweenContexts[index]);
+	elapsed = currentTime - ctx->startTime;
+	if (ctx->repeatDelay >= 0) {
+		// Repeating animations move from the start values to the target values over the first half of the duration, return to the start values over the second half, and then hold the start values for the repeat delay
+		half = ctx->duration / 2;
+		elapsed %= (ctx->duration + ctx->repeatDelay);
+		if (elapsed < half) {
+			p = ((float) elapsed) / ((float) half);
+		}
+		else if (elapsed < (half * 2)) {
+			p = 1.0f - (((float) (elapsed - half)) / ((float) half));
+		}
+		else {
+			p = 0.0f;
+		}
+		tweenProgress[index] = p;
+		return;
+	}
+
+	while ((elapsed >= ctx->duration) && ((ctx->segmentIndex + 1) < ctx->segmentCount)) {
+		// Begin the next position segment from the end of the completed one
+		elapsed -= ctx->duration;
+		ctx->startTime += ctx->duration;
+		++(ctx->segmentIndex);
+		segment = &(ctx->segments[ctx->segmentIndex]);
+		ctx->duration = segment->duration;
+		tweenStartValues[0][index] = tweenTargetValues[0][index];
+		tweenStartValues[1][index] = tweenTargetValues[1][index];
+		tweenTargetValues[0][index] = segment->targetX;
+		tweenTargetValues[1][index] = segment->targetY;
+	}
+
+	if ((ctx->duration <= 0) || (elapsed >= ctx->duration)) {
+		tweenProgress[index] = 1.0f;
+		return;
+	}
+	p = ((float) elapsed) / ((float) ctx->duration);
+	if (p < 0.0f) {
+		p = 0.0f;
+	}
+	tweenProgress[index] = p;
+}
+
+void Animator::evaluateValues (int count) {
+	int i, c;
+	float p;
+#if ANIMATOR_SSE2
+	__m128 vp, vresult, vmask, vin, vout, vinout, vlow, vhigh, vstart, vtarget, vone, vtwo, vfour, vhalf;
+	__m128i veasing;
+#endif
+
+	i = 0;
+#if ANIMATOR_SSE2
+	if (isSimdEnabled) {
+		vone = _mm_set1_ps (1.0f);
+		vtwo = _mm_set1_ps (2.0f);
+		vfour = _mm_set1_ps (4.0f);
+		vhalf = _mm_set1_ps (0.5f);
+		while ((i + 4) <= count) {
+			// Evaluate every easing curve for four tweens at once, then select each tween's curve by comparing its easing value
+			vp = _mm_loadu_ps (&(tweenProgress[i]));
+			vp = _mm_min_ps (_mm_max_ps (vp, _mm_setzero_ps ()), vone);
+			vin = _mm_mul_ps (vp, vp);
+			vout = _mm_mul_ps (vp, _mm_sub_ps (vtwo, vp));
+			vlow = _mm_mul_ps (vtwo, vin);
+			vhigh = _mm_sub_ps (_mm_mul_ps (_mm_sub_ps (vfour, _mm_mul_ps (vtwo, vp)), vp), vone);
+			vmask = _mm_cmplt_ps (vp, vhalf);
+			vinout = _mm_or_ps (_mm_and_ps (vmask, vlow), _mm_andnot_ps (vmask, vhigh));
+
+			veasing = _mm_loadu_si128 ((const __m128i *) &(tweenEasings[i]));
+			vresult = vp;
+			vmask = _mm_castsi128_ps (_mm_cmpeq_epi32 (veasing, _mm_set1_epi32 (Animator::EaseInEasing)));
+			vresult = _mm_or_ps (_mm_and_ps (vmask, vin), _mm_andnot_ps (vmask, vresult));
+			vmask = _mm_castsi128_ps (_mm_cmpeq_epi32 (veasing, _mm_set1_epi32 (Animator::EaseOutEasing)));
+			vresult = _mm_or_ps (_mm_and_ps (vmask, vout), _mm_andnot_ps (vmask, vresult));
+			vmask = _mm_castsi128_ps (_mm_cmpeq_epi32 (veasing, _mm_set1_epi32 (Animator::EaseInOutEasing)));
+			vresult = _mm_or_ps (_mm_and_ps (vmask, vinout), _mm_andnot_ps (vmask, vresult));
+
+			for (c = 0; c < Animator::ChannelCount; ++c) {
+				vstart = _mm_loadu_ps (&(tweenStartValues[c][i]));
+				vtarget = _mm_loadu_ps (&(tweenTargetValues[c][i]));
+				_mm_storeu_ps (&(tweenValues[c][i]), _mm_add_ps (vstart, _mm_mul_ps (_mm_sub_ps (vtarget, vstart), vresult)));
+			}
+			i += 4;
+		}
+	}
+#endif
+
+	while (i < count) {
+		p = Animator::ease ((Animator::Easing) tweenEasings[i], tweenProgress[i]);
+		for (c = 0; c < Animator::ChannelCount; ++c) {
+			tweenValues[c][i] = tweenStartValues[c][i] + ((tweenTargetValues[c][i] - tweenStartValues[c][i]) * p);
+		}
+		++i;
+	}
+}
+
+void Animator::applyValues (int index) {
+	Animator::TweenContext *ctx;
+
+	ctx = &(tweenContexts[index]);
+	if (ctx->position) {
+		ctx->position->x = tweenValues[0][index];
+		ctx->position->y = tweenValues[1][index];
+	}
+	if (ctx->color) {
+		ctx->color->setTweenValues (tweenValues[0][index], tweenValues[1][index], tweenValues[2][index], tweenValues[3][index]);
+	}
+}
+
+void Animator::translatePosition (Position *position, float targetX, float targetY, int durationMs, Animator::Easing easing) {
+	Animator::TweenContext *ctx;
+	int index;
+
+	SDL_LockMutex (tweenMutex);
+	index = position->tweenIndex;
+	if (index < 0) {
+		index = addTween ();
+		position->tweenIndex = index;
+	}
+	ctx = &(tweenContexts[index]);
+	ctx->position = position;
+	ctx->color = NULL;
+	ctx->startTime = currentTime;
+	ctx->duration = ((int64_t) durationMs) * 1000000;
+	ctx->repeatDelay = -1;
+	ctx->segmentIndex = 0;
+	ctx->segmentCount = 1;
+	ctx->segments[0].targetX = targetX;
+	ctx->segments[0].targetY = targetY;
+	ctx->segments[0].duration = ctx->duration;
+	tweenEasings[index] = easing;
+	tweenProgress[index] = 0.0f;
+	tweenStartValues[0][index] = position->x;
+	tweenStartValues[1][index] = position->y;
+	tweenTargetValues[0][index] = targetX;
+	tweenTargetValues[1][index] = targetY;
+	position->isTranslating = true;
+	SDL_UnlockMutex (tweenMutex);
+}
+
+bool Animator::plotPosition (Position *position, float deltaX, float deltaY, int durationMs) {
+	Animator::TweenContext *ctx;
+	Animator::PositionSegment *segment, *lastsegment;
+	bool result;
+
+	result = false;
+	SDL_LockMutex (tweenMutex);
+	if (position->tweenIndex >= 0) {
+		ctx = &(tweenContexts[position->tweenIndex]);
+		if (ctx->position && (ctx->segmentCount < Animator::MaxPositionSegmentCount)) {
+			lastsegment = &(ctx->segments[ctx->segmentCount - 1]);
+			segment = &(ctx->segments[ctx->segmentCount]);
+			segment->targetX = lastsegment->targetX + deltaX;
+			segment->targetY = lastsegment->targetY + deltaY;
+			segment->duration = (durationMs > 0) ? (((int64_t) durationMs) * 1000000) : 0;
+			++(ctx->segmentCount);
+			result = true;
+		}
+	}
+	SDL_UnlockMutex (tweenMutex);
+	return (result);
+}
+
+void Animator::cancelPosition (Position *position) {
+	SDL_LockMutex (tweenMutex);
+	if (position->tweenIndex >= 0) {
+		removeTween (position->tweenIndex);
+	}
+	position->isTranslating = false;
+	SDL_UnlockMutex (tweenMutex);
+}
+
+void Animator::translateColor (Color *color, float targetR, float targetG, float targetB, float targetA, int durationMs, Animator::Easing easing) {
+	Animator::TweenContext *ctx;
+	int index;
+
+	SDL_LockMutex (tweenMutex);
+	index = color->tweenIndex;
+	if (index < 0) {
+		index = addTween ();
+		color->tweenIndex = index;
+	}
+	ctx = &(tweenContexts[index]);
+	ctx->position = NULL;
+	ctx->color = color;
+	ctx->startTime = currentTime;
+	ctx->duration = ((int64_t) durationMs) * 1000000;
+	ctx->repeatDelay = -1;
+	ctx->segmentIndex = 0;
+	ctx->segmentCount = 0;
+	tweenEasings[index] = easing;
+	tweenProgress[index] = 0.0f;
+	tweenStartValues[0][index] = color->r;
+	tweenStartValues[1][index] = color->g;
+	tweenStartValues[2][index] = color->b;
+	tweenStartValues[3][index] = color->a;
+	tweenTargetValues[0][index] = targetR;
+	tweenTargetValues[1][index] = targetG;
+	tweenTargetValues[2][index] = targetB;
+	tweenTargetValues[3][index] = targetA;
+	color->isTranslating = true;
+	color->isAnimating = false;
+	SDL_UnlockMutex (tweenMutex);
+}
+
+void Animator::animateColor (Color *color, const Color &color1, const Color &color2, int durationMs, int repeatDelayMs) {
+	Animator::TweenContext *ctx;
+	int index;
+
+	SDL_LockMutex (tweenMutex);
+	index = color->tweenIndex;
+	if (index < 0) {
+		index = addTween ();
+		color->tweenIndex = index;
+	}
+	ctx = &(tweenContexts[index]);
+	ctx->position = NULL;
+	ctx->color = color;
+	ctx->startTime = currentTime;
+	ctx->duration = ((int64_t) durationMs) * 1000000;
+	ctx->repeatDelay = (repeatDelayMs > 0) ? (((int64_t) repeatDelayMs) * 1000000) : 0;
+	ctx->segmentIndex = 0;
+	ctx->segmentCount = 0;
+	tweenEasings[index] = Animator::LinearEasing;
+	tweenProgress[index] = 0.0f;
+	tweenStartValues[0][index] = color1.r;
+	tweenStartValues[1][index] = color1.g;
+	tweenStartValues[2][index] = color1.b;
+	tweenStartValues[3][index] = color1.a;
+	tweenTargetValues[0][index] = color2.r;
+	tweenTargetValues[1][index] = color2.g;
+	tweenTargetValues[2][index] = color2.b;
+	tweenTargetValues[3][index] = color2.a;
+	color->isTranslating = false;
+	color->isAnimating = true;
+	SDL_UnlockMutex (tweenMutex);
+}
+
+void Animator::cancelColor (Color *color) {
+	SDL_LockMutex (tweenMutex);
+	if (color->tweenIndex >= 0) {
+		removeTween (color->tweenIndex);
+	}
+	color->isTranslating = false;
+	color->isAnimating = false;
+	SDL_UnlockMutex (tweenMutex);
+}
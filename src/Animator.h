@@ -0,0 +1,149 @@
+/*
+* Copyright 2018-2022 Membrane Software <author@membranesoftware.com> https://membranesoftware.com
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+* this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+* this list of conditions and the following disclaimer in the documentation
+* and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors
+* may be used to endorse or promote products derived from this software without
+* specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*/
+// Class that evaluates active Position and Color translations in closed form from their start times, holding only active tweens in structure-of-arrays storage so that idle objects require no per-update work and active tweens can be evaluated in SIMD batches
+
+#ifndef ANIMATOR_H
+#define ANIMATOR_H
+
+#include <vector>
+#include "SDL2/SDL.h"
+
+class Position;
+class Color;
+
+class Animator {
+public:
+	Animator ();
+	~Animator ();
+	static Animator *instance;
+
+	// Easing curves that can be applied to translation progress
+	enum Easing {
+		LinearEasing = 0,
+		EaseInEasing = 1,
+		EaseOutEasing = 2,
+		EaseInOutEasing = 3
+	};
+
+	static const int MaxPositionSegmentCount = 4;
+	static const int ChannelCount = 4;
+	static const int InitialTweenCapacity;
+
+	// Read-write data members
+	bool isSimdEnabled; // If enabled, tween values are evaluated with SIMD instructions where the build supports them
+
+	// Read-only data members
+	int64_t currentTime; // Monotonic clock value in nanoseconds from the most recent update, or from construction if no update has occurred
+
+	// Return a boolean value indicating if the build includes SIMD evaluation of tween values
+	static bool isSimdSupported ();
+
+	// Update state as appropriate for the specified monotonic clock value in nanoseconds, evaluating all active tweens and removing those that have completed
+	void update (int64_t updateTime);
+
+	// Return the number of active tweens
+	int getTweenCount ();
+
+	// Begin a translation of the specified position, replacing any translation already active for that position
+	void translatePosition (Position *position, float targetX, float targetY, int durationMs, Animator::Easing easing);
+
+	// Append a translation segment to the active translation of the specified position, to be executed after all previously added segments. Returns a boolean value indicating if the segment was added, which does not occur if the position is not translating or its segment list is full.
+	bool plotPosition (Position *position, float deltaX, float deltaY, int durationMs);
+
+	// End any active translation of the specified position, leaving its coordinates at their current values
+	void cancelPosition (Position *position);
+
+	// Begin a translation of the specified color, replacing any translation or animation already active for that color
+	void translateColor (Color *color, float targetR, float targetG, float targetB, float targetA, int durationMs, Animator::Easing easing);
+
+	// Begin a repeating animation of the specified color, alternating linearly between color1 and color2 over durationMs and then holding color1 for repeatDelayMs
+	void animateColor (Color *color, const Color &color1, const Color &color2, int durationMs, int repeatDelayMs);
+
+	// End any active translation or animation of the specified color, leaving its values at their current state
+	void cancelColor (Color *color);
+
+	// Return the result of applying the specified easing curve to a linear progress value from 0.0 to 1.0
+	static float ease (Animator::Easing easing, float progress);
+
+private:
+	struct PositionSegment {
+		float targetX, targetY;
+		int64_t duration; // nanoseconds
+		PositionSegment ():
+			targetX (0.0f),
+			targetY (0.0f),
+			duration (0) { }
+	};
+
+	// Per-tween values that are read only while computing progress and applying results. Channel values and progress are held in separate arrays indexed in parallel with tweenContexts.
+	struct TweenContext {
+		Position *position;
+		Color *color;
+		int64_t startTime; // nanoseconds
+		int64_t duration; // nanoseconds
+		int64_t repeatDelay; // nanoseconds. A value of zero or greater indicates a repeating animation.
+		int segmentIndex;
+		int segmentCount;
+		Animator::PositionSegment segments[Animator::MaxPositionSegmentCount];
+		TweenContext ():
+			position (NULL),
+			color (NULL),
+			startTime (0),
+			duration (0),
+			repeatDelay (-1),
+			segmentIndex (0),
+			segmentCount (0) { }
+	};
+
+	// Add a tween to the end of each storage array and return its index. This method must be invoked while holding a lock on tweenMutex.
+	int addTween ();
+
+	// Remove the tween at the specified index by moving the last tween into its place. This method must be invoked while holding a lock on tweenMutex.
+	void removeTween (int index);
+
+	// Store the linear progress of the tween at the specified index, advancing through any completed position segments. A progress value of 1.0 indicates that a non-repeating tween has completed.
+	void updateProgress (int index);
+
+	// Store eased channel values for the first count tweens, using SIMD instructions for as many tweens as possible if enabled
+	void evaluateValues (int count);
+
+	// Assign the channel values of the tween at the specified index to its position or color
+	void applyValues (int index);
+
+	SDL_mutex *tweenMutex;
+	std::vector<Animator::TweenContext> tweenContexts;
+	std::vector<int> tweenEasings;
+	std::vector<float> tweenProgress;
+	std::vector<float> tweenStartValues[Animator::ChannelCount];
+	std::vector<float> tweenTargetValues[Animator::ChannelCount];
+	std::vector<float> tweenValues[Animator::ChannelCount];
+};
+
+#endif
@@ -49,8 +49,9 @@
 #include "StdString.h"
 #include "Log.h"
 #include "TaskGroup.h"
+#include "Animator.h"
+#include "Trace.h"
 #include "OsUtil.h"
-#include "MathUtil.h"
 #include "UiConfiguration.h"
 #include "UiText.h"
 #include "SystemInterface.h"
@@ -60,6 +61,7 @@
 #include "Network.h"
 #include "Panel.h"
 #include "MainUi.h"
+#include "PerformanceWindow.h"
 #include "App.h"
 
 const int DefaultWindowWidth = 448;
@@ -81,6 +83,9 @@ const char *App::FontScaleKey = "FontScale";
 const char *App::HttpsKey = "Https";
 const char *App::ShowInterfaceAnimationsKey = "ShowInterfaceAnimations";
 
+const char *App::FramePhaseNames[] = { "pollEvents", "executeRenderTasks", "draw", "present", "resizeWindow", "executeStackCommands", "compact" };
+const char *App::UpdatePhaseNames[] = { "animator", "taskGroup", "uiStack", "processInput", "ui", "rootPanel", "recordDrawList", "writePrefs" };
+
 App *App::instance = NULL;
 
 void App::createInstance (bool shouldSkipInit) {
@@ -94,6 +99,8 @@ void App::createInstance (bool shouldSkipInit) {
 	UiConfiguration::instance = &(App::instance->uiConfig);
 	UiText::instance = &(App::instance->uiText);
 	TaskGroup::instance = &(App::instance->taskGroup);
+	Animator::instance = &(App::instance->animator);
+	Trace::instance = &(App::instance->trace);
 	SystemInterface::instance = &(App::instance->systemInterface);
 
 	if (! shouldSkipInit) {
@@ -111,6 +118,8 @@ void App::freeInstance () {
 		UiConfiguration::instance = NULL;
 		UiText::instance = NULL;
 		TaskGroup::instance = NULL;
+		Animator::instance = NULL;
+		Trace::instance = NULL;
 		SystemInterface::instance = NULL;
 		IMG_Quit ();
 		SDL_Quit ();
@@ -138,11 +147,24 @@ App::App ()
 , windowHeight (0)
 , minDrawFrameDelay (0)
 , minUpdateFrameDelay (0)
+, waitSpinDuration (OsUtil::DefaultWaitSpinDuration)
+, isPresentVsyncEnabled (false)
+, updateTime (0)
 , fontScale (1.0f)
 , imageScale (0)
 , drawCount (0)
 , updateCount (0)
+, frameProfiler ("frame", App::FramePhaseCount, App::FramePhaseNames)
+, updateProfiler ("update", App::UpdatePhaseCount, App::UpdatePhaseNames)
+, lastDrawnWidgetCount (0)
+, lastCulledWidgetCount (0)
+, lastCachedWidgetCount (0)
+, isDrawListEnabled (false)
+, panelTextureCacheFrames (0)
+, panelTextureCacheBudget (0)
+, isPanelTextureCacheOutlineEnabled (false)
 , isPrefsWriteDisabled (false)
+, isWritingTraceFile (false)
 , updateThread (NULL)
 , uniqueIdMutex (NULL)
 , nextUniqueId (1)
@@ -152,12 +174,19 @@ App::App ()
 , isSuspendingUpdate (false)
 , updateMutex (NULL)
 , updateCond (NULL)
+, drawListRecordIndex (0)
+, drawListExecuteIndex (2)
+, drawListSequence (0)
 {
 	uniqueIdMutex = SDL_CreateMutex ();
 	prefsMapMutex = SDL_CreateMutex ();
 	renderTaskMutex = SDL_CreateMutex ();
 	updateMutex = SDL_CreateMutex ();
 	updateCond = SDL_CreateCond ();
+
+	// The update thread records into list 0, the main thread executes list 2, and list 1 is held for exchange
+	SDL_AtomicSet (&drawListPublishState, 1);
+	SDL_AtomicSet (&panelTextureCacheBytes, 0);
 }
 
 App::~App () {
@@ -194,6 +223,7 @@ App::~App () {
 void App::init () {
 	StdString path;
 	OsUtil::Result result;
+	int texturemb;
 #if PLATFORM_MACOS
 	char exepath[4096], dirpath[4096];
 	uint32_t sz;
@@ -257,8 +287,37 @@ void App::init () {
 
 	minDrawFrameDelay = OsUtil::getEnvValue ("MIN_DRAW_FRAME_DELAY", 0);
 	minUpdateFrameDelay = OsUtil::getEnvValue ("MIN_UPDATE_FRAME_DELAY", 0);
+	waitSpinDuration = ((int64_t) OsUtil::getEnvValue ("WAIT_SPIN_DURATION", (int) (OsUtil::DefaultWaitSpinDuration / 1000))) * 1000;
+	isPresentVsyncEnabled = OsUtil::getEnvValue ("PRESENT_VSYNC", false);
+	frameProfileFilename.assign (OsUtil::getEnvValue ("FRAME_PROFILE_FILENAME", ""));
+	updateProfileFilename.assign (OsUtil::getEnvValue ("UPDATE_PROFILE_FILENAME", ""));
+	traceFilename.assign (OsUtil::getEnvValue ("TRACE_FILENAME", ""));
+	if (! traceFilename.empty ()) {
+		trace.enable ();
+	}
 	windowWidth = OsUtil::getEnvValue ("WINDOW_WIDTH", 0);
 	windowHeight = OsUtil::getEnvValue ("WINDOW_HEIGHT", 0);
+	resource.maxTextureUploadsPerFrame = OsUtil::getEnvValue ("MAX_TEXTURE_UPLOADS", Resource::DefaultMaxTextureUploadsPerFrame);
+	resource.maxTextureDecodeTasks = OsUtil::getEnvValue ("MAX_TEXTURE_DECODE_TASKS", Resource::DefaultMaxTextureDecodeTasks);
+	texturemb = OsUtil::getEnvValue ("TEXTURE_MEMORY_BUDGET", -1);
+	if (texturemb >= 0) {
+		resource.textureMemoryBudget = ((int64_t) texturemb) * 1048576;
+	}
+	isDrawListEnabled = OsUtil::getEnvValue ("DRAW_LIST", false);
+	if (isDrawListEnabled) {
+		resource.setCompactSequence (0);
+
+		// Panel texture caching detects unchanged content by comparing draw keys, which are computed only while recording draw lists
+		panelTextureCacheFrames = OsUtil::getEnvValue ("PANEL_TEXTURE_CACHE_FRAMES", 0);
+		texturemb = OsUtil::getEnvValue ("PANEL_TEXTURE_CACHE_BUDGET", -1);
+		if (texturemb >= 0) {
+			panelTextureCacheBudget = ((int64_t) texturemb) * 1048576;
+		}
+		else {
+			panelTextureCacheBudget = resource.textureMemoryBudget / 4;
+		}
+		isPanelTextureCacheOutlineEnabled = OsUtil::getEnvValue ("PANEL_TEXTURE_CACHE_OUTLINE", false);
+	}
 }
 
 int App::getImageScale (int w, int h) {
@@ -327,11 +386,13 @@ int App::runWindow () {
 	SDL_RendererInfo renderinfo;
 	StdString text;
 	int result, delay, i;
-	int64_t endtime, elapsed, t1, t2;
+	int64_t endtime, elapsed, t2, deadline, framedelay;
 	Uint32 windowflags;
 	double fps;
 	Ui *ui;
 	SDL_Rect rect;
+	Resource::CompactStats compactstats;
+	Input::LatencyStats latencystats;
 
 	if (SDL_Init (SDL_INIT_VIDEO | SDL_INIT_TIMER) != 0) {
 		Log::err ("Failed to start SDL: %s", SDL_GetError ());
@@ -380,6 +441,9 @@ int App::runWindow () {
 		}
 	}
 
+	if (isPresentVsyncEnabled) {
+		SDL_SetHint (SDL_HINT_RENDER_VSYNC, "1");
+	}
 	result = SDL_CreateWindowAndRenderer (windowWidth, windowHeight, 0, &window, &render);
 	if (result != 0) {
 		Log::err ("Failed to create application window: %s", SDL_GetError ());
@@ -393,6 +457,10 @@ int App::runWindow () {
 	if ((renderinfo.flags & (SDL_RENDERER_ACCELERATED | SDL_RENDERER_TARGETTEXTURE)) == (SDL_RENDERER_ACCELERATED | SDL_RENDERER_TARGETTEXTURE)) {
 		isTextureRenderEnabled = true;
 	}
+	if (isPresentVsyncEnabled && (! (renderinfo.flags & SDL_RENDERER_PRESENTVSYNC))) {
+		Log::warning ("Failed to enable renderer vsync, frames are paced by minDrawFrameDelay");
+		isPresentVsyncEnabled = false;
+	}
 	if (isTextureRenderEnabled) {
 		isInterfaceAnimationEnabled = prefsMap.find (App::ShowInterfaceAnimationsKey, true);
 	}
@@ -423,6 +491,7 @@ int App::runWindow () {
 	ui = new MainUi ();
 	uiStack.setUi (ui);
 
+	trace.setThreadName ("main");
 	updateThread = SDL_CreateThread (App::runUpdateThread, "runUpdateThread", (void *) this);
 
 	Log::info ("Application started; buildId=%s windowSize=%ix%i renderName=%s lang=%s pid=%i", BUILD_ID, windowWidth, windowHeight, renderinfo.name, OsUtil::getEnvLanguage ("").c_str (), OsUtil::getProcessId ());
@@ -516,13 +585,17 @@ int App::runWindow () {
 	Log::debug3 ("* Render flags:%s", text.c_str ());
 	text.assign ("");
 
+	framedelay = ((int64_t) minDrawFrameDelay) * 1000000;
+	deadline = OsUtil::getMonotonicTime () + framedelay;
 	while (true) {
 		if (isShutdown) {
 			break;
 		}
 
-		t1 = OsUtil::getTime ();
+		frameProfiler.beginFrame ();
+		frameProfiler.beginPhase (App::PollEventsPhase);
 		input.pollEvents ();
+		frameProfiler.endPhase (App::PollEventsPhase);
 		if (! FLOAT_EQUALS (fontScale, nextFontScale)) {
 			if (uiConfig.reloadFonts (nextFontScale) != OsUtil::Success) {
 				nextFontScale = fontScale;
@@ -541,24 +614,46 @@ int App::runWindow () {
 			}
 		}
 
+		frameProfiler.beginPhase (App::ExecuteRenderTasksPhase);
 		executeRenderTasks ();
+		frameProfiler.endPhase (App::ExecuteRenderTasksPhase);
 		draw ();
 		if ((windowWidth != nextWindowWidth) || (windowHeight != nextWindowHeight)) {
+			frameProfiler.beginPhase (App::ResizeWindowPhase);
 			resizeWindow ();
+			frameProfiler.endPhase (App::ResizeWindowPhase);
 		}
+		frameProfiler.beginPhase (App::ExecuteStackCommandsPhase);
 		uiStack.executeStackCommands ();
-		resource.compact ();
+		frameProfiler.endPhase (App::ExecuteStackCommandsPhase);
+		if (resource.isCompactPending ()) {
+			// Free unreferenced resources using half of the frame's remaining time, or at least one millisecond if the frame has no time remaining
+			frameProfiler.beginPhase (App::CompactPhase);
+			t2 = OsUtil::getMonotonicTime ();
+			delay = (int) ((deadline - t2) / 2000);
+			if (delay < 1000) {
+				delay = 1000;
+			}
+			resource.compact ((int64_t) delay);
+			frameProfiler.endPhase (App::CompactPhase);
+		}
+		frameProfiler.endFrame ();
 
-		t2 = OsUtil::getTime ();
-		delay = (int) (minDrawFrameDelay - (t2 - t1));
-		if (delay < 1) {
-			delay = 1;
+		// With vsync enabled, presentation blocks until the next display refresh and paces the loop without an added sleep
+		if (! isPresentVsyncEnabled) {
+			OsUtil::waitUntil (deadline, waitSpinDuration);
+		}
+		deadline += framedelay;
+		t2 = OsUtil::getMonotonicTime ();
+		if (deadline < t2) {
+			// The loop fell at least one frame behind schedule; restart the schedule from the current time rather than running extra frames to catch up
+			deadline = t2 + framedelay;
 		}
-		SDL_Delay (delay);
 	}
 	SDL_WaitThread (updateThread, &result);
 
 	uiStack.clear ();
+	performanceWindow.destroyAndClear ();
 	if (rootPanel) {
 		rootPanel->release ();
 		rootPanel = NULL;
@@ -568,6 +663,8 @@ int App::runWindow () {
 		roundedCornerSprite->unload ();
 	}
 	resource.compact ();
+	compactstats = resource.getCompactStats ();
+	Log::debug ("Resource compact totals; passCount=%lli freedCount=%lli freedBytes=%lli", (long long) compactstats.passCount, (long long) compactstats.totalFreedCount, (long long) compactstats.totalFreedBytes);
 	resource.close ();
 
 	SDL_DestroyRenderer (render);
@@ -581,6 +678,25 @@ int App::runWindow () {
 	if (elapsed > 1000) {
 		fps /= ((double) elapsed) / 1000.0f;
 	}
+	Log::info ("Frame profile; %s", frameProfiler.toString ().c_str ());
+	Log::info ("Update profile; %s", updateProfiler.toString ().c_str ());
+	if (! frameProfileFilename.empty ()) {
+		result = frameProfiler.writeFile (frameProfileFilename);
+		if (result != OsUtil::Success) {
+			Log::err ("Failed to write frame profile file; filename=\"%s\" err=%i", frameProfileFilename.c_str (), result);
+		}
+	}
+	if (! updateProfileFilename.empty ()) {
+		result = updateProfiler.writeFile (updateProfileFilename);
+		if (result != OsUtil::Success) {
+			Log::err ("Failed to write update profile file; filename=\"%s\" err=%i", updateProfileFilename.c_str (), result);
+		}
+	}
+
+	writeTraceFile ();
+
+	latencystats = input.getLatencyStats ();
+	Log::info ("Input latency; eventCount=%i processP50=%.3fms processP99=%.3fms updateP50=%.3fms updateP99=%.3fms presentP50=%.3fms presentP95=%.3fms presentP99=%.3fms presentMax=%.3fms droppedCount=%i", latencystats.process.sampleCount, ((double) latencystats.process.p50) / 1000000.0f, ((double) latencystats.process.p99) / 1000000.0f, ((double) latencystats.update.p50) / 1000000.0f, ((double) latencystats.update.p99) / 1000000.0f, ((double) latencystats.present.p50) / 1000000.0f, ((double) latencystats.present.p95) / 1000000.0f, ((double) latencystats.present.p99) / 1000000.0f, ((double) latencystats.present.max) / 1000000.0f, latencystats.droppedCount);
 	Log::info ("Application ended; updateCount=%lli drawCount=%lli runtime=%.3fs FPS=%f pid=%i", (long long) updateCount, (long long) drawCount, ((double) elapsed) / 1000.0f, fps, OsUtil::getProcessId ());
 
 	return (OsUtil::Success);
@@ -597,12 +713,12 @@ void App::populateWidgets () {
 }
 
 void App::populateRoundedCornerSprite () {
-	Uint32 *pixels, *dest, color, rmask, gmask, bmask, amask;
+	Uint32 *pixels, *dest, rmask, gmask, bmask, amask;
 	SDL_Surface *surface;
 	SDL_Texture *texture;
 	StdString path;
-	float dist, targetalpha, minalpha, opacity;
-	int radius, x, y, w, h;
+	float dx, dy, dist, targetalpha, minalpha, opacity;
+	int cellsize, radius, x, y, w, h, maskx, masky;
 	uint8_t alpha;
 
 	if (roundedCornerSprite) {
@@ -620,25 +736,38 @@ void App::populateRoundedCornerSprite () {
 	bmask = 0x00FF0000;
 	amask = 0xFF000000;
 #endif
+
+	// The atlas holds one square cell per corner radius, arranged left to right after an opaque cell used for solid fills. Each cell holds the top left quarter of a circle with the cell's radius, with the circle's center pixel extended to the cell's right and bottom edges.
+	cellsize = App::MaxCornerRadius + 2;
+	w = cellsize * (App::MaxCornerRadius + 1);
+	h = cellsize;
+	pixels = (Uint32 *) malloc (w * h * sizeof (Uint32));
+	if (! pixels) {
+		Log::warning ("Failed to create texture; err=\"Out of memory, dimensions %ix%i\"", w, h);
+		delete (roundedCornerSprite);
+		roundedCornerSprite = NULL;
+		return;
+	}
 	minalpha = 0.1f;
 	opacity = 8.0f;
-	radius = 1;
-	while (radius <= App::MaxCornerRadius) {
-		w = (radius * 2) + 1;
-		h = (radius * 2) + 1;
-		pixels = (Uint32 *) malloc (w * h * sizeof (Uint32));
-		if (! pixels) {
-			Log::warning ("Failed to create texture; err=\"Out of memory, dimensions %ix%i\"", radius, radius);
-			delete (roundedCornerSprite);
-			roundedCornerSprite = NULL;
-			return;
-		}
-		dest = pixels;
-		y = 0;
-		while (y < h) {
-			x = 0;
-			while (x < w) {
-				dist = MathUtil::getDistance (((float) x) + 0.5f, ((float) y) + 0.5f, (float) radius + 0.5f, (float) radius + 0.5f);
+	y = 0;
+	while (y < h) {
+		dest = pixels + (y * w);
+		x = 0;
+		while (x < w) {
+			radius = x / cellsize;
+			if (radius <= 0) {
+				alpha = 255;
+			}
+			else {
+				maskx = x - (radius * cellsize);
+				if (maskx > radius) {
+					maskx = radius;
+				}
+				masky = (y > radius) ? radius : y;
+				dx = (float) (radius - maskx);
+				dy = (float) (radius - masky);
+				dist = sqrtf ((dx * dx) + (dy * dy));
 				targetalpha = 1.0f - ((1.0f - minalpha) * (dist / (float) radius));
 				if (targetalpha <= 0.0f) {
 					targetalpha = 0.0f;
@@ -650,45 +779,64 @@ void App::populateRoundedCornerSprite () {
 					}
 				}
 				alpha = (uint8_t) (targetalpha * 255.0f);
+			}
 #if SDL_BYTEORDER == SDL_BIG_ENDIAN
-				color = 0xFFFFFF00 | (alpha & 0xFF);
+			*dest = 0xFFFFFF00 | (alpha & 0xFF);
 #else
-				color = 0x00FFFFFF | (((Uint32) (alpha & 0xFF)) << 24);
+			*dest = 0x00FFFFFF | (((Uint32) (alpha & 0xFF)) << 24);
 #endif
-				*dest = color;
-				++dest;
-				++x;
-			}
-			++y;
+			++dest;
+			++x;
 		}
+		++y;
+	}
 
-		surface = SDL_CreateRGBSurfaceFrom (pixels, w, h, 32, w * sizeof (Uint32), rmask, gmask, bmask, amask);
-		if (! surface) {
-			free (pixels);
-			Log::warning ("Failed to create texture; err=\"SDL_CreateRGBSurfaceFrom, %s\"", SDL_GetError ());
-			delete (roundedCornerSprite);
-			roundedCornerSprite = NULL;
-			return;
-		}
-		path.sprintf ("*_App::roundedCornerSprite_%llx", (long long int) App::instance->getUniqueId ());
-		texture = Resource::instance->createTexture (path, surface);
-		SDL_FreeSurface (surface);
+	surface = SDL_CreateRGBSurfaceFrom (pixels, w, h, 32, w * sizeof (Uint32), rmask, gmask, bmask, amask);
+	if (! surface) {
 		free (pixels);
-		if (! texture) {
-			delete (roundedCornerSprite);
-			roundedCornerSprite = NULL;
-			return;
-		}
-		roundedCornerSprite->addTexture (texture, path);
-		++radius;
+		Log::warning ("Failed to create texture; err=\"SDL_CreateRGBSurfaceFrom, %s\"", SDL_GetError ());
+		delete (roundedCornerSprite);
+		roundedCornerSprite = NULL;
+		return;
+	}
+	path.sprintf ("*_App::roundedCornerSprite_%llx", (long long int) App::instance->getUniqueId ());
+	texture = Resource::instance->createTexture (path, surface);
+	SDL_FreeSurface (surface);
+	free (pixels);
+	if (! texture) {
+		delete (roundedCornerSprite);
+		roundedCornerSprite = NULL;
+		return;
+	}
+	roundedCornerSprite->addTexture (texture, path);
+}
+
+bool App::reservePanelTextureCache (int textureBytes) {
+	int64_t bytes;
+
+	if (textureBytes <= 0) {
+		return (false);
+	}
+	bytes = ((int64_t) SDL_AtomicAdd (&panelTextureCacheBytes, textureBytes)) + textureBytes;
+	if (bytes > panelTextureCacheBudget) {
+		SDL_AtomicAdd (&panelTextureCacheBytes, -textureBytes);
+		return (false);
 	}
+	return (true);
 }
 
-SDL_Texture *App::getRoundedCornerTexture (int radius, int *textureWidth, int *textureHeight) {
-	if ((radius <= 0) || (radius > App::MaxCornerRadius)) {
+void App::releasePanelTextureCache (int textureBytes) {
+	if (textureBytes <= 0) {
+		return;
+	}
+	SDL_AtomicAdd (&panelTextureCacheBytes, -textureBytes);
+}
+
+SDL_Texture *App::getRoundedCornerAtlas () {
+	if (! roundedCornerSprite) {
 		return (NULL);
 	}
-	return (roundedCornerSprite->getTexture ((radius - 1), textureWidth, textureHeight));
+	return (roundedCornerSprite->getTexture (0));
 }
 
 void App::shutdown () {
@@ -732,45 +880,103 @@ void App::executeRenderTasks () {
 		++i;
 	}
 	renderTaskList.clear ();
+
+	resource.executeTextureUploads ();
 }
 
 void App::draw () {
+	DrawList *drawlist;
 	Ui *ui;
+	int64_t drawstarttime, presentsequence;
 
+	frameProfiler.beginPhase (App::DrawPhase);
+	drawstarttime = OsUtil::getMonotonicTime ();
+	presentsequence = 0;
 	SDL_RenderClear (render);
 
 	ui = uiStack.getActiveUi ();
 	if (ui) {
 		ui->draw ();
-		rootPanel->draw ();
+		if (isDrawListEnabled) {
+			if (SDL_AtomicGet (&drawListPublishState) & App::DrawListPublishedFlag) {
+				// Release the executed list back to the update thread, and acquire the contents of the list it published
+				SDL_MemoryBarrierRelease ();
+				drawListExecuteIndex = SDL_AtomicSet (&drawListPublishState, drawListExecuteIndex) & App::DrawListIndexMask;
+				SDL_MemoryBarrierAcquire ();
+			}
+			drawlist = &(drawLists[drawListExecuteIndex]);
+			presentsequence = drawlist->sequence;
+			if (drawlist->sequence > 0) {
+				drawlist->execute (render);
+
+				// Resources released before this list was recorded are no longer referenced by any list that could execute
+				resource.setCompactSequence ((int) drawlist->sequence);
+			}
+		}
+		else {
+			drawlist = &frameDrawList;
+			drawlist->begin (windowWidth, windowHeight, render);
+			rootPanel->draw (drawlist);
+			drawlist->end ();
+		}
+		lastDrawnWidgetCount = drawlist->drawnWidgetCount;
+		lastCulledWidgetCount = drawlist->culledWidgetCount;
+		lastCachedWidgetCount = drawlist->cachedWidgetCount;
 		ui->release ();
 	}
+	frameProfiler.endPhase (App::DrawPhase);
+
+	frameProfiler.beginPhase (App::PresentPhase);
 	SDL_RenderPresent (render);
+	frameProfiler.endPhase (App::PresentPhase);
+	input.endPresent (drawstarttime, presentsequence);
 	++drawCount;
 }
 
+void App::recordDrawList () {
+	DrawList *drawlist;
+
+	++drawListSequence;
+	resource.setReleaseSequence (drawListSequence);
+	drawlist = &(drawLists[drawListRecordIndex]);
+	drawlist->sequence = drawListSequence;
+	drawlist->begin (windowWidth, windowHeight);
+	rootPanel->draw (drawlist);
+	drawlist->end ();
+
+	// Publish the recorded list to the main thread, and acquire the list it last finished executing before recording into it
+	SDL_MemoryBarrierRelease ();
+	drawListRecordIndex = SDL_AtomicSet (&drawListPublishState, drawListRecordIndex | App::DrawListPublishedFlag) & App::DrawListIndexMask;
+	SDL_MemoryBarrierAcquire ();
+}
+
 int App::runUpdateThread (void *appPtr) {
 	App *app;
-	int64_t t1, t2, last;
-	int delay;
+	int64_t t, last, elapsed, deadline, framedelay;
 
 	app = (App *) appPtr;
-	last = OsUtil::getTime ();
+	app->trace.setThreadName ("update");
+	framedelay = ((int64_t) app->minUpdateFrameDelay) * 1000000;
+	last = OsUtil::getMonotonicTime ();
+	deadline = last + framedelay;
 	while (true) {
 		if (app->isShutdown) {
 			break;
 		}
 
-		t1 = OsUtil::getTime ();
-		app->update ((int) (t1 - last));
-		t2 = OsUtil::getTime ();
-		last = t1;
-
-		delay = (int) (app->minUpdateFrameDelay - (t2 - t1));
-		if (delay < 1) {
-			delay = 1;
+		// Pass elapsed time in whole milliseconds and carry the sub-millisecond remainder into the next update, so that the sum of msElapsed values tracks the monotonic clock without accumulated rounding error
+		t = OsUtil::getMonotonicTime ();
+		elapsed = (t - last) / 1000000;
+		last += elapsed * 1000000;
+		app->updateTime = t;
+		app->update ((int) elapsed);
+
+		OsUtil::waitUntil (deadline, app->waitSpinDuration);
+		deadline += framedelay;
+		t = OsUtil::getMonotonicTime ();
+		if (deadline < t) {
+			deadline = t + framedelay;
 		}
-		SDL_Delay (delay);
 	}
 
 	return (0);
@@ -779,23 +985,48 @@ int App::runUpdateThread (void *appPtr) {
 void App::update (int msElapsed) {
 	Ui *ui;
 
+	updateProfiler.beginFrame ();
+	updateProfiler.beginPhase (App::AnimatorUpdatePhase);
+	animator.update (updateTime);
+	updateProfiler.endPhase (App::AnimatorUpdatePhase);
+	updateProfiler.beginPhase (App::TaskGroupUpdatePhase);
 	taskGroup.update (msElapsed);
+	updateProfiler.endPhase (App::TaskGroupUpdatePhase);
+	updateProfiler.beginPhase (App::UiStackUpdatePhase);
 	uiStack.update (msElapsed);
 	if (shouldRefreshUi) {
+		// UiConfiguration values may have changed, so this pass refreshes every widget rather than only those with invalidated layouts
+		Widget::invalidateAllLayouts ();
 		uiStack.refresh ();
 		rootPanel->refresh ();
 		shouldRefreshUi = false;
 	}
+	updateProfiler.endPhase (App::UiStackUpdatePhase);
 
+	updateProfiler.beginPhase (App::ProcessInputPhase);
 	rootPanel->processInput ();
+	updateProfiler.endPhase (App::ProcessInputPhase);
+	updateProfiler.beginPhase (App::UiUpdatePhase);
 	ui = uiStack.getActiveUi ();
 	if (ui) {
 		ui->update (msElapsed);
 		ui->release ();
 	}
+	updateProfiler.endPhase (App::UiUpdatePhase);
+	updateProfiler.beginPhase (App::RootPanelUpdatePhase);
 	rootPanel->update (msElapsed, 0.0f, 0.0f);
+	updateProfiler.endPhase (App::RootPanelUpdatePhase);
+	if (isDrawListEnabled) {
+		updateProfiler.beginPhase (App::RecordDrawListPhase);
+		recordDrawList ();
+		updateProfiler.endPhase (App::RecordDrawListPhase);
+	}
+	input.endUpdate (isDrawListEnabled ? (int64_t) drawListSequence : 0);
 
+	updateProfiler.beginPhase (App::WritePrefsPhase);
 	writePrefs ();
+	updateProfiler.endPhase (App::WritePrefsPhase);
+	updateProfiler.endFrame ();
 	++updateCount;
 
 	SDL_LockMutex (updateMutex);
@@ -821,6 +1052,17 @@ bool App::keyEvent (void *ptr, SDL_Keycode keycode, bool isShiftDown, bool isCon
 				Input::instance->windowClose ();
 				return (true);
 			}
+			case SDLK_t: {
+				if (! App::instance->trace.isEnabled) {
+					return (false);
+				}
+				App::instance->startWriteTraceFile ();
+				return (true);
+			}
+			case SDLK_p: {
+				App::instance->togglePerformanceWindow ();
+				return (true);
+			}
 		}
 	}
 
@@ -956,6 +1198,52 @@ void App::writePrefs () {
 	SDL_UnlockMutex (prefsMapMutex);
 }
 
+void App::writeTraceFile () {
+	int result;
+
+	if ((! trace.isEnabled) || traceFilename.empty ()) {
+		return;
+	}
+	result = trace.writeFile (traceFilename);
+	if (result != OsUtil::Success) {
+		Log::err ("Failed to write trace file; filename=\"%s\" err=%i", traceFilename.c_str (), result);
+		return;
+	}
+	Log::info ("Wrote trace file; filename=\"%s\" droppedEventCount=%i", traceFilename.c_str (), trace.getDroppedEventCount ());
+}
+
+void App::startWriteTraceFile () {
+	if (isWritingTraceFile) {
+		return;
+	}
+	if (! TaskGroup::instance->run (TaskGroup::RunContext (App::writeTraceFileTask, this), TaskGroup::EndCallbackContext (App::writeTraceFileTaskEnded, this))) {
+		Log::err ("Failed to write trace file; err=\"Failed to start task\"");
+		return;
+	}
+	isWritingTraceFile = true;
+}
+
+void App::writeTraceFileTask (void *appPtr) {
+	((App *) appPtr)->writeTraceFile ();
+}
+
+void App::writeTraceFileTaskEnded (void *appPtr, void *taskPtr) {
+	((App *) appPtr)->isWritingTraceFile = false;
+}
+
+void App::togglePerformanceWindow () {
+	Widget *window;
+
+	performanceWindow.compact ();
+	if (performanceWindow.widget) {
+		performanceWindow.destroyAndClear ();
+		return;
+	}
+	window = rootPanel->addWidget (new PerformanceWindow (), UiConfiguration::instance->paddingSize, UiConfiguration::instance->paddingSize);
+	window->zLevel = rootPanel->maxWidgetZLevel + 1;
+	performanceWindow.assign (window);
+}
+
 void App::resizeWindow () {
 	std::vector<Ui *>::iterator i, end;
 	int scale, result;
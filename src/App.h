@@ -39,6 +39,8 @@
 #include "Log.h"
 #include "Input.h"
 #include "TaskGroup.h"
+#include "Animator.h"
+#include "Trace.h"
 #include "Resource.h"
 #include "Network.h"
 #include "HashMap.h"
@@ -47,8 +49,11 @@
 #include "UiText.h"
 #include "UiConfiguration.h"
 #include "Sprite.h"
+#include "DrawList.h"
+#include "FrameProfiler.h"
 #include "Widget.h"
 #include "Panel.h"
+#include "WidgetHandle.h"
 #include "SystemInterface.h"
 
 class App {
@@ -71,6 +76,34 @@ public:
 	static const int FontScaleCount;
 	static const int MaxCornerRadius;
 	static const StdString ServerUrl;
+	static const int DrawListCount = 3;
+
+	// Phases of the main thread's frame loop, as recorded by frameProfiler
+	enum FramePhase {
+		PollEventsPhase = 0,
+		ExecuteRenderTasksPhase = 1,
+		DrawPhase = 2,
+		PresentPhase = 3,
+		ResizeWindowPhase = 4,
+		ExecuteStackCommandsPhase = 5,
+		CompactPhase = 6,
+		FramePhaseCount = 7
+	};
+	static const char *FramePhaseNames[];
+
+	// Phases of the update thread's update pass, as recorded by updateProfiler
+	enum UpdatePhase {
+		AnimatorUpdatePhase = 0,
+		TaskGroupUpdatePhase = 1,
+		UiStackUpdatePhase = 2,
+		ProcessInputPhase = 3,
+		UiUpdatePhase = 4,
+		RootPanelUpdatePhase = 5,
+		RecordDrawListPhase = 6,
+		WritePrefsPhase = 7,
+		UpdatePhaseCount = 8
+	};
+	static const char *UpdatePhaseNames[];
 
 	// Key values for the prefs map
 	static const char *NetworkThreadsKey;
@@ -83,6 +116,8 @@ public:
 	// Read-write data members
 	Log log;
 	Prng prng;
+	Animator animator; // Declared ahead of objects that may hold Position or Color tweens, so that it is destroyed after them
+	Trace trace;
 	Input input;
 	TaskGroup taskGroup;
 	UiStack uiStack;
@@ -114,10 +149,25 @@ public:
 	int windowHeight;
 	int minDrawFrameDelay; // milliseconds
 	int minUpdateFrameDelay; // milliseconds
+	int64_t waitSpinDuration; // nanoseconds; the portion of each frame wait that the main and update threads spend spinning instead of sleeping
+	bool isPresentVsyncEnabled; // If enabled, the renderer synchronizes presentation with the display refresh and the main thread paces its frames by blocking on present instead of sleeping
+	int64_t updateTime; // Monotonic clock value in nanoseconds at the start of the current update pass
 	float fontScale;
 	int imageScale;
 	int64_t drawCount;
 	int64_t updateCount;
+	FrameProfiler frameProfiler; // Phase durations for recent passes of the main thread's frame loop, excluding time spent waiting for the next frame
+	FrameProfiler updateProfiler; // Phase durations for recent update passes, excluding time spent waiting for the next update
+	StdString frameProfileFilename; // If not empty, frame profiler data is written to this file at shutdown
+	StdString updateProfileFilename; // If not empty, update profiler data is written to this file at shutdown
+	StdString traceFilename; // If not empty, trace events are recorded and written to this file at shutdown or on request by keypress
+	int lastDrawnWidgetCount; // Widgets drawn during the last completed frame
+	int lastCulledWidgetCount; // Widgets skipped during the last completed frame because they lie outside the clip rect
+	int lastCachedWidgetCount; // Widgets drawn during the last completed frame by replaying retained draw commands
+	bool isDrawListEnabled; // If enabled, the update thread records a draw list after each update, and the main thread renders the most recently recorded draw list without traversing the widget tree
+	int panelTextureCacheFrames; // If greater than zero, panels with draw keys that stay unchanged for this number of recorded draw lists render their content to a texture and draw that texture until the content changes
+	int64_t panelTextureCacheBudget; // The maximum number of bytes that panels may hold in textures rendered for the automatic texture cache
+	bool isPanelTextureCacheOutlineEnabled; // If enabled, panels drawn from the automatic texture cache are outlined for debugging purposes
 	SDL_Rect clipRect;
 	bool isPrefsWriteDisabled;
 
@@ -154,8 +204,14 @@ public:
 	// Restore a previously suspended clip rectangle
 	void unsuspendClipRect ();
 
-	// Return a texture containing a rounded corner of the specified radius, or NULL if no such texture is available. If a texture is found and width and height pointers are provided, those values are filled in with texture attributes.
-	SDL_Texture *getRoundedCornerTexture (int radius, int *textureWidth = NULL, int *textureHeight = NULL);
+	// Reserve the specified number of bytes for a panel texture cache entry and return a boolean value indicating if the reservation fits within panelTextureCacheBudget
+	bool reservePanelTextureCache (int textureBytes);
+
+	// Release bytes previously reserved by reservePanelTextureCache
+	void releasePanelTextureCache (int textureBytes);
+
+	// Return the atlas texture containing rounded corner masks for all radius values up to MaxCornerRadius, in the cell layout expected by DrawList::fillRoundedRect, or NULL if the atlas is not available
+	SDL_Texture *getRoundedCornerAtlas ();
 
 	typedef void (*RenderTaskFunction) (void *fnData);
 	struct RenderTaskContext {
@@ -193,13 +249,16 @@ private:
 	// Create the root panel and other top-level widgets
 	void populateWidgets ();
 
-	// Create roundedCornerSprite and load it with textures
+	// Create roundedCornerSprite and load it with the rounded corner atlas texture
 	void populateRoundedCornerSprite ();
 
 	// Execute draw operations to update the application window
 	void draw ();
 
-	// Execute all operations in renderTaskList
+	// Record a draw list for the current widget tree and publish it for execution by the main thread. This method is executed by the application's update thread.
+	void recordDrawList ();
+
+	// Execute all operations in renderTaskList and upload textures from pending asynchronous load requests
 	void executeRenderTasks ();
 
 	// Execute operations to update application state as appropriate for an elapsed millisecond time period
@@ -217,6 +276,19 @@ private:
 	// Write the prefs file if any prefsMap keys have changed since the last write
 	void writePrefs ();
 
+	// Write recorded trace events to traceFilename, if trace recording is enabled
+	void writeTraceFile ();
+
+	// Start a TaskGroup task that executes writeTraceFile, unless such a task is already running
+	void startWriteTraceFile ();
+	static void writeTraceFileTask (void *appPtr);
+	static void writeTraceFileTaskEnded (void *appPtr, void *taskPtr);
+
+	// Show the performance window if it is hidden, or remove it if it is showing
+	void togglePerformanceWindow ();
+
+	WidgetHandle performanceWindow;
+	bool isWritingTraceFile;
 	SDL_Thread *updateThread;
 	SDL_mutex *uniqueIdMutex;
 	int64_t nextUniqueId;
@@ -231,6 +303,19 @@ private:
 	bool isSuspendingUpdate;
 	SDL_mutex *updateMutex;
 	SDL_cond *updateCond;
+
+	// Draw lists for use by the application's main thread and update thread, which exchange ownership of list indexes through drawListPublishState. The update thread owns drawListRecordIndex, the main thread owns drawListExecuteIndex, and the remaining list is held by drawListPublishState, which is set with DrawListPublishedFlag when that list holds newly recorded commands.
+	enum {
+		DrawListIndexMask = 0xFF,
+		DrawListPublishedFlag = 0x100
+	};
+	DrawList frameDrawList;
+	DrawList drawLists[App::DrawListCount];
+	int drawListRecordIndex;
+	int drawListExecuteIndex;
+	SDL_atomic_t drawListPublishState;
+	int drawListSequence;
+	SDL_atomic_t panelTextureCacheBytes;
 };
 
 #endif
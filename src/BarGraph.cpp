@@ -0,0 +1,138 @@
+/*
+* Copyright 2018-2022 Membrane Software <author@membranesoftware.com> https://membranesoftware.com
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+* this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+* this list of conditions and the following disclaimer in the documentation
+* and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors
+* may be used to endorse or promote products derived from this software without
+* specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "Config.h"
+#include <stdlib.h>
+#include <vector>
+#include "SDL2/SDL.h"
+#include "App.h"
+#include "Color.h"
+#include "DrawList.h"
+#include "Widget.h"
+#include "UiConfiguration.h"
+#include "BarGraph.h"
+
+BarGraph::BarGraph (int barCount, float graphWidth, float graphHeight)
+: Widget ()
+, barCount (barCount)
+, maxValue (0)
+{
+	if (this->barCount < 1) {
+		this->barCount = 1;
+	}
+	width = graphWidth;
+	height = graphHeight;
+	values.resize (this->barCount, 0);
+	bgColor.assign (UiConfiguration::instance->darkBackgroundColor);
+	barColor.assign (UiConfiguration::instance->mediumSecondaryColor);
+}
+
+BarGraph::~BarGraph () {
+
+}
+
+void BarGraph::setSize (float graphWidth, float graphHeight) {
+	assignSize (graphWidth, graphHeight);
+}
+
+void BarGraph::setValues (const std::vector<int> &valueList) {
+	int i, value, max;
+
+	max = 0;
+	for (i = 0; i < barCount; ++i) {
+		value = 0;
+		if (i < (int) valueList.size ()) {
+			value = valueList[i];
+			if (value < 0) {
+				value = 0;
+			}
+		}
+		values[i] = value;
+		if (value > max) {
+			max = value;
+		}
+	}
+	maxValue = max;
+}
+
+uint64_t BarGraph::getDrawKey (DrawList *drawList, const SDL_Rect &clipRect, float originX, float originY) {
+	uint64_t key;
+	int i;
+
+	key = DrawList::DrawKeyBasis;
+	key = DrawList::hashDrawKey (key, (int) (originX + position.x));
+	key = DrawList::hashDrawKey (key, (int) (originY + position.y));
+	key = DrawList::hashDrawKey (key, (int) width);
+	key = DrawList::hashDrawKey (key, (int) height);
+	key = DrawList::hashDrawKey (key, maxValue);
+	for (i = 0; i < barCount; ++i) {
+		key = DrawList::hashDrawKey (key, values[i]);
+	}
+
+	return (key);
+}
+
+void BarGraph::doDraw (DrawList *drawList, float originX, float originY) {
+	SDL_Rect rect;
+	int i, x0, y0, w, h, max, barheight;
+
+	x0 = (int) (originX + position.x);
+	y0 = (int) (originY + position.y);
+	w = (int) width;
+	h = (int) height;
+	rect.x = x0;
+	rect.y = y0;
+	rect.w = w;
+	rect.h = h;
+	drawList->fillRect (rect, bgColor.rByte, bgColor.gByte, bgColor.bByte);
+
+	max = maxValue;
+	if ((max <= 0) || (w <= 0) || (h <= 0)) {
+		return;
+	}
+	for (i = 0; i < barCount; ++i) {
+		barheight = (int) ((((int64_t) values[i]) * h) / max);
+		if ((values[i] > 0) && (barheight < 1)) {
+			barheight = 1;
+		}
+		if (barheight <= 0) {
+			continue;
+		}
+
+		// Bar edges are computed from the graph width so that bars fill the graph without accumulated rounding gaps
+		rect.x = x0 + ((i * w) / barCount);
+		rect.w = (x0 + (((i + 1) * w) / barCount)) - rect.x - 1;
+		if (rect.w < 1) {
+			rect.w = 1;
+		}
+		rect.y = y0 + h - barheight;
+		rect.h = barheight;
+		drawList->fillRect (rect, barColor.rByte, barColor.gByte, barColor.bByte);
+	}
+}
@@ -0,0 +1,69 @@
+/*
+* Copyright 2018-2022 Membrane Software <author@membranesoftware.com> https://membranesoftware.com
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+* this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+* this list of conditions and the following disclaimer in the documentation
+* and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors
+* may be used to endorse or promote products derived from this software without
+* specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*/
+// Widget that shows a fixed number of values as vertical bars
+
+#ifndef BAR_GRAPH_H
+#define BAR_GRAPH_H
+
+#include <vector>
+#include "Color.h"
+#include "DrawList.h"
+#include "Widget.h"
+
+class BarGraph : public Widget {
+public:
+	BarGraph (int barCount, float graphWidth = 0.0f, float graphHeight = 0.0f);
+	~BarGraph ();
+
+	// Read-only data members
+	int barCount;
+
+	// Set the graph's size
+	void setSize (float graphWidth, float graphHeight);
+
+	// Set the values shown by the graph's bars, scaling bar heights so that the largest value fills the graph. Values beyond barCount are ignored, and bars beyond the end of valueList are set to zero.
+	void setValues (const std::vector<int> &valueList);
+
+protected:
+	// Add subclass-specific draw commands to drawList. If the list holds a non-NULL targetTexture, draw commands render to that texture and should adjust coordinates as appropriate.
+	virtual void doDraw (DrawList *drawList, float originX, float originY);
+
+	// Return a hash of all values that affect commands added by doDraw with the specified clip rectangle and origin position, or zero if the widget's draw commands should not be retained for replay
+	virtual uint64_t getDrawKey (DrawList *drawList, const SDL_Rect &clipRect, float originX, float originY);
+
+private:
+	// Bar values, sized to barCount at construction and never resized, so that the draw thread can read them while the update thread sets new values
+	std::vector<int> values;
+	int maxValue;
+	Color bgColor;
+	Color barColor;
+};
+
+#endif
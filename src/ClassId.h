@@ -81,6 +81,7 @@ public:
 	static const int UiTextString = 44;
 	static const int Widget = 45;
 	static const int WidgetHandle = 46;
+	static const int VirtualListView = 47;
 };
 
 #endif
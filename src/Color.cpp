@@ -31,6 +31,7 @@
 #include <stdlib.h>
 #include <math.h>
 #include "StdString.h"
+#include "Animator.h"
 #include "Color.h"
 
 Color::Color (float r, float g, float b, float a)
@@ -40,33 +41,48 @@ Color::Color (float r, float g, float b, float a)
 , a (a)
 , isTranslating (false)
 , isAnimating (false)
+, translateEasing (Animator::LinearEasing)
+, tweenIndex (-1)
+, translateDuration (0)
+, targetR (0.0f)
+, targetG (0.0f)
+, targetB (0.0f)
+, targetA (0.0f)
+{
+	normalize ();
+}
+
+Color::Color (const Color &copySource)
+: r (copySource.r)
+, g (copySource.g)
+, b (copySource.b)
+, a (copySource.a)
+, isTranslating (false)
+, isAnimating (false)
+, translateEasing (copySource.translateEasing)
+, tweenIndex (-1)
 , translateDuration (0)
-, animateDuration (0)
-, animateRepeatDelay (0)
-, animateStage (0)
-, animateClock (0)
 , targetR (0.0f)
 , targetG (0.0f)
 , targetB (0.0f)
 , targetA (0.0f)
-, deltaR (0.0f)
-, deltaG (0.0f)
-, deltaB (0.0f)
-, deltaA (0.0f)
-, animateColor1R (0.0f)
-, animateColor1G (0.0f)
-, animateColor1B (0.0f)
-, animateColor1A (0.0f)
-, animateColor2R (0.0f)
-, animateColor2G (0.0f)
-, animateColor2B (0.0f)
-, animateColor2A (0.0f)
 {
 	normalize ();
 }
 
 Color::~Color () {
+	if ((tweenIndex >= 0) && Animator::instance) {
+		Animator::instance->cancelColor (this);
+	}
+}
 
+Color &Color::operator= (const Color &sourceColor) {
+	// Copies take the source's current values, but not its active tween
+	if (this != &sourceColor) {
+		assign (sourceColor.r, sourceColor.g, sourceColor.b, sourceColor.a);
+		translateEasing = sourceColor.translateEasing;
+	}
+	return (*this);
 }
 
 void Color::normalize () {
@@ -102,7 +118,7 @@ void Color::normalize () {
 }
 
 StdString Color::toString () const {
-	return (StdString::createSprintf ("{color: r=%.2f g=%.2f b=%.2f a=%.2f rByte=%i gByte=%i bByte=%i aByte=%i isTranslating=%s deltaR=%.2f deltaG=%.2f deltaB=%.2f}", r, g, b, a, rByte, gByte, bByte, aByte, BOOL_STRING (isTranslating), deltaR, deltaG, deltaB));
+	return (StdString::createSprintf ("{color: r=%.2f g=%.2f b=%.2f a=%.2f rByte=%i gByte=%i bByte=%i aByte=%i isTranslating=%s isAnimating=%s targetR=%.2f targetG=%.2f targetB=%.2f targetA=%.2f}", r, g, b, a, rByte, gByte, bByte, aByte, BOOL_STRING (isTranslating), BOOL_STRING (isAnimating), targetR, targetG, targetB, targetA));
 }
 
 Color Color::copy (float aValue) {
@@ -110,22 +126,42 @@ Color Color::copy (float aValue) {
 }
 
 void Color::assign (float rValue, float gValue, float bValue) {
+	if ((tweenIndex >= 0) && Animator::instance) {
+		Animator::instance->cancelColor (this);
+	}
 	r = rValue;
 	g = gValue;
 	b = bValue;
 	isTranslating = false;
+	isAnimating = false;
 	normalize ();
 }
 
 void Color::assign (float rValue, float gValue, float bValue, float aValue) {
+	if ((tweenIndex >= 0) && Animator::instance) {
+		Animator::instance->cancelColor (this);
+	}
 	r = rValue;
 	g = gValue;
 	b = bValue;
 	a = aValue;
 	isTranslating = false;
+	isAnimating = false;
 	normalize ();
 }
 
+void Color::setTweenValues (float rValue, float gValue, float bValue, float aValue) {
+	r = rValue;
+	g = gValue;
+	b = bValue;
+	a = aValue;
+	normalize ();
+}
+
+void Color::setEasing (Animator::Easing easing) {
+	translateEasing = easing;
+}
+
 void Color::assign (const Color &sourceColor) {
 	assign (sourceColor.r, sourceColor.g, sourceColor.b, sourceColor.a);
 }
@@ -169,153 +205,8 @@ void Color::blend (const Color &sourceColor, float alpha) {
 	blend (sourceColor.r, sourceColor.g, sourceColor.b, alpha);
 }
 
-void Color::update (int msElapsed) {
-	int matchcount;
-
-	if (isTranslating) {
-		matchcount = 0;
-
-		r += (deltaR * (float) msElapsed);
-		if (deltaR < 0.0f) {
-			if (r <= targetR) {
-				r = targetR;
-				++matchcount;
-			}
-		}
-		else {
-			if (r >= targetR) {
-				r = targetR;
-				++matchcount;
-			}
-		}
-
-		g += (deltaG * (float) msElapsed);
-		if (deltaG < 0.0f) {
-			if (g <= targetG) {
-				g = targetG;
-				++matchcount;
-			}
-		}
-		else {
-			if (g >= targetG) {
-				g = targetG;
-				++matchcount;
-			}
-		}
-
-		b += (deltaB * (float) msElapsed);
-		if (deltaB < 0.0f) {
-			if (b <= targetB) {
-				b = targetB;
-				++matchcount;
-			}
-		}
-		else {
-			if (b >= targetB) {
-				b = targetB;
-				++matchcount;
-			}
-		}
-
-		a += (deltaA * (float) msElapsed);
-		if (deltaA < 0.0f) {
-			if (a <= targetA) {
-				a = targetA;
-				++matchcount;
-			}
-		}
-		else {
-			if (a >= targetA) {
-				a = targetA;
-				++matchcount;
-			}
-		}
-
-		normalize ();
-		if (matchcount >= 4) {
-			isTranslating = false;
-		}
-	}
-
-	if (isAnimating) {
-		switch (animateStage) {
-			case 0: {
-				if (! isTranslating) {
-					translate (animateColor2R, animateColor2G, animateColor2B, animateColor2A, animateDuration / 2);
-					animateStage = 1;
-				}
-				break;
-			}
-			case 1: {
-				if (! isTranslating) {
-					translate (animateColor1R, animateColor1G, animateColor1B, animateColor1A, animateDuration / 2);
-					animateStage = 2;
-					animateClock = animateRepeatDelay;
-				}
-				break;
-			}
-			case 2: {
-				if (! isTranslating) {
-					animateClock -= msElapsed;
-					if (animateClock <= 0) {
-						animateStage = 0;
-					}
-				}
-				break;
-			}
-		}
-	}
-}
-
 void Color::translate (float translateTargetR, float translateTargetG, float translateTargetB, int durationMs) {
-	float dr, dg, db;
-
-	if (translateTargetR < 0.0f) {
-		translateTargetR = 0.0f;
-	}
-	else if (translateTargetR > 1.0f) {
-		translateTargetR = 1.0f;
-	}
-	if (translateTargetG < 0.0f) {
-		translateTargetG = 0.0f;
-	}
-	else if (translateTargetG > 1.0f) {
-		translateTargetG = 1.0f;
-	}
-	if (translateTargetB < 0.0f) {
-		translateTargetB = 0.0f;
-	}
-	else if (translateTargetB > 1.0f) {
-		translateTargetB = 1.0f;
-	}
-
-	if (durationMs <= 0) {
-		assign (translateTargetR, translateTargetG, translateTargetB);
-		return;
-	}
-
-	dr = translateTargetR - r;
-	dg = translateTargetG - g;
-	db = translateTargetB - b;
-	if ((fabs (dr) < CONFIG_FLOAT_EPSILON) && (fabs (dg) < CONFIG_FLOAT_EPSILON) && (fabs (db) < CONFIG_FLOAT_EPSILON)) {
-		isTranslating = false;
-		return;
-	}
-
-	if (isTranslating && FLOAT_EQUALS (translateTargetR, targetR) && FLOAT_EQUALS (translateTargetG, targetG) && FLOAT_EQUALS (translateTargetB, targetB) && (translateDuration == durationMs)) {
-		return;
-	}
-
-	isTranslating = true;
-	translateDuration = durationMs;
-	targetR = translateTargetR;
-	targetG = translateTargetG;
-	targetB = translateTargetB;
-	targetA = a;
-	deltaR = dr / ((float) durationMs);
-	deltaG = dg / ((float) durationMs);
-	deltaB = db / ((float) durationMs);
-	deltaA = 0.0f;
+	translate (translateTargetR, translateTargetG, translateTargetB, a, durationMs);
 }
 
 void Color::translate (float translateTargetR, float translateTargetG, float translateTargetB, float translateTargetA, int durationMs) {
@@ -346,7 +237,7 @@ void Color::translate (float translateTargetR, float translateTargetG, float tra
 		translateTargetA = 1.0f;
 	}
 
-	if (durationMs <= 0) {
+	if ((durationMs <= 0) || (! Animator::instance)) {
 		assign (translateTargetR, translateTargetG, translateTargetB, translateTargetA);
 		return;
 	}
@@ -356,7 +247,9 @@ void Color::translate (float translateTargetR, float translateTargetG, float tra
 	db = translateTargetB - b;
 	da = translateTargetA - a;
 	if ((fabs (dr) < CONFIG_FLOAT_EPSILON) && (fabs (dg) < CONFIG_FLOAT_EPSILON) && (fabs (db) < CONFIG_FLOAT_EPSILON) && (fabs (da) <= CONFIG_FLOAT_EPSILON)) {
-		isTranslating = false;
+		if (isTranslating || isAnimating) {
+			assign (r, g, b, a);
+		}
 		return;
 	}
 
@@ -364,16 +257,12 @@ void Color::translate (float translateTargetR, float translateTargetG, float tra
 		return;
 	}
 
-	isTranslating = true;
 	translateDuration = durationMs;
 	targetR = translateTargetR;
 	targetG = translateTargetG;
 	targetB = translateTargetB;
 	targetA = translateTargetA;
-	deltaR = dr / ((float) durationMs);
-	deltaG = dg / ((float) durationMs);
-	deltaB = db / ((float) durationMs);
-	deltaA = da / ((float) durationMs);
+	Animator::instance->translateColor (this, targetR, targetG, targetB, targetA, durationMs, translateEasing);
 }
 
 void Color::translate (const Color &targetColor, int durationMs) {
@@ -390,22 +279,9 @@ void Color::animate (const Color &color1, const Color &color2, int durationMs, i
 	if (durationMs <= 0) {
 		return;
 	}
-	animateColor1R = color1.r;
-	animateColor1G = color1.g;
-	animateColor1B = color1.b;
-	animateColor1A = color1.a;
-	animateColor2R = color2.r;
-	animateColor2G = color2.g;
-	animateColor2B = color2.b;
-	animateColor2A = color2.a;
-	animateDuration = durationMs;
-	animateRepeatDelay = repeatDelayMs;
-	if (animateRepeatDelay < 0) {
-		animateRepeatDelay = 0;
-	}
-	animateStage = 0;
-	animateClock = 0;
-	isAnimating = true;
+	if (Animator::instance) {
+		Animator::instance->animateColor (this, color1, color2, durationMs, repeatDelayMs);
+	}
 }
 
 bool Color::equals (const Color &other) const {
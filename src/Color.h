@@ -33,17 +33,22 @@
 #define COLOR_H
 
 #include "StdString.h"
+#include "Animator.h"
 
 class Color {
 public:
 	Color (float r = 0.0f, float g = 0.0f, float b = 0.0f, float a = 1.0f);
+	Color (const Color &copySource);
 	~Color ();
+	Color &operator= (const Color &sourceColor);
 
 	// Read-only data members
 	float r, g, b, a;
 	uint8_t rByte, gByte, bByte, aByte;
 	bool isTranslating;
 	bool isAnimating;
+	Animator::Easing translateEasing;
+	int tweenIndex; // The index of the color's active tween in Animator storage, or -1 if no tween is active
 
 	// Return a string description of the color
 	StdString toString () const;
@@ -69,8 +74,11 @@ public:
 	void blend (float r, float g, float b, float alpha);
 	void blend (const Color &sourceColor, float alpha);
 
-	// Execute operations to update object state as appropriate for an elapsed millisecond time period
-	void update (int msElapsed);
+	// Set the color's values as computed by its active tween, without ending the tween. This method is intended for use by Animator.
+	void setTweenValues (float rValue, float gValue, float bValue, float aValue);
+
+	// Set the easing curve applied to translations begun after this call
+	void setEasing (Animator::Easing easing);
 
 	// Begin an operation to change the color's value over time
 	void translate (float translateTargetR, float translateTargetG, float translateTargetB, int durationMs);
@@ -86,14 +94,7 @@ private:
 	void normalize ();
 
 	int translateDuration;
-	int animateDuration;
-	int animateRepeatDelay;
-	int animateStage;
-	int animateClock;
 	float targetR, targetG, targetB, targetA;
-	float deltaR, deltaG, deltaB, deltaA;
-	float animateColor1R, animateColor1G, animateColor1B, animateColor1A;
-	float animateColor2R, animateColor2G, animateColor2B, animateColor2A;
 };
 
 #endif
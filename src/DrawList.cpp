@@ -0,0 +1,641 @@
+/*
+* Copyright 2018-2022 Membrane Software <author@membranesoftware.com> https://membranesoftware.com
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+* this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+* this list of conditions and the following disclaimer in the documentation
+* and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors
+* may be used to endorse or promote products derived from this software without
+* specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "Config.h"
+#include <stdlib.h>
+#include <vector>
+#include <stack>
+#include "SDL2/SDL.h"
+#include "Font.h"
+#include "DrawList.h"
+
+const uint64_t DrawList::DrawKeyBasis = 0xCBF29CE484222325ULL;
+const int DrawList::MaxRetainedCommandCount = 2048;
+
+DrawList::DrawList ()
+: immediateRender (NULL)
+, targetTexture (NULL)
+, sequence (0)
+, drawnWidgetCount (0)
+, culledWidgetCount (0)
+, cachedWidgetCount (0)
+, stateChangeCount (0)
+, skippedStateChangeCount (0)
+, drawWidth (0)
+, drawHeight (0)
+{
+	clipRect.x = 0;
+	clipRect.y = 0;
+	clipRect.w = 0;
+	clipRect.h = 0;
+}
+
+DrawList::~DrawList () {
+
+}
+
+void DrawList::begin (int drawWidth, int drawHeight, SDL_Renderer *render, SDL_Texture *texture) {
+	commandList.clear ();
+	widgetRangeList.clear ();
+	while (! clipRectStack.empty ()) {
+		clipRectStack.pop ();
+	}
+	this->drawWidth = drawWidth;
+	this->drawHeight = drawHeight;
+	clipRect.x = 0;
+	clipRect.y = 0;
+	clipRect.w = drawWidth;
+	clipRect.h = drawHeight;
+	drawnWidgetCount = 0;
+	culledWidgetCount = 0;
+	cachedWidgetCount = 0;
+	immediateRender = render;
+	targetTexture = texture;
+	if (immediateRender) {
+		if (targetTexture) {
+			SDL_SetRenderTarget (immediateRender, targetTexture);
+		}
+		resetRenderState (immediateRender);
+	}
+}
+
+void DrawList::end () {
+	if (immediateRender) {
+		resetRenderState (immediateRender);
+		if (targetTexture) {
+			SDL_SetRenderTarget (immediateRender, NULL);
+		}
+	}
+	while (! clipRectStack.empty ()) {
+		clipRectStack.pop ();
+	}
+	immediateRender = NULL;
+}
+
+int DrawList::getCommandCount () const {
+	return ((int) commandList.size ());
+}
+
+bool DrawList::isRecording () const {
+	return (immediateRender == NULL);
+}
+
+void DrawList::getCommands (int startIndex, int endIndex, std::vector<DrawList::Command> *destList) const {
+	if (startIndex < 0) {
+		startIndex = 0;
+	}
+	if (endIndex > (int) commandList.size ()) {
+		endIndex = (int) commandList.size ();
+	}
+	if (startIndex >= endIndex) {
+		return;
+	}
+	destList->insert (destList->end (), commandList.cbegin () + startIndex, commandList.cbegin () + endIndex);
+}
+
+void DrawList::addCommands (const std::vector<DrawList::Command> &commands, int startIndex, int endIndex) {
+	std::vector<DrawList::Command>::const_iterator i, end;
+
+	if (startIndex < 0) {
+		startIndex = 0;
+	}
+	if (endIndex > (int) commands.size ()) {
+		endIndex = (int) commands.size ();
+	}
+	if (startIndex >= endIndex) {
+		return;
+	}
+	i = commands.cbegin () + startIndex;
+	end = commands.cbegin () + endIndex;
+	while (i != end) {
+		// Clip changes are mirrored so that widgets drawn between retained commands see the same clip state as when the commands were recorded
+		if (i->flags & DrawList::ClipPushFlag) {
+			clipRect = i->rect;
+			clipRectStack.push (clipRect);
+		}
+		else if ((i->flags & DrawList::ClipPopFlag) && (! clipRectStack.empty ())) {
+			clipRectStack.pop ();
+			if (clipRectStack.empty ()) {
+				clipRect.x = 0;
+				clipRect.y = 0;
+				clipRect.w = drawWidth;
+				clipRect.h = drawHeight;
+			}
+			else {
+				clipRect = clipRectStack.top ();
+			}
+		}
+
+		if (immediateRender) {
+			executeCommand (immediateRender, *i);
+		}
+		else {
+			commandList.push_back (*i);
+		}
+		++i;
+	}
+}
+
+int DrawList::getWidgetRangeCount () const {
+	return ((int) widgetRangeList.size ());
+}
+
+void DrawList::endWidgetRange (int startIndex, const DrawList::WidgetRange &range, std::vector<DrawList::WidgetRange> *childRanges) {
+	if (startIndex < 0) {
+		startIndex = 0;
+	}
+	if (startIndex < (int) widgetRangeList.size ()) {
+		if (childRanges) {
+			childRanges->insert (childRanges->end (), widgetRangeList.cbegin () + startIndex, widgetRangeList.cend ());
+		}
+		widgetRangeList.resize (startIndex);
+	}
+	widgetRangeList.push_back (range);
+}
+
+void DrawList::execute (SDL_Renderer *render) {
+	std::vector<DrawList::Command>::const_iterator i, end;
+
+	stateChangeCount = 0;
+	skippedStateChangeCount = 0;
+	resetRenderState (render);
+	i = commandList.cbegin ();
+	end = commandList.cend ();
+	while (i != end) {
+		executeCommand (render, *i);
+		++i;
+	}
+	resetRenderState (render);
+}
+
+void DrawList::addCommand (const DrawList::Command &command) {
+	if (immediateRender) {
+		executeCommand (immediateRender, command);
+		return;
+	}
+	commandList.push_back (command);
+}
+
+void DrawList::resetRenderState (SDL_Renderer *render) {
+	renderState = DrawList::RenderState ();
+	SDL_SetRenderDrawColor (render, 0, 0, 0, 0);
+	SDL_SetRenderDrawBlendMode (render, SDL_BLENDMODE_NONE);
+	SDL_RenderSetClipRect (render, NULL);
+}
+
+void DrawList::setDrawColor (SDL_Renderer *render, Uint8 r, Uint8 g, Uint8 b, Uint8 a) {
+	if ((renderState.r == r) && (renderState.g == g) && (renderState.b == b) && (renderState.a == a)) {
+		++skippedStateChangeCount;
+		return;
+	}
+	renderState.r = r;
+	renderState.g = g;
+	renderState.b = b;
+	renderState.a = a;
+	SDL_SetRenderDrawColor (render, r, g, b, a);
+	++stateChangeCount;
+}
+
+void DrawList::setBlendMode (SDL_Renderer *render, SDL_BlendMode blendMode) {
+	if (renderState.blendMode == blendMode) {
+		++skippedStateChangeCount;
+		return;
+	}
+	renderState.blendMode = blendMode;
+	SDL_SetRenderDrawBlendMode (render, blendMode);
+	++stateChangeCount;
+}
+
+void DrawList::setTextureColorMod (SDL_Texture *texture, Uint8 r, Uint8 g, Uint8 b) {
+	if ((renderState.colorModTexture == texture) && (renderState.colorModR == r) && (renderState.colorModG == g) && (renderState.colorModB == b)) {
+		++skippedStateChangeCount;
+		return;
+	}
+	renderState.colorModTexture = texture;
+	renderState.colorModR = r;
+	renderState.colorModG = g;
+	renderState.colorModB = b;
+	SDL_SetTextureColorMod (texture, r, g, b);
+	++stateChangeCount;
+}
+
+void DrawList::setTextureAlphaMod (SDL_Texture *texture, Uint8 a) {
+	if ((renderState.alphaModTexture == texture) && (renderState.alphaMod == a)) {
+		++skippedStateChangeCount;
+		return;
+	}
+	renderState.alphaModTexture = texture;
+	renderState.alphaMod = a;
+	SDL_SetTextureAlphaMod (texture, a);
+	++stateChangeCount;
+}
+
+void DrawList::executeCommand (SDL_Renderer *render, const DrawList::Command &command) {
+	SDL_Texture *texture;
+	SDL_Rect rect;
+
+	switch (command.type) {
+		case DrawList::FillRectCommand: {
+			setBlendMode (render, command.blendMode);
+			setDrawColor (render, command.r, command.g, command.b, command.a);
+			SDL_RenderFillRect (render, &(command.rect));
+			break;
+		}
+		case DrawList::DrawLineCommand: {
+			setBlendMode (render, SDL_BLENDMODE_NONE);
+			setDrawColor (render, command.r, command.g, command.b, command.a);
+			SDL_RenderDrawLine (render, command.rect.x, command.rect.y, command.rect.w, command.rect.h);
+			break;
+		}
+		case DrawList::CopyTextureCommand: {
+			setTextureColorMod (command.texture, command.r, command.g, command.b);
+			setTextureAlphaMod (command.texture, command.a);
+			if (command.flags & DrawList::BlendModeFlag) {
+				SDL_SetTextureBlendMode (command.texture, command.blendMode);
+			}
+			SDL_RenderCopy (render, command.texture, (command.flags & DrawList::SourceRectFlag) ? &(command.sourceRect) : NULL, &(command.rect));
+			break;
+		}
+		case DrawList::CopyGlyphCommand: {
+			texture = command.font->getGlyphTexture (command.glyph);
+			if (texture) {
+				rect.x = command.rect.x + command.glyph->textureOffsetX;
+				rect.y = command.rect.y + command.glyph->textureOffsetY;
+				rect.w = command.glyph->textureRect.w;
+				rect.h = command.glyph->textureRect.h;
+				setTextureColorMod (texture, command.r, command.g, command.b);
+				SDL_RenderCopy (render, texture, &(command.glyph->textureRect), &rect);
+			}
+			break;
+		}
+		case DrawList::FillRoundedRectCommand: {
+			executeFillRoundedRect (render, command);
+			break;
+		}
+		case DrawList::SetClipRectCommand: {
+			if (command.flags & DrawList::ClipRectFlag) {
+				if (renderState.isClipped && (renderState.clipRect.x == command.rect.x) && (renderState.clipRect.y == command.rect.y) && (renderState.clipRect.w == command.rect.w) && (renderState.clipRect.h == command.rect.h)) {
+					++skippedStateChangeCount;
+					break;
+				}
+				renderState.isClipped = true;
+				renderState.clipRect = command.rect;
+				SDL_RenderSetClipRect (render, &(command.rect));
+			}
+			else {
+				if (! renderState.isClipped) {
+					++skippedStateChangeCount;
+					break;
+				}
+				renderState.isClipped = false;
+				SDL_RenderSetClipRect (render, NULL);
+			}
+			++stateChangeCount;
+			break;
+		}
+	}
+}
+
+int DrawList::addGeometryQuad (DrawList::GeometryQuad *quads, int quadCount, int x, int y, int w, int h, int sourceX, int sourceY, int sourceW, int sourceH, int flip) {
+	DrawList::GeometryQuad *quad;
+
+	if ((w <= 0) || (h <= 0) || (quadCount >= DrawList::MaxGeometryQuadCount)) {
+		return (quadCount);
+	}
+	quad = &(quads[quadCount]);
+	quad->destRect.x = x;
+	quad->destRect.y = y;
+	quad->destRect.w = w;
+	quad->destRect.h = h;
+	quad->sourceRect.x = sourceX;
+	quad->sourceRect.y = sourceY;
+	quad->sourceRect.w = sourceW;
+	quad->sourceRect.h = sourceH;
+	quad->flip = flip;
+	return (quadCount + 1);
+}
+
+void DrawList::executeFillRoundedRect (SDL_Renderer *render, const DrawList::Command &command) {
+	DrawList::GeometryQuad quads[DrawList::MaxGeometryQuadCount], *quad;
+	int quadcount, i, x, y, w, h, tl, tr, bl, br, toph, bottomh, cellsize, texturew, textureh;
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+	SDL_Vertex vertex;
+	float u0, u1, v0, v1, swap;
+	int index;
+#endif
+
+	if (SDL_QueryTexture (command.texture, NULL, NULL, &texturew, &textureh) != 0) {
+		return;
+	}
+	cellsize = textureh;
+	if ((cellsize < 3) || (texturew <= 0)) {
+		return;
+	}
+
+	x = command.rect.x;
+	y = command.rect.y;
+	w = command.rect.w;
+	h = command.rect.h;
+	tl = command.sourceRect.x;
+	tr = command.sourceRect.y;
+	bl = command.sourceRect.w;
+	br = command.sourceRect.h;
+	toph = (tl > tr) ? tl : tr;
+	bottomh = (bl > br) ? bl : br;
+
+	// Corner quads sample the top left mask for their radius, flipped as needed to face each corner. Fill quads sample the interior of the opaque cell, away from its edges to avoid filtering with neighboring cells.
+	quadcount = 0;
+	quadcount = DrawList::addGeometryQuad (quads, quadcount, x, y, tl, tl, tl * cellsize, 0, tl, tl, SDL_FLIP_NONE);
+	quadcount = DrawList::addGeometryQuad (quads, quadcount, x + w - tr, y, tr, tr, tr * cellsize, 0, tr, tr, SDL_FLIP_HORIZONTAL);
+	quadcount = DrawList::addGeometryQuad (quads, quadcount, x, y + h - bl, bl, bl, bl * cellsize, 0, bl, bl, SDL_FLIP_VERTICAL);
+	quadcount = DrawList::addGeometryQuad (quads, quadcount, x + w - br, y + h - br, br, br, br * cellsize, 0, br, br, SDL_FLIP_HORIZONTAL | SDL_FLIP_VERTICAL);
+	quadcount = DrawList::addGeometryQuad (quads, quadcount, x, y + toph, w, h - toph - bottomh, 1, 1, cellsize - 2, cellsize - 2, SDL_FLIP_NONE);
+	quadcount = DrawList::addGeometryQuad (quads, quadcount, x + tl, y, w - tl - tr, toph, 1, 1, cellsize - 2, cellsize - 2, SDL_FLIP_NONE);
+	quadcount = DrawList::addGeometryQuad (quads, quadcount, x, y + tl, tl, toph - tl, 1, 1, cellsize - 2, cellsize - 2, SDL_FLIP_NONE);
+	quadcount = DrawList::addGeometryQuad (quads, quadcount, x + w - tr, y + tr, tr, toph - tr, 1, 1, cellsize - 2, cellsize - 2, SDL_FLIP_NONE);
+	quadcount = DrawList::addGeometryQuad (quads, quadcount, x + bl, y + h - bottomh, w - bl - br, bottomh, 1, 1, cellsize - 2, cellsize - 2, SDL_FLIP_NONE);
+	quadcount = DrawList::addGeometryQuad (quads, quadcount, x, y + h - bottomh, bl, bottomh - bl, 1, 1, cellsize - 2, cellsize - 2, SDL_FLIP_NONE);
+	quadcount = DrawList::addGeometryQuad (quads, quadcount, x + w - br, y + h - bottomh, br, bottomh - br, 1, 1, cellsize - 2, cellsize - 2, SDL_FLIP_NONE);
+	if (quadcount <= 0) {
+		return;
+	}
+
+	SDL_SetTextureBlendMode (command.texture, SDL_BLENDMODE_BLEND);
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+	// Vertex colors carry the fill color, leaving texture modulation at its neutral value
+	setTextureColorMod (command.texture, 255, 255, 255);
+	setTextureAlphaMod (command.texture, 255);
+	geometryVertices.clear ();
+	geometryIndices.clear ();
+	vertex.color.r = command.r;
+	vertex.color.g = command.g;
+	vertex.color.b = command.b;
+	vertex.color.a = command.a;
+	for (i = 0; i < quadcount; ++i) {
+		quad = &(quads[i]);
+		u0 = ((float) quad->sourceRect.x) / (float) texturew;
+		u1 = ((float) (quad->sourceRect.x + quad->sourceRect.w)) / (float) texturew;
+		v0 = ((float) quad->sourceRect.y) / (float) textureh;
+		v1 = ((float) (quad->sourceRect.y + quad->sourceRect.h)) / (float) textureh;
+		if (quad->flip & SDL_FLIP_HORIZONTAL) {
+			swap = u0;
+			u0 = u1;
+			u1 = swap;
+		}
+		if (quad->flip & SDL_FLIP_VERTICAL) {
+			swap = v0;
+			v0 = v1;
+			v1 = swap;
+		}
+
+		index = (int) geometryVertices.size ();
+		vertex.position.x = (float) quad->destRect.x;
+		vertex.position.y = (float) quad->destRect.y;
+		vertex.tex_coord.x = u0;
+		vertex.tex_coord.y = v0;
+		geometryVertices.push_back (vertex);
+		vertex.position.x = (float) (quad->destRect.x + quad->destRect.w);
+		vertex.tex_coord.x = u1;
+		geometryVertices.push_back (vertex);
+		vertex.position.y = (float) (quad->destRect.y + quad->destRect.h);
+		vertex.tex_coord.y = v1;
+		geometryVertices.push_back (vertex);
+		vertex.position.x = (float) quad->destRect.x;
+		vertex.tex_coord.x = u0;
+		geometryVertices.push_back (vertex);
+
+		geometryIndices.push_back (index);
+		geometryIndices.push_back (index + 1);
+		geometryIndices.push_back (index + 2);
+		geometryIndices.push_back (index);
+		geometryIndices.push_back (index + 2);
+		geometryIndices.push_back (index + 3);
+	}
+	SDL_RenderGeometry (render, command.texture, geometryVertices.data (), (int) geometryVertices.size (), geometryIndices.data (), (int) geometryIndices.size ());
+#else
+	setTextureColorMod (command.texture, command.r, command.g, command.b);
+	setTextureAlphaMod (command.texture, command.a);
+	for (i = 0; i < quadcount; ++i) {
+		quad = &(quads[i]);
+		SDL_RenderCopyEx (render, command.texture, &(quad->sourceRect), &(quad->destRect), 0.0, NULL, (SDL_RendererFlip) quad->flip);
+	}
+#endif
+}
+
+uint64_t DrawList::hashDrawKey (uint64_t key, int64_t value) {
+	int i;
+
+	// Continue an FNV-1a hash with the bytes of value
+	for (i = 0; i < 8; ++i) {
+		key ^= (uint64_t) ((value >> (i * 8)) & 0xFF);
+		key *= 0x100000001B3ULL;
+	}
+	return (key);
+}
+
+void DrawList::fillRect (const SDL_Rect &rect, Uint8 r, Uint8 g, Uint8 b, Uint8 a, SDL_BlendMode blendMode) {
+	DrawList::Command command;
+
+	command.type = DrawList::FillRectCommand;
+	command.rect = rect;
+	command.r = r;
+	command.g = g;
+	command.b = b;
+	command.a = a;
+	command.blendMode = blendMode;
+	addCommand (command);
+}
+
+void DrawList::fillRoundedRect (SDL_Texture *cornerAtlas, const SDL_Rect &rect, int topLeftRadius, int topRightRadius, int bottomLeftRadius, int bottomRightRadius, Uint8 r, Uint8 g, Uint8 b, Uint8 a) {
+	DrawList::Command command;
+
+	if (! cornerAtlas) {
+		fillRect (rect, r, g, b, a, (a < 255) ? SDL_BLENDMODE_BLEND : SDL_BLENDMODE_NONE);
+		return;
+	}
+	command.type = DrawList::FillRoundedRectCommand;
+	command.texture = cornerAtlas;
+	command.rect = rect;
+	command.sourceRect.x = topLeftRadius;
+	command.sourceRect.y = topRightRadius;
+	command.sourceRect.w = bottomLeftRadius;
+	command.sourceRect.h = bottomRightRadius;
+	command.r = r;
+	command.g = g;
+	command.b = b;
+	command.a = a;
+	addCommand (command);
+}
+
+void DrawList::drawLine (int x1, int y1, int x2, int y2, Uint8 r, Uint8 g, Uint8 b, Uint8 a) {
+	DrawList::Command command;
+
+	command.type = DrawList::DrawLineCommand;
+	command.rect.x = x1;
+	command.rect.y = y1;
+	command.rect.w = x2;
+	command.rect.h = y2;
+	command.r = r;
+	command.g = g;
+	command.b = b;
+	command.a = a;
+	addCommand (command);
+}
+
+void DrawList::copyTexture (SDL_Texture *texture, const SDL_Rect *sourceRect, const SDL_Rect &destRect, Uint8 r, Uint8 g, Uint8 b, Uint8 a) {
+	DrawList::Command command;
+
+	if (! texture) {
+		return;
+	}
+	command.type = DrawList::CopyTextureCommand;
+	command.texture = texture;
+	command.rect = destRect;
+	if (sourceRect) {
+		command.flags |= DrawList::SourceRectFlag;
+		command.sourceRect = *sourceRect;
+	}
+	command.r = r;
+	command.g = g;
+	command.b = b;
+	command.a = a;
+	addCommand (command);
+}
+
+void DrawList::copyTexture (SDL_Texture *texture, const SDL_Rect *sourceRect, const SDL_Rect &destRect, SDL_BlendMode blendMode, Uint8 r, Uint8 g, Uint8 b, Uint8 a) {
+	DrawList::Command command;
+
+	if (! texture) {
+		return;
+	}
+	command.type = DrawList::CopyTextureCommand;
+	command.flags = DrawList::BlendModeFlag;
+	command.texture = texture;
+	command.rect = destRect;
+	if (sourceRect) {
+		command.flags |= DrawList::SourceRectFlag;
+		command.sourceRect = *sourceRect;
+	}
+	command.blendMode = blendMode;
+	command.r = r;
+	command.g = g;
+	command.b = b;
+	command.a = a;
+	addCommand (command);
+}
+
+void DrawList::copyGlyph (Font *font, Font::Glyph *glyph, int x, int y, Uint8 r, Uint8 g, Uint8 b) {
+	DrawList::Command command;
+
+	command.type = DrawList::CopyGlyphCommand;
+	command.font = font;
+	command.glyph = glyph;
+	command.rect.x = x;
+	command.rect.y = y;
+	command.rect.w = 0;
+	command.rect.h = 0;
+	command.r = r;
+	command.g = g;
+	command.b = b;
+	addCommand (command);
+}
+
+SDL_Rect DrawList::intersectRect (const SDL_Rect &rect1, const SDL_Rect &rect2) {
+	SDL_Rect rect;
+	int diff;
+
+	rect = rect1;
+	diff = rect.x - rect2.x;
+	if (diff < 0) {
+		rect.w += diff;
+		rect.x = rect2.x;
+	}
+	diff = rect.y - rect2.y;
+	if (diff < 0) {
+		rect.h += diff;
+		rect.y = rect2.y;
+	}
+	diff = (rect.x + rect.w) - (rect2.x + rect2.w);
+	if (diff > 0) {
+		rect.w -= diff;
+	}
+	diff = (rect.y + rect.h) - (rect2.y + rect2.h);
+	if (diff > 0) {
+		rect.h -= diff;
+	}
+
+	if (rect.w < 0) {
+		rect.w = 0;
+	}
+	if (rect.h < 0) {
+		rect.h = 0;
+	}
+	return (rect);
+}
+
+void DrawList::pushClipRect (const SDL_Rect &rect, bool disableIntersection) {
+	DrawList::Command command;
+
+	if ((! clipRectStack.empty ()) && (! disableIntersection)) {
+		clipRect = DrawList::intersectRect (rect, clipRect);
+	}
+	else {
+		clipRect = rect;
+	}
+	clipRectStack.push (clipRect);
+
+	command.type = DrawList::SetClipRectCommand;
+	command.flags = DrawList::ClipRectFlag | DrawList::ClipPushFlag;
+	command.rect = clipRect;
+	addCommand (command);
+}
+
+void DrawList::popClipRect () {
+	DrawList::Command command;
+
+	if (clipRectStack.empty ()) {
+		return;
+	}
+
+	clipRectStack.pop ();
+	command.type = DrawList::SetClipRectCommand;
+	command.flags = DrawList::ClipPopFlag;
+	if (clipRectStack.empty ()) {
+		clipRect.x = 0;
+		clipRect.y = 0;
+		clipRect.w = drawWidth;
+		clipRect.h = drawHeight;
+	}
+	else {
+		clipRect = clipRectStack.top ();
+		command.flags |= DrawList::ClipRectFlag;
+		command.rect = clipRect;
+	}
+	addCommand (command);
+}
@@ -0,0 +1,243 @@
+/*
+* Copyright 2018-2022 Membrane Software <author@membranesoftware.com> https://membranesoftware.com
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+* this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+* this list of conditions and the following disclaimer in the documentation
+* and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors
+* may be used to endorse or promote products derived from this software without
+* specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*/
+// Class that holds a sequence of render commands, recorded by widget draw methods for execution by the application's main thread
+
+#ifndef DRAW_LIST_H
+#define DRAW_LIST_H
+
+#include <stdint.h>
+#include <vector>
+#include <stack>
+#include "SDL2/SDL.h"
+#include "Font.h"
+
+class Widget;
+
+class DrawList {
+public:
+	DrawList ();
+	~DrawList ();
+
+	// Command types
+	enum {
+		FillRectCommand = 0,
+		CopyTextureCommand = 1,
+		CopyGlyphCommand = 2,
+		DrawLineCommand = 3,
+		SetClipRectCommand = 4,
+		FillRoundedRectCommand = 5
+	};
+
+	// Command flags
+	enum {
+		SourceRectFlag = 0x1,
+		BlendModeFlag = 0x2,
+		ClipRectFlag = 0x4,
+		ClipPushFlag = 0x8,
+		ClipPopFlag = 0x10
+	};
+
+	// A render command. Draw line commands store their endpoint coordinates in the x, y, w, and h fields of rect. Fill rounded rect commands store their top left, top right, bottom left, and bottom right corner radius values in the x, y, w, and h fields of sourceRect.
+	struct Command {
+		int type;
+		int flags;
+		SDL_Rect rect;
+		SDL_Rect sourceRect;
+		Uint8 r, g, b, a;
+		SDL_BlendMode blendMode;
+		SDL_Texture *texture;
+		Font *font;
+		Font::Glyph *glyph;
+		Command ():
+			type (0),
+			flags (0),
+			r (255),
+			g (255),
+			b (255),
+			a (255),
+			blendMode (SDL_BLENDMODE_NONE),
+			texture (NULL),
+			font (NULL),
+			glyph (NULL) { }
+	};
+
+	// A range of commands added by one widget's draw method. commandStart and commandEnd are command indexes, and drawnCount and culledCount hold the changes in widget counts made by the draw method.
+	struct WidgetRange {
+		Widget *widget;
+		float originX, originY;
+		int commandStart, commandEnd;
+		int drawnCount, culledCount;
+		WidgetRange ():
+			widget (NULL),
+			originX (0.0f),
+			originY (0.0f),
+			commandStart (0),
+			commandEnd (0),
+			drawnCount (0),
+			culledCount (0) { }
+	};
+
+	// Read-only data members
+	SDL_Renderer *immediateRender;
+	SDL_Texture *targetTexture;
+	SDL_Rect clipRect;
+	int64_t sequence;
+	int drawnWidgetCount;
+	int culledWidgetCount;
+	int cachedWidgetCount; // Widgets whose commands were copied from a retained command cache instead of being drawn
+	int stateChangeCount; // Renderer state changes issued by the last execution
+	int skippedStateChangeCount; // Redundant renderer state changes dropped by the last execution
+
+	// Clear the list and prepare it to receive commands covering a draw area of the specified size. If render is non-NULL, execute each command immediately as it's added instead of storing it, setting targetTexture as the render target if non-NULL.
+	void begin (int drawWidth, int drawHeight, SDL_Renderer *render = NULL, SDL_Texture *texture = NULL);
+
+	// End a sequence of commands started by begin
+	void end ();
+
+	// Return the number of commands stored in the list
+	int getCommandCount () const;
+
+	// Return a boolean value indicating if the list stores its commands, allowing them to be retained for later use
+	bool isRecording () const;
+
+	// Append the list's stored commands from startIndex up to, but not including, endIndex to destList
+	void getCommands (int startIndex, int endIndex, std::vector<DrawList::Command> *destList) const;
+
+	// Add previously retained commands from startIndex up to, but not including, endIndex to the list, applying any clip rectangle changes they hold to the list's clip state
+	void addCommands (const std::vector<DrawList::Command> &commands, int startIndex, int endIndex);
+
+	// Return the number of widget ranges held by the list, for use as the startIndex value in a later call to endWidgetRange
+	int getWidgetRangeCount () const;
+
+	// Record the end of a widget's draw method. Widget ranges added since startIndex belong to the widget's children; move them to childRanges if non-NULL or discard them otherwise, then add range for use by the widget's parent.
+	void endWidgetRange (int startIndex, const DrawList::WidgetRange &range, std::vector<DrawList::WidgetRange> *childRanges);
+
+	// Render the list's stored commands. This method must be invoked only from the application's main thread.
+	void execute (SDL_Renderer *render);
+
+	// Add a command to fill a rectangle with the specified color
+	void fillRect (const SDL_Rect &rect, Uint8 r, Uint8 g, Uint8 b, Uint8 a = 255, SDL_BlendMode blendMode = SDL_BLENDMODE_NONE);
+
+	// Add a command to fill a rectangle with the specified color and rounded corners, drawn as a single geometry batch textured from cornerAtlas. cornerAtlas must hold square cells arranged left to right, with cell zero filled with opaque white and each following cell holding the alpha mask for the top left corner of the radius matching its index.
+	void fillRoundedRect (SDL_Texture *cornerAtlas, const SDL_Rect &rect, int topLeftRadius, int topRightRadius, int bottomLeftRadius, int bottomRightRadius, Uint8 r, Uint8 g, Uint8 b, Uint8 a = 255);
+
+	// Add a command to draw a line with the specified color
+	void drawLine (int x1, int y1, int x2, int y2, Uint8 r, Uint8 g, Uint8 b, Uint8 a = 255);
+
+	// Add a command to copy a texture, or the portion of it within sourceRect if non-NULL, to destRect using the specified color and alpha modulation values
+	void copyTexture (SDL_Texture *texture, const SDL_Rect *sourceRect, const SDL_Rect &destRect, Uint8 r = 255, Uint8 g = 255, Uint8 b = 255, Uint8 a = 255);
+
+	// Add a command to copy a texture using the specified blend mode
+	void copyTexture (SDL_Texture *texture, const SDL_Rect *sourceRect, const SDL_Rect &destRect, SDL_BlendMode blendMode, Uint8 r = 255, Uint8 g = 255, Uint8 b = 255, Uint8 a = 255);
+
+	// Add a command to draw a font glyph with its top left corner at the specified position. The glyph's texture is resolved when the command executes, since glyph rasterization requires the application's main thread.
+	void copyGlyph (Font *font, Font::Glyph *glyph, int x, int y, Uint8 r, Uint8 g, Uint8 b);
+
+	// Set the clip rectangle for subsequent commands, intersecting it with the active clip rectangle unless disableIntersection is true. The previous clip rectangle is restored by a call to popClipRect.
+	void pushClipRect (const SDL_Rect &rect, bool disableIntersection = false);
+
+	// Restore the clip rectangle that was active before the last call to pushClipRect
+	void popClipRect ();
+
+	// Return a draw key value computed by continuing key with the bytes of the provided value. A widget's draw key holds a hash of all values that affect its draw commands.
+	static uint64_t hashDrawKey (uint64_t key, int64_t value);
+	static const uint64_t DrawKeyBasis;
+
+	// Return the intersection of two rectangles, or a rectangle with zero width and height if they don't intersect
+	static SDL_Rect intersectRect (const SDL_Rect &rect1, const SDL_Rect &rect2);
+
+	// The maximum number of commands that a widget should retain for replay
+	static const int MaxRetainedCommandCount;
+
+private:
+	// Store a command, or execute it if the list is in immediate mode
+	void addCommand (const DrawList::Command &command);
+
+	// Renderer state values applied by previously executed commands, used to drop redundant state changes
+	struct RenderState {
+		Uint8 r, g, b, a;
+		SDL_BlendMode blendMode;
+		bool isClipped;
+		SDL_Rect clipRect;
+		SDL_Texture *colorModTexture;
+		Uint8 colorModR, colorModG, colorModB;
+		SDL_Texture *alphaModTexture;
+		Uint8 alphaMod;
+		RenderState ():
+			r (0),
+			g (0),
+			b (0),
+			a (0),
+			blendMode (SDL_BLENDMODE_NONE),
+			isClipped (false),
+			colorModTexture (NULL),
+			colorModR (255),
+			colorModG (255),
+			colorModB (255),
+			alphaModTexture (NULL),
+			alphaMod (255) { }
+	};
+
+	// A textured quad generated by a fill rounded rect command
+	struct GeometryQuad {
+		SDL_Rect destRect;
+		SDL_Rect sourceRect;
+		int flip;
+	};
+	static const int MaxGeometryQuadCount = 11;
+
+	// Reset the renderer's draw color, blend mode, and clip rectangle to their default values and begin tracking render state
+	void resetRenderState (SDL_Renderer *render);
+
+	// Render a command
+	void executeCommand (SDL_Renderer *render, const DrawList::Command &command);
+
+	// Render a fill rounded rect command
+	void executeFillRoundedRect (SDL_Renderer *render, const DrawList::Command &command);
+
+	// Add a quad to quads if its destination rectangle is not empty, and return the resulting quad count
+	static int addGeometryQuad (DrawList::GeometryQuad *quads, int quadCount, int x, int y, int w, int h, int sourceX, int sourceY, int sourceW, int sourceH, int flip);
+
+	// Set renderer state as needed for a command, skipping any values that are already set
+	void setDrawColor (SDL_Renderer *render, Uint8 r, Uint8 g, Uint8 b, Uint8 a);
+	void setBlendMode (SDL_Renderer *render, SDL_BlendMode blendMode);
+	void setTextureColorMod (SDL_Texture *texture, Uint8 r, Uint8 g, Uint8 b);
+	void setTextureAlphaMod (SDL_Texture *texture, Uint8 a);
+
+	std::vector<DrawList::Command> commandList;
+	std::vector<SDL_Vertex> geometryVertices;
+	std::vector<int> geometryIndices;
+	DrawList::RenderState renderState;
+	std::stack<SDL_Rect> clipRectStack;
+	std::vector<DrawList::WidgetRange> widgetRangeList;
+	int drawWidth, drawHeight;
+};
+
+#endif
@@ -0,0 +1,142 @@
+/*
+* Copyright 2018-2022 Membrane Software <author@membranesoftware.com> https://membranesoftware.com
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+* this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+* this list of conditions and the following disclaimer in the documentation
+* and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors
+* may be used to endorse or promote products derived from this software without
+* specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "Config.h"
+#include <stdlib.h>
+#include <stdint.h>
+#include <vector>
+#include <algorithm>
+#include "SDL2/SDL.h"
+#include "DurationSampler.h"
+
+DurationSampler::DurationSampler (int capacity)
+: capacity (capacity)
+, nextIndex (0)
+, sampleCount (0)
+, totalSampleCount (0)
+, mutex (NULL)
+{
+	if (this->capacity < 1) {
+		this->capacity = 1;
+	}
+	samples.resize (this->capacity, 0);
+	mutex = SDL_CreateMutex ();
+}
+
+DurationSampler::~DurationSampler () {
+	if (mutex) {
+		SDL_DestroyMutex (mutex);
+		mutex = NULL;
+	}
+}
+
+void DurationSampler::addSample (int64_t duration) {
+	SDL_LockMutex (mutex);
+	samples[nextIndex] = duration;
+	++nextIndex;
+	if (nextIndex >= capacity) {
+		nextIndex = 0;
+	}
+	if (sampleCount < capacity) {
+		++sampleCount;
+	}
+	++totalSampleCount;
+	SDL_UnlockMutex (mutex);
+}
+
+DurationSampler::Percentiles DurationSampler::getPercentiles () {
+	std::vector<int64_t> sorted;
+
+	// Sort a copy so that the mutex is held only for the duration of the copy
+	SDL_LockMutex (mutex);
+	sorted.assign (samples.begin (), samples.begin () + sampleCount);
+	SDL_UnlockMutex (mutex);
+
+	return (DurationSampler::computePercentiles (&sorted));
+}
+
+DurationSampler::Percentiles DurationSampler::computePercentiles (std::vector<int64_t> *sampleList) {
+	DurationSampler::Percentiles result;
+
+	if (sampleList->empty ()) {
+		return (result);
+	}
+	std::sort (sampleList->begin (), sampleList->end ());
+	result.sampleCount = (int) sampleList->size ();
+	result.p50 = DurationSampler::getNearestRank (*sampleList, 50);
+	result.p95 = DurationSampler::getNearestRank (*sampleList, 95);
+	result.p99 = DurationSampler::getNearestRank (*sampleList, 99);
+	result.max = sampleList->back ();
+	return (result);
+}
+
+int64_t DurationSampler::getNearestRank (const std::vector<int64_t> &sortedList, int percentile) {
+	int64_t rank;
+
+	rank = (((int64_t) sortedList.size ()) * percentile + 99) / 100;
+	if (rank < 1) {
+		rank = 1;
+	}
+	return (sortedList[(size_t) (rank - 1)]);
+}
+
+int64_t DurationSampler::getTotalSampleCount () {
+	int64_t count;
+
+	SDL_LockMutex (mutex);
+	count = totalSampleCount;
+	SDL_UnlockMutex (mutex);
+
+	return (count);
+}
+
+void DurationSampler::getSamples (std::vector<int64_t> *destList) {
+	int i, index;
+
+	destList->clear ();
+	SDL_LockMutex (mutex);
+	destList->reserve (sampleCount);
+	index = (sampleCount < capacity) ? 0 : nextIndex;
+	for (i = 0; i < sampleCount; ++i) {
+		destList->push_back (samples[index]);
+		++index;
+		if (index >= capacity) {
+			index = 0;
+		}
+	}
+	SDL_UnlockMutex (mutex);
+}
+
+void DurationSampler::clear () {
+	SDL_LockMutex (mutex);
+	nextIndex = 0;
+	sampleCount = 0;
+	totalSampleCount = 0;
+	SDL_UnlockMutex (mutex);
+}
@@ -0,0 +1,91 @@
+/*
+* Copyright 2018-2022 Membrane Software <author@membranesoftware.com> https://membranesoftware.com
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+* this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+* this list of conditions and the following disclaimer in the documentation
+* and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors
+* may be used to endorse or promote products derived from this software without
+* specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*/
+// Object that holds a fixed number of the most recent duration samples and computes percentile values from them
+
+#ifndef DURATION_SAMPLER_H
+#define DURATION_SAMPLER_H
+
+#include <stdint.h>
+#include <vector>
+#include "SDL2/SDL.h"
+
+class DurationSampler {
+public:
+	// Construct a sampler that holds up to capacity samples, replacing the oldest sample once full
+	DurationSampler (int capacity = DurationSampler::DefaultCapacity);
+	~DurationSampler ();
+
+	static const int DefaultCapacity = 1024;
+
+	struct Percentiles {
+		int sampleCount; // The number of samples used to compute percentile values
+		int64_t p50;
+		int64_t p95;
+		int64_t p99;
+		int64_t max;
+		Percentiles ():
+			sampleCount (0),
+			p50 (0),
+			p95 (0),
+			p99 (0),
+			max (0) { }
+	};
+
+	// Add a duration value to the sampler. This method may be invoked from any thread.
+	void addSample (int64_t duration);
+
+	// Return percentile values computed from the samples currently held, or zero values if no samples are held
+	DurationSampler::Percentiles getPercentiles ();
+
+	// Return the total number of samples added since the sampler was constructed or last cleared, including samples that have since been replaced
+	int64_t getTotalSampleCount ();
+
+	// Copy the samples currently held into destList, ordered from oldest to newest
+	void getSamples (std::vector<int64_t> *destList);
+
+	// Remove all samples
+	void clear ();
+
+	// Sort sampleList and return percentile values computed from its contents
+	static DurationSampler::Percentiles computePercentiles (std::vector<int64_t> *sampleList);
+
+private:
+	// Return the sample at the specified percentile of sortedList, using the nearest-rank method
+	static int64_t getNearestRank (const std::vector<int64_t> &sortedList, int percentile);
+
+	std::vector<int64_t> samples;
+	int capacity;
+	int nextIndex;
+	int sampleCount;
+	int64_t totalSampleCount;
+	SDL_mutex *mutex;
+};
+
+#endif
@@ -36,6 +36,7 @@
 #include "SDL2/SDL.h"
 #include "ft2build.h"
 #include FT_FREETYPE_H
+#include FT_SIZES_H
 #include "OsUtil.h"
 #include "Log.h"
 #include "StdString.h"
@@ -45,62 +46,76 @@
 
 const char *Font::GlyphCharacters = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789-_=+[]{}\\\"';:,.<>/?!@#$%^&*()|";
 const StdString Font::DotTruncateSuffix = StdString ("...");
+const int Font::MinAtlasPageSize = 256;
 
-Font::Font (FT_Library freetype, const StdString &name)
+Font::Font (FT_Face face, SDL_mutex *faceMutex, const StdString &name)
 : name (name)
 , spaceWidth (0)
 , maxGlyphWidth (0)
 , maxLineHeight (0)
-, freetype (freetype)
+, face (face)
+, faceMutex (faceMutex)
+, size (NULL)
 , isLoaded (false)
+, hasKerning (false)
+, atlasPageSize (Font::MinAtlasPageSize)
 {
 
 }
 
 Font::~Font () {
 	clearGlyphMap ();
-	if (isLoaded) {
-		FT_Done_Face (face);
-		isLoaded = false;
+	if (size) {
+		SDL_LockMutex (faceMutex);
+		FT_Done_Size (size);
+		SDL_UnlockMutex (faceMutex);
+		size = NULL;
 	}
+	isLoaded = false;
 }
 
 void Font::clearGlyphMap () {
-	std::map<char, Font::Glyph>::iterator i, end;
+	std::vector<Font::AtlasPage>::iterator i, end;
 
-	i = glyphMap.begin ();
-	end = glyphMap.end ();
+	glyphMap.clear ();
+	i = atlasPages.begin ();
+	end = atlasPages.end ();
 	while (i != end) {
-		if (i->second.texture) {
-			Resource::instance->unloadTexture (i->second.texturePath);
-			i->second.texture = NULL;
+		if (i->texture) {
+			Resource::instance->unloadTexture (i->textureId);
+			i->texture = NULL;
 		}
 		++i;
 	}
-	glyphMap.clear ();
+	atlasPages.clear ();
 }
 
-OsUtil::Result Font::load (Buffer *fontData, int pointSize) {
+OsUtil::Result Font::load (int pointSize) {
 	Font::Glyph glyph;
-	FT_GlyphSlot slot;
-	SDL_Surface *surface;
+	FT_Glyph_Metrics *metrics;
+	FT_Pos left, right, top, bottom;
 	char *s, c;
-	int result, charindex, x, y, w, h, pitch, maxw, maxtopbearing;
-	uint8_t *row, *bitmap, alpha;
-	Uint32 *pixels, *dest, color, rmask, gmask, bmask, amask;
+	int result, charindex, h, maxw, maxtopbearing;
+	bool fixedwidth;
 	std::map<char, Font::Glyph>::iterator i, end;
 
-	result = FT_New_Memory_Face (freetype, (FT_Byte *) fontData->data, fontData->length, 0, &face);
+	SDL_LockMutex (faceMutex);
+	result = FT_New_Size (face, &size);
 	if (result != 0) {
-		Log::err ("Failed to load font; name=\"%s\" err=\"FT_New_Memory_Face: %i\"", name.c_str (), result);
+		SDL_UnlockMutex (faceMutex);
+		size = NULL;
+		Log::err ("Failed to load font; name=\"%s\" err=\"FT_New_Size: %i\"", name.c_str (), result);
 		return (OsUtil::FreetypeOperationFailedError);
 	}
+	FT_Activate_Size (size);
 	result = FT_Set_Char_Size (face, pointSize << 6, 0, 100, 0);
 	if (result != 0) {
+		SDL_UnlockMutex (faceMutex);
 		Log::err ("Failed to load font; name=\"%s\" err=\"FT_Set_Char_Size: %i\"", name.c_str (), result);
 		return (OsUtil::FreetypeOperationFailedError);
 	}
 
+	// Glyph images are rendered on first use; compute the bitmap dimensions that rendering will produce from the grid-fitted glyph metrics
 	maxw = 0;
 	maxtopbearing = 0;
 	s = (char *) Font::GlyphCharacters;
@@ -112,84 +127,47 @@ OsUtil::Result Font::load (Buffer *fontData, int pointSize) {
 		++s;
 
 		charindex = FT_Get_Char_Index (face, c);
-		result = FT_Load_Glyph (face, charindex, FT_LOAD_RENDER);
+		result = FT_Load_Glyph (face, charindex, FT_LOAD_DEFAULT);
 		if (result != 0) {
 			Log::warning ("Failed to load font character; name=\"%s\" index=\"%c\" err=\"FT_Load_Glyph: %i\"", name.c_str (), c, result);
 			continue;
 		}
-		slot = face->glyph;
-		w = slot->bitmap.width;
-		h = slot->bitmap.rows;
-		if ((w <= 0) || (h <= 0)) {
-			Log::warning ("Failed to load font character; name=\"%s\" index=\"%c\" err=\"Invalid bitmap dimensions %ix%i\"", name.c_str (), c, w, h);
+		metrics = &(face->glyph->metrics);
+		left = metrics->horiBearingX & -64;
+		right = (metrics->horiBearingX + metrics->width + 63) & -64;
+		top = (metrics->horiBearingY + 63) & -64;
+		bottom = (metrics->horiBearingY - metrics->height) & -64;
+		glyph.character = c;
+		glyph.width = (int) ((right - left) >> 6);
+		glyph.height = (int) ((top - bottom) >> 6);
+		if ((glyph.width <= 0) || (glyph.height <= 0)) {
+			Log::warning ("Failed to load font character; name=\"%s\" index=\"%c\" err=\"Invalid bitmap dimensions %ix%i\"", name.c_str (), c, glyph.width, glyph.height);
 			continue;
 		}
-		pixels = (Uint32 *) malloc (w * h * sizeof (Uint32));
-		if (! pixels) {
-			Log::warning ("Failed to load font character; name=\"%s\" index=\"%c\" err=\"Out of memory, bitmap dimensions %ix%i\"", name.c_str (), c, w, h);
-			continue;
-		}
-		dest = pixels;
-		row = (uint8_t *) slot->bitmap.buffer;
-		pitch = slot->bitmap.pitch;
-		y = 0;
-		while (y < h) {
-			bitmap = row;
-			x = 0;
-			while (x < w) {
-				alpha = *bitmap;
-				++bitmap;
-#if SDL_BYTEORDER == SDL_BIG_ENDIAN
-				color = 0xFFFFFF00 | (alpha & 0xFF);
-#else
-				color = 0x00FFFFFF | (((Uint32) (alpha & 0xFF)) << 24);
-#endif
-				*dest = color;
-				++dest;
-				++x;
-			}
-			row += pitch;
-			++y;
-		}
-#if SDL_BYTEORDER == SDL_BIG_ENDIAN
-		rmask = 0xFF000000;
-		gmask = 0x00FF0000;
-		bmask = 0x0000FF00;
-		amask = 0x000000FF;
-#else
-		rmask = 0x000000FF;
-		gmask = 0x0000FF00;
-		bmask = 0x00FF0000;
-		amask = 0xFF000000;
-#endif
-		surface = SDL_CreateRGBSurfaceFrom (pixels, w, h, 32, w * sizeof (Uint32), rmask, gmask, bmask, amask);
-		if (! surface) {
-			Log::warning ("Failed to load font character; name=\"%s\" index=\"%c\" err=\"SDL_CreateRGBSurfaceFrom, %s\"", name.c_str (), c, SDL_GetError ());
-			free (pixels);
-			continue;
-		}
-		glyph.texturePath.sprintf ("*_Font_%s_%i_%i", name.c_str (), pointSize, (int) c);
-		glyph.texture = Resource::instance->createTexture (glyph.texturePath, surface);
-		SDL_FreeSurface (surface);
-		free (pixels);
-		if (! glyph.texture) {
-			Log::warning ("Failed to load font character; name=\"%s\" index=\"%c\" err=\"SDL_CreateTextureFromSurface, %s\"", name.c_str (), c, SDL_GetError ());
-			continue;
-		}
-		glyph.width = w;
-		glyph.height = h;
-		glyph.leftBearing = (int) slot->bitmap_left;
-		glyph.topBearing = (int) slot->bitmap_top;
-		glyph.advanceWidth = (int) ((FT_CeilFix (slot->linearHoriAdvance) >> 16) & 0xFFFF);
+		glyph.leftBearing = (int) (left >> 6);
+		glyph.topBearing = (int) (top >> 6);
+		glyph.advanceWidth = (int) ((FT_CeilFix (face->glyph->linearHoriAdvance) >> 16) & 0xFFFF);
+		glyph.isRasterized = false;
+		glyph.texture = NULL;
+		glyph.textureRect.x = 0;
+		glyph.textureRect.y = 0;
+		glyph.textureRect.w = 0;
+		glyph.textureRect.h = 0;
+		glyph.textureOffsetX = 0;
+		glyph.textureOffsetY = 0;
 		glyphMap.insert (std::pair<char, Font::Glyph> (c, glyph));
-		if (w > maxw) {
-			maxw = w;
+		if (glyph.width > maxw) {
+			maxw = glyph.width;
 		}
 		if ((maxtopbearing <= 0) || (glyph.topBearing > maxtopbearing)) {
 			maxtopbearing = glyph.topBearing;
 		}
 	}
-	if (face->face_flags & FT_FACE_FLAG_FIXED_WIDTH) {
+	fixedwidth = (face->face_flags & FT_FACE_FLAG_FIXED_WIDTH) ? true : false;
+	hasKerning = FT_HAS_KERNING (face) ? true : false;
+	SDL_UnlockMutex (faceMutex);
+
+	if (fixedwidth) {
 		spaceWidth = maxw;
 	}
 	else {
@@ -213,6 +191,11 @@ OsUtil::Result Font::load (Buffer *fontData, int pointSize) {
 		++i;
 	}
 
+	atlasPageSize = Font::MinAtlasPageSize;
+	while ((atlasPageSize < ((maxGlyphWidth + 1) * 8)) || (atlasPageSize < ((maxLineHeight + 1) * 4))) {
+		atlasPageSize *= 2;
+	}
+
 	isLoaded = true;
 	return (OsUtil::Success);
 }
@@ -227,13 +210,148 @@ Font::Glyph *Font::getGlyph (char glyphCharacter) {
 	return (&(i->second));
 }
 
+SDL_Texture *Font::getGlyphTexture (Font::Glyph *glyph) {
+	if (! glyph->isRasterized) {
+		if (! rasterizeGlyph (glyph)) {
+			return (NULL);
+		}
+	}
+	return (glyph->texture);
+}
+
+bool Font::rasterizeGlyph (Font::Glyph *glyph) {
+	FT_GlyphSlot slot;
+	Font::AtlasPage *page;
+	SDL_Rect rect;
+	int result, charindex, x, y, w, h, pitch, left, top;
+	uint8_t *row, *bitmap;
+	Uint32 *pixels, *dest;
+
+	if (! isLoaded) {
+		return (false);
+	}
+
+	// Mark the glyph as rasterized before attempting the operation, preventing repeated attempts if it fails
+	glyph->isRasterized = true;
+	pixels = NULL;
+	SDL_LockMutex (faceMutex);
+	FT_Activate_Size (size);
+	charindex = FT_Get_Char_Index (face, glyph->character);
+	result = FT_Load_Glyph (face, charindex, FT_LOAD_RENDER);
+	if (result != 0) {
+		SDL_UnlockMutex (faceMutex);
+		Log::warning ("Failed to render font character; name=\"%s\" index=\"%c\" err=\"FT_Load_Glyph: %i\"", name.c_str (), glyph->character, result);
+		return (false);
+	}
+	slot = face->glyph;
+	w = slot->bitmap.width;
+	h = slot->bitmap.rows;
+	left = (int) slot->bitmap_left;
+	top = (int) slot->bitmap_top;
+	if ((w > 0) && (h > 0)) {
+		pixels = (Uint32 *) malloc (w * h * sizeof (Uint32));
+	}
+	if (pixels) {
+		// Store glyph coverage as alpha values in SDL_PIXELFORMAT_RGBA8888 pixels
+		dest = pixels;
+		row = (uint8_t *) slot->bitmap.buffer;
+		pitch = slot->bitmap.pitch;
+		y = 0;
+		while (y < h) {
+			bitmap = row;
+			x = 0;
+			while (x < w) {
+				*dest = 0xFFFFFF00 | ((Uint32) (*bitmap & 0xFF));
+				++bitmap;
+				++dest;
+				++x;
+			}
+			row += pitch;
+			++y;
+		}
+	}
+	SDL_UnlockMutex (faceMutex);
+	if (! pixels) {
+		Log::warning ("Failed to render font character; name=\"%s\" index=\"%c\" err=\"Invalid bitmap dimensions %ix%i\"", name.c_str (), glyph->character, w, h);
+		return (false);
+	}
+
+	page = allocateAtlasRect (w, h, &x, &y);
+	if (! page) {
+		free (pixels);
+		return (false);
+	}
+	rect.x = x;
+	rect.y = y;
+	rect.w = w;
+	rect.h = h;
+	result = SDL_UpdateTexture (page->texture, &rect, pixels, w * sizeof (Uint32));
+	free (pixels);
+	if (result != 0) {
+		Log::warning ("Failed to render font character; name=\"%s\" index=\"%c\" err=\"SDL_UpdateTexture, %s\"", name.c_str (), glyph->character, SDL_GetError ());
+		return (false);
+	}
+
+	glyph->texture = page->texture;
+	glyph->textureRect = rect;
+	glyph->textureOffsetX = left - glyph->leftBearing;
+	glyph->textureOffsetY = glyph->topBearing - top;
+	return (true);
+}
+
+Font::AtlasPage *Font::allocateAtlasRect (int imageWidth, int imageHeight, int *x, int *y) {
+	Font::AtlasPage *page, item;
+
+	if ((imageWidth > atlasPageSize) || (imageHeight > atlasPageSize)) {
+		return (NULL);
+	}
+	page = NULL;
+	if (! atlasPages.empty ()) {
+		page = &(atlasPages.back ());
+		if ((page->shelfX + imageWidth) > atlasPageSize) {
+			// Start a new shelf below the current one, leaving a one pixel gap between images
+			page->shelfY += page->shelfHeight + 1;
+			page->shelfX = 0;
+			page->shelfHeight = 0;
+		}
+		if ((page->shelfY + imageHeight) > atlasPageSize) {
+			page = NULL;
+		}
+	}
+	if (! page) {
+		item.textureId = Resource::instance->createResourceId ();
+		item.texture = Resource::instance->createTexture (item.textureId, atlasPageSize, atlasPageSize, SDL_TEXTUREACCESS_STATIC);
+		if (! item.texture) {
+			Log::warning ("Failed to create font atlas page; name=\"%s\" size=%i", name.c_str (), atlasPageSize);
+			return (NULL);
+		}
+		SDL_SetTextureBlendMode (item.texture, SDL_BLENDMODE_BLEND);
+		atlasPages.push_back (item);
+		page = &(atlasPages.back ());
+	}
+
+	*x = page->shelfX;
+	*y = page->shelfY;
+	page->shelfX += imageWidth + 1;
+	if (imageHeight > page->shelfHeight) {
+		page->shelfHeight = imageHeight;
+	}
+	return (page);
+}
+
 int Font::getKerning (char leftCharacter, char rightCharacter) {
 	int leftindex, rightindex;
 	FT_Vector vector;
 
+	if (! hasKerning) {
+		return (0);
+	}
+	SDL_LockMutex (faceMutex);
+	FT_Activate_Size (size);
 	leftindex = FT_Get_Char_Index (face, leftCharacter);
 	rightindex = FT_Get_Char_Index (face, rightCharacter);
 	FT_Get_Kerning (face, leftindex, rightindex, FT_KERNING_DEFAULT, &vector);
+	SDL_UnlockMutex (faceMutex);
 	return (vector.x >> 6);
 }
 
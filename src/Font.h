@@ -34,9 +34,11 @@
 
 #include <stdint.h>
 #include <map>
+#include <vector>
 #include "SDL2/SDL.h"
 #include "ft2build.h"
 #include FT_FREETYPE_H
+#include FT_SIZES_H
 #include "StdString.h"
 #include "OsUtil.h"
 #include "Buffer.h"
@@ -44,20 +46,27 @@
 class Font {
 public:
 	struct _glyph {
-		SDL_Texture *texture;
-		StdString texturePath;
+		char character;
 		int width, height;
 		int leftBearing;
 		int topBearing;
 		int advanceWidth;
+
+		// Fields that locate the glyph's image in an atlas page, assigned when the glyph is first rasterized
+		bool isRasterized;
+		SDL_Texture *texture;
+		SDL_Rect textureRect;
+		int textureOffsetX, textureOffsetY;
 	};
 	typedef struct _glyph Glyph;
 
-	Font (FT_Library freetype, const StdString &name);
+	// Construct a font that renders glyphs from face, which may be shared with other Font objects. Operations on face are executed while holding a lock on faceMutex.
+	Font (FT_Face face, SDL_mutex *faceMutex, const StdString &name);
 	~Font ();
 
 	static const char *GlyphCharacters;
 	static const StdString DotTruncateSuffix;
+	static const int MinAtlasPageSize;
 
 	// Read-only data members
 	StdString name;
@@ -65,12 +74,15 @@ public:
 	int maxGlyphWidth;
 	int maxLineHeight;
 
-	// Load a font using the specified data buffer and point size. Returns a Result value.
-	OsUtil::Result load (Buffer *fontData, int pointSize);
+	// Load glyph metrics for the specified point size. Glyph images are rasterized later, as needed by the getGlyphTexture method. Returns a Result value.
+	OsUtil::Result load (int pointSize);
 
 	// Return a pointer to a Font::Glyph struct for the specified character, or NULL if no such glyph was found
 	Font::Glyph *getGlyph (char glyphCharacter);
 
+	// Return the atlas texture that holds the image for glyph, rasterizing it if this has not already been done, or NULL if the glyph image is not available. The glyph's image occupies its textureRect area of the texture. This method must be invoked only from the application's main thread.
+	SDL_Texture *getGlyphTexture (Font::Glyph *glyph);
+
 	// Return the kerning value that should be used between the two specified characters
 	int getKerning (char leftCharacter, char rightCharacter);
 
@@ -101,13 +113,35 @@ public:
 	StdString truncatedText (const StdString &text, float maxWidth, const StdString &truncateSuffix = StdString (""));
 
 private:
-	// Remove all items from the glyph map
+	struct AtlasPage {
+		SDL_Texture *texture;
+		uint64_t textureId;
+		int shelfX, shelfY, shelfHeight;
+		AtlasPage ():
+			texture (NULL),
+			textureId (0),
+			shelfX (0),
+			shelfY (0),
+			shelfHeight (0) { }
+	};
+
+	// Remove all items from the glyph map and free all atlas pages
 	void clearGlyphMap ();
 
-	FT_Library freetype;
+	// Render the image for glyph and store it in an atlas page. Returns a boolean value indicating if the operation succeeded.
+	bool rasterizeGlyph (Font::Glyph *glyph);
+
+	// Find space for an image of the specified size in an atlas page, creating a new page if needed. Returns a pointer to the page, with the image position stored in x and y, or NULL if no space could be allocated.
+	Font::AtlasPage *allocateAtlasRect (int imageWidth, int imageHeight, int *x, int *y);
+
 	FT_Face face;
+	SDL_mutex *faceMutex;
+	FT_Size size;
 	bool isLoaded;
+	bool hasKerning;
 	std::map<char, Font::Glyph> glyphMap;
+	std::vector<Font::AtlasPage> atlasPages;
+	int atlasPageSize;
 };
 
 #endif
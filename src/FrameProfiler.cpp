@@ -0,0 +1,235 @@
+/*
+* Copyright 2018-2022 Membrane Software <author@membranesoftware.com> https://membranesoftware.com
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+* this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+* this list of conditions and the following disclaimer in the documentation
+* and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors
+* may be used to endorse or promote products derived from this software without
+* specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "Config.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <vector>
+#include "SDL2/SDL.h"
+#include "StdString.h"
+#include "OsUtil.h"
+#include "DurationSampler.h"
+#include "Trace.h"
+#include "FrameProfiler.h"
+
+FrameProfiler::FrameProfiler (const char *name, int phaseCount, const char **phaseNames, int frameCapacity)
+: phaseCount (phaseCount)
+, frameCount (0)
+, name (name)
+, phaseNames (phaseNames)
+, frameCapacity (frameCapacity)
+, columnCount (0)
+, frameStartTime (0)
+, nextFrameIndex (0)
+, storedFrameCount (0)
+, frameRingMutex (NULL)
+{
+	if (this->frameCapacity < 1) {
+		this->frameCapacity = 1;
+	}
+	columnCount = this->phaseCount + 2;
+	currentFrame.resize (this->phaseCount, 0);
+	phaseStartTimes.resize (this->phaseCount, 0);
+	frameRing.resize (this->frameCapacity * columnCount, 0);
+	frameRingMutex = SDL_CreateMutex ();
+}
+
+FrameProfiler::~FrameProfiler () {
+	if (frameRingMutex) {
+		SDL_DestroyMutex (frameRingMutex);
+		frameRingMutex = NULL;
+	}
+}
+
+int FrameProfiler::getColumn (int phase) {
+	if ((phase < 0) || (phase >= phaseCount)) {
+		return (columnCount - 1);
+	}
+	return (phase + 1);
+}
+
+void FrameProfiler::beginFrame () {
+	int i;
+
+	for (i = 0; i < phaseCount; ++i) {
+		currentFrame[i] = 0;
+	}
+	frameStartTime = OsUtil::getMonotonicTime ();
+}
+
+void FrameProfiler::beginPhase (int phase) {
+	if ((phase < 0) || (phase >= phaseCount)) {
+		return;
+	}
+	phaseStartTimes[phase] = OsUtil::getMonotonicTime ();
+}
+
+void FrameProfiler::endPhase (int phase) {
+	int64_t now;
+
+	if ((phase < 0) || (phase >= phaseCount)) {
+		return;
+	}
+	now = OsUtil::getMonotonicTime ();
+	currentFrame[phase] += now - phaseStartTimes[phase];
+	if (Trace::instance && Trace::instance->isEnabled) {
+		Trace::instance->addEvent (phaseNames[phase], name, phaseStartTimes[phase], now);
+	}
+}
+
+void FrameProfiler::endFrame () {
+	int64_t *row;
+	int64_t now, total;
+	int i;
+
+	now = OsUtil::getMonotonicTime ();
+	total = now - frameStartTime;
+	if (Trace::instance && Trace::instance->isEnabled) {
+		Trace::instance->addEvent (name, name, frameStartTime, now);
+	}
+	SDL_LockMutex (frameRingMutex);
+	row = &(frameRing[nextFrameIndex * columnCount]);
+	row[0] = frameCount;
+	for (i = 0; i < phaseCount; ++i) {
+		row[i + 1] = currentFrame[i];
+	}
+	row[columnCount - 1] = total;
+	++nextFrameIndex;
+	if (nextFrameIndex >= frameCapacity) {
+		nextFrameIndex = 0;
+	}
+	if (storedFrameCount < frameCapacity) {
+		++storedFrameCount;
+	}
+	++frameCount;
+	SDL_UnlockMutex (frameRingMutex);
+}
+
+DurationSampler::Percentiles FrameProfiler::getPercentiles (int phase) {
+	std::vector<int64_t> samples;
+	int column, i;
+
+	column = getColumn (phase);
+	SDL_LockMutex (frameRingMutex);
+	samples.reserve (storedFrameCount);
+	for (i = 0; i < storedFrameCount; ++i) {
+		samples.push_back (frameRing[(i * columnCount) + column]);
+	}
+	SDL_UnlockMutex (frameRingMutex);
+
+	return (DurationSampler::computePercentiles (&samples));
+}
+
+void FrameProfiler::getHistogram (int phase, int64_t bucketDuration, std::vector<int> *bucketCounts) {
+	std::vector<int>::iterator i, end;
+	int64_t bucket, lastbucket;
+	int column, j;
+
+	i = bucketCounts->begin ();
+	end = bucketCounts->end ();
+	while (i != end) {
+		*i = 0;
+		++i;
+	}
+	if (bucketCounts->empty () || (bucketDuration <= 0)) {
+		return;
+	}
+
+	column = getColumn (phase);
+	lastbucket = (int64_t) (bucketCounts->size () - 1);
+	SDL_LockMutex (frameRingMutex);
+	for (j = 0; j < storedFrameCount; ++j) {
+		bucket = frameRing[(j * columnCount) + column] / bucketDuration;
+		if (bucket > lastbucket) {
+			bucket = lastbucket;
+		}
+		if (bucket < 0) {
+			bucket = 0;
+		}
+		++((*bucketCounts)[(size_t) bucket]);
+	}
+	SDL_UnlockMutex (frameRingMutex);
+}
+
+StdString FrameProfiler::toString () {
+	DurationSampler::Percentiles percentiles;
+	StdString s;
+	int i;
+
+	percentiles = getPercentiles (-1);
+	s.sprintf ("frameCount=%i total=%.3f/%.3f/%.3fms", percentiles.sampleCount, ((double) percentiles.p50) / 1000000.0f, ((double) percentiles.p95) / 1000000.0f, ((double) percentiles.p99) / 1000000.0f);
+	for (i = 0; i < phaseCount; ++i) {
+		percentiles = getPercentiles (i);
+		s.appendSprintf (" %s=%.3f/%.3f/%.3fms", phaseNames[i], ((double) percentiles.p50) / 1000000.0f, ((double) percentiles.p95) / 1000000.0f, ((double) percentiles.p99) / 1000000.0f);
+	}
+	return (s);
+}
+
+OsUtil::Result FrameProfiler::writeFile (const StdString &filename) {
+	std::vector<int64_t> rows;
+	StdString out;
+	int index, i, j;
+	FILE *fp;
+
+	SDL_LockMutex (frameRingMutex);
+	rows.reserve (storedFrameCount * columnCount);
+	index = (storedFrameCount < frameCapacity) ? 0 : nextFrameIndex;
+	for (i = 0; i < storedFrameCount; ++i) {
+		rows.insert (rows.end (), frameRing.begin () + (index * columnCount), frameRing.begin () + ((index + 1) * columnCount));
+		++index;
+		if (index >= frameCapacity) {
+			index = 0;
+		}
+	}
+	SDL_UnlockMutex (frameRingMutex);
+
+	out.assign ("frame");
+	for (i = 0; i < phaseCount; ++i) {
+		out.appendSprintf (",%s", phaseNames[i]);
+	}
+	out.append (",total\n");
+	i = 0;
+	while (i < (int) rows.size ()) {
+		out.appendSprintf ("%lli", (long long) rows[i]);
+		for (j = 1; j < columnCount; ++j) {
+			out.appendSprintf (",%.3f", ((double) rows[i + j]) / 1000.0f);
+		}
+		out.append ("\n");
+		i += columnCount;
+	}
+
+	fp = fopen (filename.c_str (), "wb");
+	if (! fp) {
+		return (OsUtil::FileOpenFailedError);
+	}
+	fprintf (fp, "%s", out.c_str ());
+	fclose (fp);
+	return (OsUtil::Success);
+}
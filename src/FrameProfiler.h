@@ -0,0 +1,99 @@
+/*
+* Copyright 2018-2022 Membrane Software <author@membranesoftware.com> https://membranesoftware.com
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+* this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+* this list of conditions and the following disclaimer in the documentation
+* and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors
+* may be used to endorse or promote products derived from this software without
+* specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*/
+// Object that records the duration of named phases in each pass of a processing loop, holding a fixed number of the most recent passes
+
+#ifndef FRAME_PROFILER_H
+#define FRAME_PROFILER_H
+
+#include <stdint.h>
+#include <vector>
+#include "SDL2/SDL.h"
+#include "StdString.h"
+#include "OsUtil.h"
+#include "DurationSampler.h"
+
+class FrameProfiler {
+public:
+	// Construct a profiler that records phaseCount phases per frame, using name to identify frames in trace events, and holds up to frameCapacity frames, replacing the oldest frame once full. name and phaseNames must remain valid for the lifetime of the profiler, and phaseNames must hold phaseCount items.
+	FrameProfiler (const char *name, int phaseCount, const char **phaseNames, int frameCapacity = FrameProfiler::DefaultFrameCapacity);
+	~FrameProfiler ();
+
+	static const int DefaultFrameCapacity = 1024;
+
+	// Read-only data members
+	int phaseCount;
+	int64_t frameCount; // The number of frames recorded since the profiler was constructed
+
+	// Start timing a frame. Frame and phase methods must be invoked only from the thread that executes the profiled loop.
+	void beginFrame ();
+
+	// Start timing the specified phase within the current frame
+	void beginPhase (int phase);
+
+	// Stop timing the specified phase, adding the elapsed time to the phase's duration for the current frame. If trace recording is enabled, the phase is also recorded as a trace event.
+	void endPhase (int phase);
+
+	// Stop timing the current frame and store its phase durations in the frame ring. If trace recording is enabled, the frame is also recorded as a trace event.
+	void endFrame ();
+
+	// Return percentile values computed from the durations of the specified phase in stored frames, or from total frame durations if phase is negative. This method may be invoked from any thread.
+	DurationSampler::Percentiles getPercentiles (int phase);
+
+	// Count stored frames by the duration of the specified phase, or by total frame duration if phase is negative. The count for durations in the range [i * bucketDuration, (i + 1) * bucketDuration) is stored at index i of bucketCounts, except that the last index also counts all longer durations. bucketCounts is not resized, allowing callers to reuse its storage.
+	void getHistogram (int phase, int64_t bucketDuration, std::vector<int> *bucketCounts);
+
+	// Return a string containing percentile values for each phase, suitable for use in a log message
+	StdString toString ();
+
+	// Write stored frames to the specified file as comma-separated values, with one line per frame and one column per phase. Duration values are written in microseconds. Returns a Result value.
+	OsUtil::Result writeFile (const StdString &filename);
+
+private:
+	// Return the index of the frame ring column that holds durations for the specified phase
+	int getColumn (int phase);
+
+	const char *name;
+	const char **phaseNames;
+	int frameCapacity;
+	int columnCount;
+
+	// Durations for the frame in progress, accessed only by the profiled thread
+	std::vector<int64_t> currentFrame;
+	std::vector<int64_t> phaseStartTimes;
+	int64_t frameStartTime;
+
+	// Ring of stored frames, each holding a frame number, a duration for each phase, and the total frame duration
+	std::vector<int64_t> frameRing;
+	int nextFrameIndex;
+	int storedFrameCount;
+	SDL_mutex *frameRingMutex;
+};
+
+#endif
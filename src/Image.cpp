@@ -37,6 +37,7 @@
 #include "StdString.h"
 #include "Sprite.h"
 #include "SpriteHandle.h"
+#include "DrawList.h"
 #include "Widget.h"
 #include "Image.h"
 
@@ -47,6 +48,8 @@ Image::Image (Sprite *sprite, int spriteFrame, bool shouldDestroySprite)
 , maxSpriteHeight (0.0f)
 , drawScale (1.0f)
 , isDrawColorEnabled (false)
+, translateAlphaValue (1.0f, 0.0f)
+, isTranslatingAlpha (false)
 , spriteHandle (sprite)
 , shouldDestroySprite (shouldDestroySprite)
 , isMouseHighlightScaled (false)
@@ -124,6 +127,7 @@ void Image::translateAlpha (float startAlpha, float targetAlpha, int durationMs)
 
 	drawAlpha = startAlpha;
 	translateAlphaValue.translateX (startAlpha, targetAlpha, durationMs);
+	isTranslatingAlpha = true;
 }
 
 void Image::resetSize () {
@@ -132,12 +136,10 @@ void Image::resetSize () {
 
 	texture = spriteHandle.getTexture (&tw, &th);
 	if (! texture) {
-		width = 0.0f;
-		height = 0.0f;
+		assignSize (0.0f, 0.0f);
 		return;
 	}
-	width = ((float) tw) * drawScale;
-	height = ((float) th) * drawScale;
+	assignSize (((float) tw) * drawScale, ((float) th) * drawScale);
 }
 
 void Image::doUpdate (int msElapsed) {
@@ -154,13 +156,10 @@ void Image::doUpdate (int msElapsed) {
 		}
 	}
 
-	if (translateAlphaValue.isTranslating) {
-		translateAlphaValue.update (msElapsed);
+	// Animator advances translateAlphaValue before widget updates, so the update that completes a translation finds isTranslating already cleared and copies the final value here
+	if (translateAlphaValue.isTranslating || isTranslatingAlpha) {
 		drawAlpha = translateAlphaValue.x;
-	}
-
-	if (isDrawColorEnabled) {
-		drawColor.update (msElapsed);
+		isTranslatingAlpha = translateAlphaValue.isTranslating;
 	}
 }
 
@@ -170,7 +169,25 @@ void Image::doRefresh () {
 	resetSize ();
 }
 
-void Image::doDraw (SDL_Texture *targetTexture, float originX, float originY) {
+uint64_t Image::getDrawKey (DrawList *drawList, const SDL_Rect &clipRect, float originX, float originY) {
+	uint64_t key;
+
+	key = DrawList::DrawKeyBasis;
+	key = DrawList::hashDrawKey (key, (int64_t) (intptr_t) spriteHandle.getTexture ());
+	key = DrawList::hashDrawKey (key, (int) (originX + position.x));
+	key = DrawList::hashDrawKey (key, (int) (originY + position.y));
+	key = DrawList::hashDrawKey (key, (int) width);
+	key = DrawList::hashDrawKey (key, (int) height);
+	key = DrawList::hashDrawKey (key, isDrawColorEnabled);
+	if (isDrawColorEnabled) {
+		key = DrawList::hashDrawKey (key, (drawColor.rByte << 16) | (drawColor.gByte << 8) | drawColor.bByte);
+	}
+	key = DrawList::hashDrawKey (key, (Uint8) (drawAlpha * 255.0f));
+
+	return (key);
+}
+
+void Image::doDraw (DrawList *drawList, float originX, float originY) {
 	SDL_Texture *texture;
 	SDL_Rect rect;
 
@@ -180,12 +197,10 @@ void Image::doDraw (SDL_Texture *targetTexture, float originX, float originY) {
 	rect.w = (int) width;
 	rect.h = (int) height;
 
-	SDL_SetTextureAlphaMod (texture, (Uint8) (drawAlpha * 255.0f));
 	if (isDrawColorEnabled) {
-		SDL_SetTextureColorMod (texture, drawColor.rByte, drawColor.gByte, drawColor.bByte);
+		drawList->copyTexture (texture, NULL, rect, drawColor.rByte, drawColor.gByte, drawColor.bByte, (Uint8) (drawAlpha * 255.0f));
 	}
-	SDL_RenderCopy (App::instance->render, texture, NULL, &rect);
-	if (isDrawColorEnabled) {
-		SDL_SetTextureColorMod (texture, 255, 255, 255);
+	else {
+		drawList->copyTexture (texture, NULL, rect, 255, 255, 255, (Uint8) (drawAlpha * 255.0f));
 	}
 }
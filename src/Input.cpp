@@ -33,38 +33,38 @@
 #include "SDL2/SDL.h"
 #include "App.h"
 #include "OsUtil.h"
+#include "DurationSampler.h"
 #include "Input.h"
 
 Input *Input::instance = NULL;
+const int Input::MaxPendingPresentCount = 1024;
 
 Input::Input ()
 : keyRepeatStartThreshold (680)
 , keyRepeatDelay (48)
 , mouseX (-1)
 , mouseY (-1)
-, lastMouseX (-1)
-, lastMouseY (-1)
 , isMouseLeftButtonDown (false)
 , isMouseRightButtonDown (false)
-, mouseLeftDownCount (0)
-, mouseRightDownCount (0)
-, mouseLeftUpCount (0)
-, mouseRightUpCount (0)
-, mouseWheelDownCount (0)
-, mouseWheelUpCount (0)
 , windowCloseCount (0)
-, isKeyPressListPopulated (false)
+, droppedEventCount (0)
 , isKeyRepeating (false)
 , keyRepeatCode (SDLK_UNKNOWN)
 , keyRepeatStartTime (0)
+, droppedLatencyCount (0)
+, latencyMutex (NULL)
 {
-	keyPressListMutex = SDL_CreateMutex ();
+	SDL_AtomicSet (&eventWriteIndex, 0);
+	SDL_AtomicSet (&eventReadIndex, 0);
+	consumedEventTimes.reserve (Input::EventQueueSize);
+	pendingPresentList.reserve (Input::MaxPendingPresentCount);
+	latencyMutex = SDL_CreateMutex ();
 }
 
 Input::~Input () {
-	if (keyPressListMutex) {
-		SDL_DestroyMutex (keyPressListMutex);
-		keyPressListMutex = NULL;
+	if (latencyMutex) {
+		SDL_DestroyMutex (latencyMutex);
+		latencyMutex = NULL;
 	}
 }
 
@@ -151,13 +151,128 @@ void Input::stop () {
 	keyDownMap.clear ();
 }
 
+void Input::pushEvent (const Input::Event &event) {
+	int writeindex, nextindex;
+
+	writeindex = SDL_AtomicGet (&eventWriteIndex);
+	nextindex = (writeindex + 1) & (Input::EventQueueSize - 1);
+	if (nextindex == SDL_AtomicGet (&eventReadIndex)) {
+		++droppedEventCount;
+		return;
+	}
+
+	// The acquire barrier keeps the entry store below from moving ahead of the consumer's read of the slot, and the release barrier publishes the entry before the advanced index
+	SDL_MemoryBarrierAcquire ();
+	eventQueue[writeindex] = event;
+	SDL_MemoryBarrierRelease ();
+	SDL_AtomicSet (&eventWriteIndex, nextindex);
+}
+
+bool Input::pollEvent (Input::Event *destEvent) {
+	int readindex;
+
+	readindex = SDL_AtomicGet (&eventReadIndex);
+	if (readindex == SDL_AtomicGet (&eventWriteIndex)) {
+		return (false);
+	}
+	SDL_MemoryBarrierAcquire ();
+	*destEvent = eventQueue[readindex];
+	SDL_MemoryBarrierRelease ();
+	SDL_AtomicSet (&eventReadIndex, (readindex + 1) & (Input::EventQueueSize - 1));
+	return (true);
+}
+
+void Input::dispatchEvent (const Input::Event &event) {
+	processLatency.addSample (OsUtil::getMonotonicTime () - event.time);
+	if (((int) consumedEventTimes.size ()) < Input::MaxPendingPresentCount) {
+		consumedEventTimes.push_back (event.time);
+	}
+}
+
+void Input::endUpdate (int64_t drawListSequence) {
+	std::vector<int64_t>::iterator i, end;
+	Input::PendingPresent item;
+	int64_t now;
+
+	if (consumedEventTimes.empty ()) {
+		return;
+	}
+	now = OsUtil::getMonotonicTime ();
+	item.updateEndTime = now;
+	item.drawListSequence = drawListSequence;
+
+	SDL_LockMutex (latencyMutex);
+	i = consumedEventTimes.begin ();
+	end = consumedEventTimes.end ();
+	while (i != end) {
+		updateLatency.addSample (now - *i);
+		if (((int) pendingPresentList.size ()) >= Input::MaxPendingPresentCount) {
+			++droppedLatencyCount;
+		}
+		else {
+			item.eventTime = *i;
+			pendingPresentList.push_back (item);
+		}
+		++i;
+	}
+	SDL_UnlockMutex (latencyMutex);
+	consumedEventTimes.clear ();
+}
+
+void Input::endPresent (int64_t drawStartTime, int64_t drawListSequence) {
+	std::vector<Input::PendingPresent>::iterator i, end, dest;
+	int64_t now;
+	bool ispresented;
+
+	now = OsUtil::getMonotonicTime ();
+	SDL_LockMutex (latencyMutex);
+	i = pendingPresentList.begin ();
+	end = pendingPresentList.end ();
+	dest = i;
+	while (i != end) {
+		// With draw lists enabled, a frame includes the result of an update pass only if it executed the list recorded by that pass or a later one. Otherwise, the frame reads widget state directly and includes the result of any update pass that ended before drawing began.
+		if (i->drawListSequence > 0) {
+			ispresented = (drawListSequence >= i->drawListSequence);
+		}
+		else {
+			ispresented = (i->updateEndTime <= drawStartTime);
+		}
+		if (ispresented) {
+			presentLatency.addSample (now - i->eventTime);
+		}
+		else {
+			*dest = *i;
+			++dest;
+		}
+		++i;
+	}
+	pendingPresentList.erase (dest, end);
+	SDL_UnlockMutex (latencyMutex);
+}
+
+Input::LatencyStats Input::getLatencyStats () {
+	Input::LatencyStats stats;
+
+	stats.process = processLatency.getPercentiles ();
+	stats.update = updateLatency.getPercentiles ();
+	stats.present = presentLatency.getPercentiles ();
+	SDL_LockMutex (latencyMutex);
+	stats.droppedCount = droppedLatencyCount;
+	SDL_UnlockMutex (latencyMutex);
+
+	return (stats);
+}
+
 void Input::pollEvents () {
 	std::map<SDL_Keycode, bool>::iterator i;
 	SDL_Event event;
+	Input::Event inputevent;
 	int64_t now;
 
 	now = OsUtil::getTime ();
 	while (SDL_PollEvent (&event)) {
+		inputevent = Input::Event ();
+		inputevent.time = OsUtil::getMonotonicTime ();
 		switch (event.type) {
 			case SDL_KEYDOWN: {
 				i = keyDownMap.find (event.key.keysym.sym);
@@ -170,10 +285,11 @@ void Input::pollEvents () {
 					keyRepeatStartTime = now;
 					keyRepeatCode = event.key.keysym.sym;
 
-					SDL_LockMutex (keyPressListMutex);
-					keyPressList.push_back (event.key.keysym.sym);
-					isKeyPressListPopulated = true;
-					SDL_UnlockMutex (keyPressListMutex);
+					inputevent.type = Input::KeyPressEvent;
+					inputevent.keycode = event.key.keysym.sym;
+					inputevent.mouseX = mouseX;
+					inputevent.mouseY = mouseY;
+					pushEvent (inputevent);
 				}
 				break;
 			}
@@ -189,45 +305,56 @@ void Input::pollEvents () {
 				}
 				break;
 			}
+			case SDL_MOUSEMOTION: {
+				mouseX = event.motion.x;
+				mouseY = event.motion.y;
+				inputevent.type = Input::MouseMotionEvent;
+				inputevent.mouseX = mouseX;
+				inputevent.mouseY = mouseY;
+				pushEvent (inputevent);
+				break;
+			}
 			case SDL_MOUSEBUTTONDOWN: {
 				if (event.button.button == SDL_BUTTON_LEFT) {
 					isMouseLeftButtonDown = true;
-					++mouseLeftDownCount;
 				}
 				else if (event.button.button == SDL_BUTTON_RIGHT) {
 					isMouseRightButtonDown = true;
-					++mouseRightDownCount;
 				}
+				mouseX = event.button.x;
+				mouseY = event.button.y;
+				inputevent.type = Input::MouseButtonDownEvent;
+				inputevent.button = event.button.button;
+				inputevent.mouseX = mouseX;
+				inputevent.mouseY = mouseY;
+				pushEvent (inputevent);
 				break;
 			}
 			case SDL_MOUSEBUTTONUP: {
 				if (event.button.button == SDL_BUTTON_LEFT) {
 					isMouseLeftButtonDown = false;
-					++mouseLeftUpCount;
 				}
 				else if (event.button.button == SDL_BUTTON_RIGHT) {
 					isMouseRightButtonDown = false;
-					++mouseRightUpCount;
 				}
+				mouseX = event.button.x;
+				mouseY = event.button.y;
+				inputevent.type = Input::MouseButtonUpEvent;
+				inputevent.button = event.button.button;
+				inputevent.mouseX = mouseX;
+				inputevent.mouseY = mouseY;
+				pushEvent (inputevent);
 				break;
 			}
 			case SDL_MOUSEWHEEL: {
-				if (event.wheel.direction == SDL_MOUSEWHEEL_NORMAL) {
-					if (event.wheel.y < 0) {
-						++mouseWheelDownCount;
-					}
-					else if (event.wheel.y > 0) {
-						++mouseWheelUpCount;
-					}
-				}
-				else {
-					if (event.wheel.y < 0) {
-						++mouseWheelUpCount;
-					}
-					else if (event.wheel.y > 0) {
-						++mouseWheelDownCount;
-					}
+				if (event.wheel.y == 0) {
+					break;
 				}
+				inputevent.type = Input::MouseWheelEvent;
+				inputevent.wheelDelta = (event.wheel.direction == SDL_MOUSEWHEEL_NORMAL) ? event.wheel.y : -(event.wheel.y);
+				inputevent.mouseX = mouseX;
+				inputevent.mouseY = mouseY;
+				pushEvent (inputevent);
 				break;
 			}
 			case SDL_WINDOWEVENT: {
@@ -252,17 +379,16 @@ void Input::pollEvents () {
 		if (isKeyRepeating) {
 			if ((keyRepeatStartTime <= 0) || ((now - keyRepeatStartTime) >= keyRepeatDelay)) {
 				keyRepeatStartTime = now;
-				SDL_LockMutex (keyPressListMutex);
-				keyPressList.push_back (keyRepeatCode);
-				isKeyPressListPopulated = true;
-				SDL_UnlockMutex (keyPressListMutex);
+				inputevent = Input::Event ();
+				inputevent.type = Input::KeyPressEvent;
+				inputevent.time = OsUtil::getMonotonicTime ();
+				inputevent.keycode = keyRepeatCode;
+				inputevent.mouseX = mouseX;
+				inputevent.mouseY = mouseY;
+				pushEvent (inputevent);
 			}
 		}
 	}
-
-	lastMouseX = mouseX;
-	lastMouseY = mouseY;
-	SDL_GetMouseState (&mouseX, &mouseY);
 }
 
 bool Input::isKeyDown (SDL_Keycode keycode) {
@@ -293,24 +419,6 @@ bool Input::isControlDown () {
 	return (false);
 }
 
-void Input::pollKeyPressEvents (std::vector<SDL_Keycode> *destVector) {
-	std::vector<SDL_Keycode>::iterator i, end;
-
-	if (! isKeyPressListPopulated) {
-		return;
-	}
-	SDL_LockMutex (keyPressListMutex);
-	i = keyPressList.begin ();
-	end = keyPressList.end ();
-	while (i != end) {
-		destVector->push_back (*i);
-		++i;
-	}
-	keyPressList.clear ();
-	isKeyPressListPopulated = false;
-	SDL_UnlockMutex (keyPressListMutex);
-}
-
 void Input::windowClose () {
 	++windowCloseCount;
 }
@@ -36,6 +36,7 @@
 #include <vector>
 #include "SDL2/SDL.h"
 #include "OsUtil.h"
+#include "DurationSampler.h"
 
 class Input {
 public:
@@ -43,18 +44,53 @@ public:
 	~Input ();
 	static Input *instance;
 
+	// Types of events held in the input event queue
+	enum EventType {
+		KeyPressEvent = 0,
+		MouseMotionEvent = 1,
+		MouseButtonDownEvent = 2,
+		MouseButtonUpEvent = 3,
+		MouseWheelEvent = 4
+	};
+	struct Event {
+		int type;
+		int64_t time; // Monotonic clock value in nanoseconds at the time the event was received
+		SDL_Keycode keycode;
+		int button;
+		int mouseX, mouseY;
+		int wheelDelta; // Positive values indicate upward scrolling
+		Event ():
+			type (0),
+			time (0),
+			keycode (SDLK_UNKNOWN),
+			button (0),
+			mouseX (0),
+			mouseY (0),
+			wheelDelta (0) { }
+	};
+
+	// The number of entries in the input event queue, which must be a power of two
+	static const int EventQueueSize = 256;
+
+	// Percentiles of the time in nanoseconds between the arrival of input events and each stage of the pipeline that handled them
+	struct LatencyStats {
+		DurationSampler::Percentiles process; // Until processInput dispatched the event
+		DurationSampler::Percentiles update; // Until the update pass that consumed the event ended
+		DurationSampler::Percentiles present; // Until SDL_RenderPresent returned for the first frame that included the result of that update pass
+		int droppedCount; // Events not measured to the present stage because too many events were awaiting a frame
+		LatencyStats ():
+			droppedCount (0) { }
+	};
+
 	// Read-write data members
 	int keyRepeatStartThreshold;
 	int keyRepeatDelay;
 
 	// Read-only data members
 	int mouseX, mouseY;
-	int lastMouseX, lastMouseY;
 	bool isMouseLeftButtonDown, isMouseRightButtonDown;
-	int mouseLeftDownCount, mouseRightDownCount;
-	int mouseLeftUpCount, mouseRightUpCount;
-	int mouseWheelDownCount, mouseWheelUpCount;
 	int windowCloseCount;
+	int droppedEventCount; // Events discarded because the input event queue was full
 
 	// Initialize input functionality and acquire resources as needed. Returns a Result value.
 	OsUtil::Result start ();
@@ -77,20 +113,63 @@ public:
 	// Return the character value associated with the specified keycode, or 0 if no such character was found
 	char getKeyCharacter (SDL_Keycode keycode, bool isShiftDown);
 
-	// Consume keypress events that have occurred since the last poll and append the resulting items to the provided vector
-	void pollKeyPressEvents (std::vector<SDL_Keycode> *destVector);
+	// Remove the oldest event from the input event queue and store it in destEvent. Returns a boolean value indicating if an event was available. This method must be invoked only from the application's update thread, which is the queue's only consumer.
+	bool pollEvent (Input::Event *destEvent);
+
+	// Record that an event removed by pollEvent is being dispatched to widgets, including it in latency measurement. Events that the consumer discards without dispatching are not recorded. This method must be invoked only from the application's update thread.
+	void dispatchEvent (const Input::Event &event);
 
 	// Generate a window close event for consumption by Ui classes
 	void windowClose ();
 
+	// Record the end of an update pass, measuring latency for all events dispatched since the previous call. drawListSequence identifies the draw list recorded by the update pass, or zero if draw lists are not enabled. This method must be invoked only from the application's update thread.
+	void endUpdate (int64_t drawListSequence);
+
+	// Record the return of SDL_RenderPresent, measuring latency for events whose results were included in the presented frame. drawStartTime is the monotonic clock value at which drawing of the frame began, and drawListSequence identifies the draw list executed by the frame, or zero if draw lists are not enabled. This method must be invoked only from the application's main thread.
+	void endPresent (int64_t drawStartTime, int64_t drawListSequence);
+
+	// Return latency percentiles computed from recently measured input events
+	Input::LatencyStats getLatencyStats ();
+
 private:
+	// Add an event to the input event queue, or discard it if the queue is full. This method must be invoked only from the application's main thread, which is the queue's only producer.
+	void pushEvent (const Input::Event &event);
+
+	// The maximum number of events that may await a presented frame before further events are excluded from present latency measurement
+	static const int MaxPendingPresentCount;
+
+	struct PendingPresent {
+		int64_t eventTime;
+		int64_t updateEndTime;
+		int64_t drawListSequence;
+		PendingPresent ():
+			eventTime (0),
+			updateEndTime (0),
+			drawListSequence (0) { }
+	};
+
 	std::map<SDL_Keycode, bool> keyDownMap;
-	std::vector<SDL_Keycode> keyPressList;
-	SDL_mutex *keyPressListMutex;
-	bool isKeyPressListPopulated;
+
+	// Single-producer, single-consumer ring of input events. The main thread writes the entry at eventWriteIndex before advancing it, and the update thread reads the entry at eventReadIndex before advancing it, so neither index is ever written by more than one thread.
+	Input::Event eventQueue[Input::EventQueueSize];
+	SDL_atomic_t eventWriteIndex;
+	SDL_atomic_t eventReadIndex;
+
 	bool isKeyRepeating;
 	int keyRepeatCode;
 	int64_t keyRepeatStartTime;
+
+	// Arrival times of events dispatched during the current update pass. This list is accessed only by the application's update thread.
+	std::vector<int64_t> consumedEventTimes;
+
+	// Events whose update pass has ended, awaiting the present of a frame that includes the result
+	std::vector<Input::PendingPresent> pendingPresentList;
+	int droppedLatencyCount;
+	SDL_mutex *latencyMutex;
+
+	DurationSampler processLatency;
+	DurationSampler updateLatency;
+	DurationSampler presentLatency;
 };
 
 #endif
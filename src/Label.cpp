@@ -37,6 +37,7 @@
 #include "Sprite.h"
 #include "Resource.h"
 #include "Font.h"
+#include "DrawList.h"
 #include "Widget.h"
 #include "Label.h"
 
@@ -54,6 +55,7 @@ Label::Label (const StdString &text, UiConfiguration::FontType fontType, const C
 , descenderHeight (0.0f)
 , isUnderlined (false)
 , isObscured (false)
+, glyphListRevision (0)
 , maxGlyphTopBearing (0)
 , underlineMargin (0.0f)
 , textMutex (NULL)
@@ -155,10 +157,10 @@ void Label::setUnderlined (bool enable) {
 	isUnderlined = enable;
 	underlineMargin = UiConfiguration::instance->textUnderlineMargin;
 	if (isUnderlined) {
-		height = maxGlyphTopBearing + underlineMargin + 1.0f;
+		assignSize (width, maxGlyphTopBearing + underlineMargin + 1.0f);
 	}
 	else {
-		height = maxCharacterHeight;
+		assignSize (width, maxCharacterHeight);
 	}
 }
 
@@ -170,7 +172,28 @@ void Label::setObscured (bool enable) {
 	setText (text, textFontType, true);
 }
 
-void Label::doDraw (SDL_Texture *targetTexture, float originX, float originY) {
+uint64_t Label::getDrawKey (DrawList *drawList, const SDL_Rect &clipRect, float originX, float originY) {
+	uint64_t key;
+
+	key = DrawList::DrawKeyBasis;
+	key = DrawList::hashDrawKey (key, (int) (originX + position.x));
+	key = DrawList::hashDrawKey (key, (int) (originY + position.y));
+	key = DrawList::hashDrawKey (key, (textColor.rByte << 16) | (textColor.gByte << 8) | textColor.bByte);
+	key = DrawList::hashDrawKey (key, App::instance->windowWidth);
+	key = DrawList::hashDrawKey (key, App::instance->windowHeight);
+	SDL_LockMutex (textMutex);
+	key = DrawList::hashDrawKey (key, (int64_t) (intptr_t) textFont);
+	key = DrawList::hashDrawKey (key, glyphListRevision);
+	key = DrawList::hashDrawKey (key, (int) width);
+	key = DrawList::hashDrawKey (key, isUnderlined);
+	key = DrawList::hashDrawKey (key, (int) underlineMargin);
+	key = DrawList::hashDrawKey (key, maxGlyphTopBearing);
+	SDL_UnlockMutex (textMutex);
+
+	return (key);
+}
+
+void Label::doDraw (DrawList *drawList, float originX, float originY) {
 	Font::Glyph *glyph;
 	std::list<Font::Glyph *>::iterator i, end;
 	std::list<int>::iterator ki, kend;
@@ -211,10 +234,7 @@ void Label::doDraw (SDL_Texture *targetTexture, float originX, float originY) {
 			rect.x = x + x0 + glyph->leftBearing + kerning;
 			rect.y = y + y0 + maxGlyphTopBearing - glyph->topBearing;
 			if (((rect.x + glyph->advanceWidth) >= 0) && (rect.x < App::instance->windowWidth) && ((rect.y + maxGlyphTopBearing) >= 0) && (rect.y < App::instance->windowHeight)) {
-				rect.w = glyph->width;
-				rect.h = glyph->height;
-				SDL_SetTextureColorMod (glyph->texture, textColor.rByte, textColor.gByte, textColor.bByte);
-				SDL_RenderCopy (App::instance->render, glyph->texture, NULL, &rect);
+				drawList->copyGlyph (textFont, glyph, rect.x, rect.y, textColor.rByte, textColor.gByte, textColor.bByte);
 			}
 
 			x += glyph->advanceWidth;
@@ -234,8 +254,7 @@ void Label::doDraw (SDL_Texture *targetTexture, float originX, float originY) {
 
 	if (isUnderlined) {
 		y = y0 + maxGlyphTopBearing + (int) underlineMargin;
-		SDL_SetRenderDrawColor (App::instance->render, textColor.rByte, textColor.gByte, textColor.bByte, 255);
-		SDL_RenderDrawLine (App::instance->render, x0, y, (int) (x0 + width), y);
+		drawList->drawLine (x0, y, (int) (x0 + width), y, textColor.rByte, textColor.gByte, textColor.bByte);
 	}
 	SDL_UnlockMutex (textMutex);
 }
@@ -248,10 +267,6 @@ void Label::doRefresh () {
 	}
 }
 
-void Label::doUpdate (int msElapsed) {
-	textColor.update (msElapsed);
-}
-
 void Label::setText (const StdString &textContent, UiConfiguration::FontType fontType, bool forceFontReload) {
 	Font *font;
 	Font::Glyph *glyph;
@@ -287,11 +302,11 @@ void Label::setText (const StdString &textContent, UiConfiguration::FontType fon
 	SDL_LockMutex (textMutex);
 	text.assign (textContent);
 	glyphList.clear ();
+	++glyphListRevision;
 	kerningList.clear ();
 	textlen = text.length ();
 	if (textlen <= 0) {
-		width = 0.0f;
-		height = 0.0f;
+		assignSize (0.0f, 0.0f);
 		maxCharacterHeight = 0.0f;
 		descenderHeight = 0.0f;
 		SDL_UnlockMutex (textMutex);
@@ -354,13 +369,12 @@ void Label::setText (const StdString &textContent, UiConfiguration::FontType fon
 		}
 	}
 
-	width = x;
 	maxCharacterHeight = (float) maxh;
 	if (isUnderlined) {
-		height = maxGlyphTopBearing + underlineMargin + 1.0f;
+		assignSize (x, maxGlyphTopBearing + underlineMargin + 1.0f);
 	}
 	else {
-		height = maxCharacterHeight;
+		assignSize (x, maxCharacterHeight);
 	}
 	SDL_UnlockMutex (textMutex);
 }
@@ -38,6 +38,7 @@
 #include "UiConfiguration.h"
 #include "Font.h"
 #include "Color.h"
+#include "DrawList.h"
 #include "Widget.h"
 
 class Label : public Widget {
@@ -92,20 +93,21 @@ public:
 	virtual void centerVertical (float topExtent, float bottomExtent);
 
 protected:
-	// Execute operations to update object state as appropriate for an elapsed millisecond time period
-	virtual void doUpdate (int msElapsed);
-
 	// Execute subclass-specific operations to refresh the widget's layout as appropriate for the current set of UiConfiguration values
 	virtual void doRefresh ();
 
-	// Add subclass-specific draw commands for execution by the App. If targetTexture is non-NULL, it has been set as the render target and draw commands should adjust coordinates as appropriate.
-	virtual void doDraw (SDL_Texture *targetTexture, float originX, float originY);
+	// Add subclass-specific draw commands to drawList. If the list holds a non-NULL targetTexture, draw commands render to that texture and should adjust coordinates as appropriate.
+	virtual void doDraw (DrawList *drawList, float originX, float originY);
+
+	// Return a hash of all values that affect commands added by doDraw with the specified clip rectangle and origin position, or zero if the widget's draw commands should not be retained for replay
+	virtual uint64_t getDrawKey (DrawList *drawList, const SDL_Rect &clipRect, float originX, float originY);
 
 	// Return a string that should be included as part of the toString method's output
 	StdString toStringDetail ();
 
 private:
 	std::list<Font::Glyph *> glyphList;
+	int glyphListRevision;
 	int maxGlyphTopBearing;
 	float underlineMargin;
 	std::list<int> kerningList;
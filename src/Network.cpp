@@ -64,6 +64,7 @@
 #include "OsUtil.h"
 #include "StdString.h"
 #include "Ipv4Address.h"
+#include "Trace.h"
 #include "Network.h"
 
 Network *Network::instance = NULL;
@@ -85,6 +86,7 @@ Network::Network ()
 , httpRequestQueueMutex (NULL)
 , httpRequestQueueCond (NULL)
 , httpRequestThreadStopCount (0)
+, activeHttpRequestCount (0)
 #if PLATFORM_WINDOWS
 , isWsaStarted (false)
 #endif
@@ -350,6 +352,16 @@ bool Network::isStopComplete () {
 	return (isStopped && (httpRequestThreadStopCount >= maxRequestThreads));
 }
 
+int Network::getHttpRequestCount () {
+	int result;
+
+	SDL_LockMutex (httpRequestQueueMutex);
+	result = (int) httpRequestQueue.size () + activeHttpRequestCount;
+	SDL_UnlockMutex (httpRequestQueueMutex);
+
+	return (result);
+}
+
 OsUtil::Result Network::resetInterfaces () {
 #if PLATFORM_LINUX
 	struct ifreq req, *i, *end;
@@ -596,6 +608,9 @@ int Network::runDatagramReceiveThread (void *networkPtr) {
 	char buf[Network::MaxDatagramSize], host[NI_MAXHOST];
 
 	network = (Network *) networkPtr;
+	if (Trace::instance) {
+		Trace::instance->setThreadName ("datagramReceive");
+	}
 	while (true) {
 		if (network->isStopped || (network->datagramSocket < 0)) {
 			break;
@@ -625,6 +640,9 @@ int Network::runDatagramSendThread (void *networkPtr) {
 	int result;
 
 	network = (Network *) networkPtr;
+	if (Trace::instance) {
+		Trace::instance->setThreadName ("datagramSend");
+	}
 	SDL_LockMutex (network->datagramSendMutex);
 	while (true) {
 		if (network->isStopped || (network->datagramSocket < 0)) {
@@ -785,6 +803,9 @@ int Network::runHttpRequestThread (void *networkPtr) {
 	SharedBuffer *responsebuffer;
 
 	network = (Network *) networkPtr;
+	if (Trace::instance) {
+		Trace::instance->setThreadName ("httpRequest");
+	}
 
 	SDL_LockMutex (network->httpRequestQueueMutex);
 	while (true) {
@@ -798,6 +819,7 @@ int Network::runHttpRequestThread (void *networkPtr) {
 
 		item = network->httpRequestQueue.front ();
 		network->httpRequestQueue.pop ();
+		++(network->activeHttpRequestCount);
 		SDL_UnlockMutex (network->httpRequestQueueMutex);
 
 		statuscode = 0;
@@ -815,6 +837,7 @@ int Network::runHttpRequestThread (void *networkPtr) {
 		}
 
 		SDL_LockMutex (network->httpRequestQueueMutex);
+		--(network->activeHttpRequestCount);
 	}
 	++(network->httpRequestThreadStopCount);
 	SDL_UnlockMutex (network->httpRequestQueueMutex);
@@ -829,6 +852,7 @@ OsUtil::Result Network::sendHttpRequest (Network::HttpRequestContext *item, int
 	SharedBuffer *buffer;
 	long responsecode;
 	OsUtil::Result result;
+	Trace::Scope scope ("Network::sendHttpRequest", "network");
 
 	curl = curl_easy_init ();
 	if (! curl) {
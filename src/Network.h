@@ -107,6 +107,9 @@ public:
 	// Return a string containing the address of the primary network interface, or an empty string if no such address was found
 	StdString getPrimaryInterfaceAddress ();
 
+	// Return the number of HTTP requests that are queued or in progress
+	int getHttpRequestCount ();
+
 	// Send a datagram packet to a remote host using data from the provided buffer. This class becomes responsible for freeing messageData when it's no longer needed.
 	void sendDatagram (const StdString &targetHostname, int targetPort, Buffer *messageData);
 
@@ -206,6 +209,7 @@ private:
 	SDL_cond *httpRequestQueueCond;
 	std::list<SDL_Thread *> httpRequestThreadList;
 	int httpRequestThreadStopCount;
+	int activeHttpRequestCount; // The number of requests removed from httpRequestQueue and not yet complete, protected by httpRequestQueueMutex
 #if PLATFORM_WINDOWS
 	bool isWsaStarted;
 #endif
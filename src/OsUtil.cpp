@@ -37,6 +37,8 @@
 #include <sys/wait.h>
 #include <unistd.h>
 #include <signal.h>
+#include <time.h>
+#include <sched.h>
 #endif
 #if PLATFORM_WINDOWS
 #include <time.h>
@@ -55,6 +57,7 @@
 #include "Log.h"
 
 const char *OsUtil::MonthNames[12] = { "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec" };
+const int64_t OsUtil::DefaultWaitSpinDuration = 2000000;
 
 int64_t OsUtil::getTime () {
 	int64_t t;
@@ -81,6 +84,65 @@ int64_t OsUtil::getTime () {
 	return (t);
 }
 
+int64_t OsUtil::getMonotonicTime () {
+	int64_t t;
+#if PLATFORM_LINUX || PLATFORM_MACOS
+	struct timespec now;
+
+	clock_gettime (CLOCK_MONOTONIC, &now);
+	t = ((int64_t) now.tv_sec) * 1000000000;
+	t += now.tv_nsec;
+#endif
+#if PLATFORM_WINDOWS
+	LARGE_INTEGER count, freq;
+
+	QueryPerformanceFrequency (&freq);
+	QueryPerformanceCounter (&count);
+
+	// Convert whole seconds and the remaining ticks separately to avoid overflowing the multiplication
+	t = (count.QuadPart / freq.QuadPart) * 1000000000;
+	t += ((count.QuadPart % freq.QuadPart) * 1000000000) / freq.QuadPart;
+#endif
+	return (t);
+}
+
+void OsUtil::waitUntil (int64_t deadline, int64_t spinDuration) {
+	int64_t t;
+#if PLATFORM_LINUX || PLATFORM_MACOS
+	struct timespec ts;
+#endif
+
+	if (spinDuration < 0) {
+		spinDuration = 0;
+	}
+	t = OsUtil::getMonotonicTime ();
+	while ((deadline - t) > spinDuration) {
+		t = deadline - t - spinDuration;
+#if PLATFORM_LINUX || PLATFORM_MACOS
+		ts.tv_sec = (time_t) (t / 1000000000);
+		ts.tv_nsec = (long) (t % 1000000000);
+		nanosleep (&ts, NULL);
+#endif
+#if PLATFORM_WINDOWS
+		// Sleep takes whole milliseconds; round up so that a wait without a spin window doesn't become a busy loop of zero-length sleeps
+		Sleep ((DWORD) ((t + 999999) / 1000000));
+#endif
+		t = OsUtil::getMonotonicTime ();
+	}
+	if (spinDuration <= 0) {
+		return;
+	}
+
+	while (OsUtil::getMonotonicTime () < deadline) {
+#if PLATFORM_LINUX || PLATFORM_MACOS
+		sched_yield ();
+#endif
+#if PLATFORM_WINDOWS
+		SwitchToThread ();
+#endif
+	}
+}
+
 int OsUtil::getProcessId () {
 #if PLATFORM_WINDOWS
 	return ((int) GetCurrentProcessId ());
@@ -76,10 +76,17 @@ public:
 	};
 
 	static const char *MonthNames[];
+	static const int64_t DefaultWaitSpinDuration; // nanoseconds
 
 	// Return the current time in milliseconds since the epoch
 	static int64_t getTime ();
 
+	// Return the current value of a monotonic clock in nanoseconds. Values are unaffected by changes to the system time and are meaningful only as differences from other getMonotonicTime results.
+	static int64_t getMonotonicTime ();
+
+	// Suspend the calling thread until getMonotonicTime reaches the specified nanosecond deadline, sleeping until spinDuration nanoseconds remain and spinning for the remainder to avoid oversleeping. A spinDuration of zero sleeps for the entire interval, trading wakeup precision for idle CPU time.
+	static void waitUntil (int64_t deadline, int64_t spinDuration = OsUtil::DefaultWaitSpinDuration);
+
 	// Return the application's process ID
 	static int getProcessId ();
 
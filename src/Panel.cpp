@@ -30,7 +30,7 @@
 #include "Config.h"
 #include <stdlib.h>
 #include <math.h>
-#include <list>
+#include <vector>
 #include "SDL2/SDL.h"
 #include "StdString.h"
 #include "StringList.h"
@@ -39,11 +39,15 @@
 #include "Resource.h"
 #include "Input.h"
 #include "OsUtil.h"
+#include "DrawList.h"
 #include "Widget.h"
 #include "ProgressBar.h"
 #include "Panel.h"
 
 const int Panel::LongPressDuration = 1000;
+const int Panel::HitGridMinWidgetCount = 32;
+const float Panel::HitGridMinCellSize = 16.0f;
+const int Panel::HitGridMaxCellCount = 4096;
 
 Panel::Panel ()
 : Widget ()
@@ -81,40 +85,36 @@ Panel::Panel ()
 , drawTexture (NULL)
 , drawTextureWidth (0)
 , drawTextureHeight (0)
+, drawTextureId (0)
 , isResettingDrawTexture (false)
-, isMouseInputStarted (false)
-, lastMouseLeftUpCount (0)
-, lastMouseLeftDownCount (0)
-, lastMouseRightUpCount (0)
-, lastMouseRightDownCount (0)
-, lastMouseWheelUpCount (0)
-, lastMouseWheelDownCount (0)
+, inputResetTime (0)
+, isInputLeftDown (false)
+, lastMouseX (-1)
+, lastMouseY (-1)
 , lastMouseDownX (-1)
 , lastMouseDownY (-1)
 , lastMouseDownTime (0)
-, cornerCenterDx (0)
-, cornerCenterDy (0)
-, cornerCenterDw (0)
-, cornerCenterDh (0)
-, cornerTopDx (0)
-, cornerTopDy (0)
-, cornerTopDw (0)
-, cornerTopDh (0)
-, cornerLeftDx (0)
-, cornerLeftDy (0)
-, cornerLeftDw (0)
-, cornerLeftDh (0)
-, cornerRightDx (0)
-, cornerRightDy (0)
-, cornerRightDw (0)
-, cornerRightDh (0)
-, cornerBottomDx (0)
-, cornerBottomDy (0)
-, cornerBottomDw (0)
-, cornerBottomDh (0)
 , cornerSize (0)
+, isSizeDirty (false)
+, isTextureCached (false)
+, isTextureCacheReady (false)
+, isTextureCacheDrawn (false)
+, textureCacheKey (0)
+, textureCacheBytes (0)
+, lastDrawKey (0)
+, cleanDrawCount (0)
+, contentDrawKey (0)
+, contentDrawKeySequence (0)
+, textureCacheSequence (0)
 , widgetListMutex (NULL)
 , widgetAddListMutex (NULL)
+, isHitGridValid (false)
+, hitGridX (0.0f)
+, hitGridY (0.0f)
+, hitGridCellWidth (0.0f)
+, hitGridCellHeight (0.0f)
+, hitGridColumnCount (0)
+, hitGridRowCount (0)
 {
 	widgetListMutex = SDL_CreateMutex ();
 	widgetAddListMutex = SDL_CreateMutex ();
@@ -123,10 +123,11 @@ Panel::Panel ()
 
 Panel::~Panel () {
 	clear ();
+	releaseTextureCache ();
 
-	if (! drawTexturePath.empty ()) {
-		Resource::instance->unloadTexture (drawTexturePath);
-		drawTexturePath.assign ("");
+	if (drawTextureId != 0) {
+		Resource::instance->unloadTexture (drawTextureId);
+		drawTextureId = 0;
 	}
 	drawTexture = NULL;
 
@@ -144,57 +145,88 @@ void Panel::setTextureRender (bool enable) {
 	if (! App::instance->isInterfaceAnimationEnabled) {
 		return;
 	}
+	SDL_LockMutex (widgetListMutex);
+	if (isTextureCached) {
+		// The texture render state now belongs to the caller instead of the automatic texture cache
+		releaseTextureCache ();
+	}
 	if (isTextureRenderEnabled == enable) {
+		SDL_UnlockMutex (widgetListMutex);
 		return;
 	}
 	isTextureRenderEnabled = enable;
+	SDL_UnlockMutex (widgetListMutex);
 	animationScale.assignX (1.0f);
 }
 
 void Panel::resetDrawTexture (void *panelPtr) {
 	Panel *panel;
 	SDL_Texture *texture;
+	DrawList drawlist;
+	uint64_t textureid;
+	int texturew, textureh;
+	bool isenabled;
 
+	// drawTexture and its size fields are read by the thread recording draw lists, and change only while holding a lock on widgetListMutex. A texture being replaced is unpublished before it's unloaded.
 	panel = (Panel *) panelPtr;
-	if (! panel->isTextureRenderEnabled) {
-		if (! panel->drawTexturePath.empty ()) {
-			Resource::instance->unloadTexture (panel->drawTexturePath);
-			panel->drawTexturePath.assign ("");
-		}
+	SDL_LockMutex (panel->widgetListMutex);
+	isenabled = panel->isTextureRenderEnabled;
+	texture = panel->drawTexture;
+	textureid = panel->drawTextureId;
+	texturew = (int) panel->width;
+	textureh = (int) panel->height;
+	if (texture && ((texturew != panel->drawTextureWidth) || (textureh != panel->drawTextureHeight))) {
+		texture = NULL;
+	}
+	if ((! isenabled) || (! texture)) {
 		panel->drawTexture = NULL;
-		panel->isResettingDrawTexture = false;
-		panel->release ();
-		return;
+		panel->drawTextureId = 0;
 	}
+	SDL_UnlockMutex (panel->widgetListMutex);
 
-	texture = panel->drawTexture;
-	if (texture) {
-		if (((int) panel->width) != panel->drawTextureWidth || (((int) panel->height) != panel->drawTextureHeight)) {
-			texture = NULL;
+	if (! isenabled) {
+		if (textureid != 0) {
+			Resource::instance->unloadTexture (textureid);
 		}
+		SDL_LockMutex (panel->widgetListMutex);
+		panel->isResettingDrawTexture = false;
+		SDL_UnlockMutex (panel->widgetListMutex);
+		panel->release ();
+		return;
 	}
 
 	if (! texture) {
-		if (! panel->drawTexturePath.empty ()) {
-			Resource::instance->unloadTexture (panel->drawTexturePath);
+		if (textureid != 0) {
+			Resource::instance->unloadTexture (textureid);
 		}
-		panel->drawTexture = NULL;
-
-		panel->drawTexturePath.sprintf ("*_Panel_%llx_%llx", (long long int) panel->id, (long long int) App::instance->getUniqueId ());
-		panel->drawTextureWidth = (int) panel->width;
-		panel->drawTextureHeight = (int) panel->height;
-		texture = Resource::instance->createTexture (panel->drawTexturePath, panel->drawTextureWidth, panel->drawTextureHeight);
+		textureid = Resource::instance->createResourceId ();
+		texture = Resource::instance->createTexture (textureid, texturew, textureh);
+	}
+	if (texture) {
+		drawlist.begin (App::instance->windowWidth, App::instance->windowHeight, App::instance->render, texture);
+		panel->draw (&drawlist, -(panel->position.x), -(panel->position.y));
+		drawlist.end ();
 	}
+
+	SDL_LockMutex (panel->widgetListMutex);
 	if (! texture) {
-		panel->drawTexturePath.assign ("");
 		panel->isTextureRenderEnabled = false;
+		if (panel->isTextureCached) {
+			panel->releaseTextureCache ();
+		}
 	}
 	else {
 		panel->drawTexture = texture;
-		panel->draw (texture, -(panel->position.x), -(panel->position.y));
+		panel->drawTextureId = textureid;
+		panel->drawTextureWidth = texturew;
+		panel->drawTextureHeight = textureh;
+		if (panel->isTextureCached) {
+			panel->isTextureCacheReady = true;
+		}
 	}
 	panel->shouldRefreshTexture = false;
 	panel->isResettingDrawTexture = false;
+	SDL_UnlockMutex (panel->widgetListMutex);
 	panel->release ();
 }
 
@@ -219,7 +251,7 @@ void Panel::animateNewCard () {
 }
 
 void Panel::clear () {
-	std::list<Widget *>::iterator i, end;
+	std::vector<Widget *>::iterator i, end;
 	Widget *widget;
 
 	SDL_LockMutex (widgetAddListMutex);
@@ -228,6 +260,7 @@ void Panel::clear () {
 	while (i != end) {
 		widget = *i;
 		widget->isDestroyed = true;
+		widget->parentWidget = NULL;
 		widget->release ();
 		++i;
 	}
@@ -240,12 +273,16 @@ void Panel::clear () {
 	while (i != end) {
 		widget = *i;
 		widget->isDestroyed = true;
+		widget->parentWidget = NULL;
 		widget->release ();
 		++i;
 	}
 	widgetList.clear ();
+	isHitGridValid = false;
+	childStates.clear ();
 	SDL_UnlockMutex (widgetListMutex);
 
+	invalidateLayout ();
 	resetSize ();
 }
 
@@ -258,17 +295,19 @@ Widget *Panel::addWidget (Widget *widget, float positionX, float positionY, int
 	}
 	widget->position.assign (positionX, positionY);
 	widget->zLevel = zLevel;
+	widget->parentWidget = this;
 	widget->retain ();
 	SDL_LockMutex (widgetAddListMutex);
 	widgetAddList.push_back (widget);
 	SDL_UnlockMutex (widgetAddListMutex);
 
-	resetSize ();
+	invalidateLayout ();
+	extendSize (widget);
 	return (widget);
 }
 
 void Panel::removeWidget (Widget *targetWidget) {
-	std::list<Widget *>::iterator i, end;
+	std::vector<Widget *>::iterator i, end;
 	Widget *widget;
 
 	SDL_LockMutex (widgetAddListMutex);
@@ -278,6 +317,7 @@ void Panel::removeWidget (Widget *targetWidget) {
 		widget = *i;
 		if (widget == targetWidget) {
 			widgetAddList.erase (i);
+			widget->parentWidget = NULL;
 			widget->release ();
 			break;
 		}
@@ -291,42 +331,27 @@ void Panel::removeWidget (Widget *targetWidget) {
 	while (i != end) {
 		widget = *i;
 		if (widget == targetWidget) {
+			if ((i - widgetList.begin ()) < (int) childStates.size ()) {
+				childStates.erase (childStates.begin () + (i - widgetList.begin ()));
+			}
 			widgetList.erase (i);
+			isHitGridValid = false;
+			widget->parentWidget = NULL;
 			widget->release ();
 			break;
 		}
 		++i;
 	}
 	SDL_UnlockMutex (widgetListMutex);
+
+	invalidateLayout ();
 }
 
 Widget *Panel::findWidget (float screenPositionX, float screenPositionY, bool requireMouseHoverEnabled) {
-	std::list<Widget *>::reverse_iterator i, end;
-	Widget *widget, *item, *nextitem;
-	float x, y, w, h;
+	Widget *item, *nextitem;
 
-	item = NULL;
 	SDL_LockMutex (widgetListMutex);
-	i = widgetList.rbegin ();
-	end = widgetList.rend ();
-	while (i != end) {
-		widget = *i;
-		++i;
-		if (widget->isDestroyed || (! widget->isVisible) || (! widget->hasScreenPosition)) {
-			continue;
-		}
-		w = widget->width;
-		h = widget->height;
-		if ((w <= 0.0f) || (h <= 0.0f)) {
-			continue;
-		}
-		x = widget->screenX;
-		y = widget->screenY;
-		if ((screenPositionX >= x) && (screenPositionX <= (x + w)) && (screenPositionY >= y) && (screenPositionY <= (y + h))) {
-			item = widget;
-			break;
-		}
-	}
+	item = findHitWidget (screenPositionX, screenPositionY, false);
 	SDL_UnlockMutex (widgetListMutex);
 
 	if (item) {
@@ -343,7 +368,7 @@ Widget *Panel::findWidget (float screenPositionX, float screenPositionY, bool re
 }
 
 Widget *Panel::findWidget (const StdString &widgetName) {
-	std::list<Widget *>::iterator i, end;
+	std::vector<Widget *>::iterator i, end;
 	Widget *widget, *item;
 
 	item = NULL;
@@ -370,7 +395,7 @@ Widget *Panel::findWidget (const StdString &widgetName) {
 }
 
 void Panel::processWidgets (Widget::EventCallback fn, void *fnData) {
-	std::list<Widget *>::const_iterator i, end;
+	std::vector<Widget *>::const_iterator i, end;
 
 	SDL_LockMutex (widgetListMutex);
 	i = widgetList.cbegin ();
@@ -392,7 +417,7 @@ void Panel::processWidgets (Widget::EventCallback fn, void *fnData) {
 }
 
 void Panel::getWidgetNames (StringList *destList) {
-	std::list<Widget *>::iterator i, end;
+	std::vector<Widget *>::iterator i, end;
 	Widget *widget;
 
 	SDL_LockMutex (widgetListMutex);
@@ -413,17 +438,19 @@ void Panel::getWidgetNames (StringList *destList) {
 }
 
 void Panel::doUpdate (int msElapsed) {
-	std::list<Widget *> addlist;
-	std::list<Widget *>::iterator i, end;
+	std::vector<Widget *> addlist;
+	std::vector<Widget *>::iterator i, end;
+	std::vector<Widget *> releaselist;
+	std::vector<Widget *>::iterator j, jend;
+	std::vector<Panel::ChildState>::iterator state;
+	Panel::ChildState addstate;
 	Widget *widget;
 	Panel *panel;
 	ProgressBar *bar;
-	bool found;
+	int index, count, pos;
+	bool shouldreset, islayoutchanged;
 
-	bgColor.update (msElapsed);
-	borderColor.update (msElapsed);
 	if (isAnimating) {
-		animationScale.update (msElapsed);
 		if (! animationScale.isTranslating) {
 			isAnimating = false;
 			if (FLOAT_EQUALS (animationScale.x, 1.0f)) {
@@ -437,25 +464,39 @@ void Panel::doUpdate (int msElapsed) {
 	SDL_UnlockMutex (widgetAddListMutex);
 
 	SDL_LockMutex (widgetListMutex);
-	widgetList.splice (widgetList.end (), addlist);
-	addlist.clear ();
-	while (true) {
-		found = false;
-		i = widgetList.begin ();
-		end = widgetList.end ();
-		while (i != end) {
-			widget = *i;
-			if (widget->isDestroyed) {
-				found = true;
-				widgetList.erase (i);
-				widget->release ();
-				break;
-			}
-			++i;
+	if (! addlist.empty ()) {
+		j = addlist.begin ();
+		jend = addlist.end ();
+		while (j != jend) {
+			addstate.zLevel = (*j)->zLevel;
+			widgetList.push_back (*j);
+			childStates.push_back (addstate);
+			++j;
 		}
-		if (! found) {
-			break;
+		isHitGridValid = false;
+	}
+
+	// Remove destroyed widgets in a single compaction pass, keeping childStates aligned with widgetList
+	count = (int) widgetList.size ();
+	pos = 0;
+	for (index = 0; index < count; ++index) {
+		widget = widgetList[index];
+		if (widget->isDestroyed) {
+			widget->parentWidget = NULL;
+			releaselist.push_back (widget);
+			continue;
 		}
+		if (pos != index) {
+			widgetList[pos] = widget;
+			childStates[pos] = childStates[index];
+		}
+		++pos;
+	}
+	if (pos < count) {
+		widgetList.resize (pos);
+		childStates.resize (pos);
+		isHitGridValid = false;
+		invalidateLayout ();
 	}
 
 	sortWidgetList ();
@@ -473,79 +514,150 @@ void Panel::doUpdate (int msElapsed) {
 
 	i = widgetList.begin ();
 	end = widgetList.end ();
+	state = childStates.begin ();
 	while (i != end) {
 		widget = *i;
 		widget->update (msElapsed, screenX - viewOriginX, screenY - viewOriginY);
+		if (Panel::updateChildState (&(*state), widget, &islayoutchanged)) {
+			isHitGridValid = false;
+			if (islayoutchanged) {
+				invalidateLayout ();
+			}
+		}
 		++i;
+		++state;
 	}
+	updateHitGrid ();
 	SDL_UnlockMutex (widgetListMutex);
 
+	// Release destroyed widgets after unlocking widgetListMutex, keeping widget destructor work out of the locked section
+	j = releaselist.begin ();
+	jend = releaselist.end ();
+	while (j != jend) {
+		(*j)->release ();
+		++j;
+	}
+
+	if (isSizeDirty) {
+		resetSize ();
+	}
+
+	// Texture render state is shared with resetDrawTexture tasks on the main thread, and changes only while no such task is pending
+	shouldreset = false;
+	SDL_LockMutex (widgetListMutex);
 	if (! isResettingDrawTexture) {
+		if ((App::instance->panelTextureCacheFrames > 0) && (contentDrawKeySequence != textureCacheSequence)) {
+			textureCacheSequence = contentDrawKeySequence;
+			updateTextureCache (contentDrawKey);
+		}
 		if ((isTextureRenderEnabled && (! drawTexture)) || ((! isTextureRenderEnabled) && drawTexture) || shouldRefreshTexture) {
 			isResettingDrawTexture = true;
 			shouldRefreshTexture = false;
-			retain ();
-			App::instance->addRenderTask (Panel::resetDrawTexture, this);
+			shouldreset = true;
 		}
 	}
+	SDL_UnlockMutex (widgetListMutex);
+	if (shouldreset) {
+		retain ();
+		App::instance->addRenderTask (Panel::resetDrawTexture, this);
+	}
 }
 
 void Panel::processInput () {
-	std::list<Widget *>::reverse_iterator i, iend;
+	Input::Event event;
 	std::vector<SDL_Keycode> keyevents;
+	Widget::MouseState mousestate;
+	bool isbuttonpending;
+
+	// Group consecutive input events into steps and dispatch each step in the order its events were received. A left button event always occupies a step of its own, so that widgets observe it at the pointer position where it occurred and in order with surrounding key events.
+	isbuttonpending = false;
+	mousestate.positionX = lastMouseX;
+	mousestate.positionY = lastMouseY;
+	while (Input::instance->pollEvent (&event)) {
+		if (event.time < inputResetTime) {
+			continue;
+		}
+		Input::instance->dispatchEvent (event);
+		if (isbuttonpending) {
+			processInputStep (&keyevents, mousestate);
+			keyevents.clear ();
+			mousestate = Widget::MouseState ();
+			isbuttonpending = false;
+		}
+		switch (event.type) {
+			case Input::KeyPressEvent: {
+				keyevents.push_back (event.keycode);
+				break;
+			}
+			case Input::MouseButtonDownEvent:
+			case Input::MouseButtonUpEvent: {
+				if (event.button != SDL_BUTTON_LEFT) {
+					break;
+				}
+				if (! keyevents.empty ()) {
+					processInputStep (&keyevents, mousestate);
+					keyevents.clear ();
+					mousestate = Widget::MouseState ();
+				}
+				if (event.type == Input::MouseButtonDownEvent) {
+					mousestate.isLeftClicked = true;
+					isInputLeftDown = true;
+				}
+				else {
+					mousestate.isLeftClickReleased = true;
+					isInputLeftDown = false;
+				}
+				isbuttonpending = true;
+				break;
+			}
+			case Input::MouseWheelEvent: {
+				if (event.wheelDelta > 0) {
+					mousestate.wheelUp += event.wheelDelta;
+				}
+				else {
+					mousestate.wheelDown -= event.wheelDelta;
+				}
+				break;
+			}
+		}
+
+		if ((lastMouseX >= 0) && (lastMouseY >= 0)) {
+			mousestate.positionDeltaX += (event.mouseX - lastMouseX);
+			mousestate.positionDeltaY += (event.mouseY - lastMouseY);
+		}
+		lastMouseX = event.mouseX;
+		lastMouseY = event.mouseY;
+		mousestate.positionX = lastMouseX;
+		mousestate.positionY = lastMouseY;
+	}
+
+	// The final step is dispatched even if no events were received, allowing widgets to update hover and long press state
+	processInputStep (&keyevents, mousestate);
+}
+
+void Panel::processInputStep (std::vector<SDL_Keycode> *keyEvents, const Widget::MouseState &mouseState) {
+	std::vector<Widget *>::reverse_iterator i, iend;
 	std::vector<SDL_Keycode>::iterator j, jend;
 	Widget *widget, *mousewidget;
 	Widget::MouseState mousestate;
 	float x, y, enterdx, enterdy;
 	bool isshiftdown, iscontroldown, isleftdown, isconsumed;
 
-	Input::instance->pollKeyPressEvents (&keyevents);
+	mousestate = mouseState;
 	isshiftdown = Input::instance->isShiftDown ();
 	iscontroldown = Input::instance->isControlDown ();
-	isleftdown = (Input::instance->mouseLeftDownCount != Input::instance->mouseLeftUpCount);
-
-	if (isMouseInputStarted) {
-		if (Input::instance->mouseLeftDownCount != lastMouseLeftDownCount) {
-			mousestate.isLeftClicked = true;
-		}
-		if (Input::instance->mouseLeftUpCount != lastMouseLeftUpCount) {
-			mousestate.isLeftClickReleased = true;
-		}
-		mousestate.positionDeltaX = Input::instance->mouseX - Input::instance->lastMouseX;
-		mousestate.positionDeltaY = Input::instance->mouseY - Input::instance->lastMouseY;
-		mousestate.wheelUp = Input::instance->mouseWheelUpCount - lastMouseWheelUpCount;
-		mousestate.wheelDown = Input::instance->mouseWheelDownCount - lastMouseWheelDownCount;
-	}
-	lastMouseLeftUpCount = Input::instance->mouseLeftUpCount;
-	lastMouseLeftDownCount = Input::instance->mouseLeftDownCount;
-	lastMouseRightUpCount = Input::instance->mouseRightUpCount;
-	lastMouseRightDownCount = Input::instance->mouseRightDownCount;
-	lastMouseWheelUpCount = Input::instance->mouseWheelUpCount;
-	lastMouseWheelDownCount = Input::instance->mouseWheelDownCount;
-	isMouseInputStarted = true;
+	isleftdown = isInputLeftDown;
 
 	mousewidget = NULL;
-	x = Input::instance->mouseX;
-	y = Input::instance->mouseY;
+	x = (float) mousestate.positionX;
+	y = (float) mousestate.positionY;
 	enterdx = 0.0f;
 	enterdy = 0.0f;
 	SDL_LockMutex (widgetListMutex);
-	i = widgetList.rbegin ();
-	iend = widgetList.rend ();
-	while (i != iend) {
-		widget = *i;
-		++i;
-		if (widget->isDestroyed || widget->isInputSuspended || (! widget->isVisible) || (! widget->hasScreenPosition)) {
-			continue;
-		}
-		if ((widget->width > 0.0f) && (widget->height > 0.0f)) {
-			if ((x >= (int) widget->screenX) && (x <= (int) (widget->screenX + widget->width)) && (y >= (int) widget->screenY) && (y <= (int) (widget->screenY + widget->height))) {
-				mousewidget = widget;
-				enterdx = x - widget->screenX;
-				enterdy = y - widget->screenY;
-				break;
-			}
-		}
+	mousewidget = findHitWidget (x, y, true);
+	if (mousewidget) {
+		enterdx = x - mousewidget->screenX;
+		enterdy = y - mousewidget->screenY;
 	}
 
 	if (mousestate.isLeftClicked) {
@@ -561,10 +673,10 @@ void Panel::processInput () {
 		}
 	}
 
-	if (keyEventCallback.callback && (keyevents.size () > 0)) {
+	if (keyEventCallback.callback && (keyEvents->size () > 0)) {
 		isconsumed = false;
-		j = keyevents.begin ();
-		jend = keyevents.end ();
+		j = keyEvents->begin ();
+		jend = keyEvents->end ();
 		while (j != jend) {
 			if (keyEventCallback.callback (keyEventCallback.callbackData, *j, isshiftdown, iscontroldown)) {
 				isconsumed = true;
@@ -572,7 +684,7 @@ void Panel::processInput () {
 			++j;
 		}
 		if (isconsumed) {
-			keyevents.clear ();
+			keyEvents->clear ();
 		}
 	}
 
@@ -584,10 +696,10 @@ void Panel::processInput () {
 		if (widget->isDestroyed || widget->isInputSuspended || (! widget->isVisible) || (! widget->hasScreenPosition)) {
 			continue;
 		}
-		if (keyevents.size () > 0) {
+		if (keyEvents->size () > 0) {
 			isconsumed = false;
-			j = keyevents.begin ();
-			jend = keyevents.end ();
+			j = keyEvents->begin ();
+			jend = keyEvents->end ();
 			while (j != jend) {
 				if (widget->processKeyEvent (*j, isshiftdown, iscontroldown)) {
 					isconsumed = true;
@@ -595,7 +707,7 @@ void Panel::processInput () {
 				++j;
 			}
 			if (isconsumed) {
-				keyevents.clear ();
+				keyEvents->clear ();
 			}
 		}
 
@@ -635,7 +747,7 @@ void Panel::processInput () {
 }
 
 bool Panel::doProcessKeyEvent (SDL_Keycode keycode, bool isShiftDown, bool isControlDown) {
-	std::list<Widget *>::iterator i, end;
+	std::vector<Widget *>::iterator i, end;
 	Widget *widget;
 	bool result;
 
@@ -663,20 +775,23 @@ bool Panel::doProcessKeyEvent (SDL_Keycode keycode, bool isShiftDown, bool isCon
 }
 
 bool Panel::doProcessMouseState (const Widget::MouseState &mouseState) {
-	std::list<Widget *>::reverse_iterator i, end;
-	Widget *widget;
-	bool found, consumed;
+	std::vector<Widget *>::reverse_iterator i, end;
+	Widget *widget, *mousewidget;
+	bool consumed;
 	Widget::MouseState m;
 	float x, y;
 
 	if (isTextureRenderEnabled) {
 		return (false);
 	}
-	x = Input::instance->mouseX;
-	y = Input::instance->mouseY;
+	x = (float) mouseState.positionX;
+	y = (float) mouseState.positionY;
 	consumed = false;
-	found = false;
 	SDL_LockMutex (widgetListMutex);
+	mousewidget = NULL;
+	if (mouseState.isEntered) {
+		mousewidget = findHitWidget (x, y, true);
+	}
 	i = widgetList.rbegin ();
 	end = widgetList.rend ();
 	while (i != end) {
@@ -690,15 +805,10 @@ bool Panel::doProcessMouseState (const Widget::MouseState &mouseState) {
 		m.isEntered = false;
 		m.enterDeltaX = 0.0f;
 		m.enterDeltaY = 0.0f;
-		if ((! found) && mouseState.isEntered) {
-			if ((widget->width > 0.0f) && (widget->height > 0.0f)) {
-				if ((x >= (int) widget->screenX) && (x <= (int) (widget->screenX + widget->width)) && (y >= (int) widget->screenY) && (y <= (int) (widget->screenY + widget->height))) {
-					m.isEntered = true;
-					m.enterDeltaX = x - widget->screenX;
-					m.enterDeltaY = y - widget->screenY;
-					found = true;
-				}
-			}
+		if (widget == mousewidget) {
+			m.isEntered = true;
+			m.enterDeltaX = x - widget->screenX;
+			m.enterDeltaY = y - widget->screenY;
 		}
 
 		if (consumed) {
@@ -715,15 +825,11 @@ bool Panel::doProcessMouseState (const Widget::MouseState &mouseState) {
 }
 
 void Panel::doResetInputState () {
-	std::list<Widget *>::iterator i, end;
+	std::vector<Widget *>::iterator i, end;
 	Widget *widget;
 
-	lastMouseLeftUpCount = Input::instance->mouseLeftUpCount;
-	lastMouseLeftDownCount = Input::instance->mouseLeftDownCount;
-	lastMouseRightUpCount = Input::instance->mouseRightUpCount;
-	lastMouseRightDownCount = Input::instance->mouseRightDownCount;
-	lastMouseWheelUpCount = Input::instance->mouseWheelUpCount;
-	lastMouseWheelDownCount = Input::instance->mouseWheelDownCount;
+	inputResetTime = OsUtil::getMonotonicTime ();
+	isInputLeftDown = false;
 
 	SDL_LockMutex (widgetListMutex);
 	i = widgetList.begin ();
@@ -736,25 +842,227 @@ void Panel::doResetInputState () {
 	SDL_UnlockMutex (widgetListMutex);
 }
 
-void Panel::doDraw (SDL_Texture *targetTexture, float originX, float originY) {
-	SDL_Renderer *render;
-	SDL_Texture *cornertexture;
+bool Panel::isDrawVisible (const SDL_Rect &clipRect, float originX, float originY) {
+	int x, y, w, h;
+
+	if (! (isDropShadowed && (dropShadowColor.aByte > 0) && (dropShadowWidth >= 1.0f))) {
+		return (Widget::isDrawVisible (clipRect, originX, originY));
+	}
+
+	// A drop shadow extends beyond the panel's extents, and is drawn without intersecting the parent's clip rect
+	x = (int) (originX + position.x);
+	y = (int) (originY + position.y);
+	w = ((int) width) + (int) dropShadowWidth;
+	h = ((int) height) + (int) dropShadowWidth;
+	if (((x + w) <= clipRect.x) || (x >= (clipRect.x + clipRect.w + (int) dropShadowWidth))) {
+		return (false);
+	}
+	if (((y + h) <= clipRect.y) || (y >= (clipRect.y + clipRect.h + (int) dropShadowWidth))) {
+		return (false);
+	}
+	return (true);
+}
+
+uint64_t Panel::getDrawKey (DrawList *drawList, const SDL_Rect &clipRect, float originX, float originY) {
+	uint64_t key;
+
+	if (isTextureRenderEnabled && (! isTextureCached)) {
+		return (getTextureDrawKey (originX, originY, 0));
+	}
+
+	key = getContentDrawKey (drawList, clipRect, originX, originY);
+	contentDrawKey = key;
+	contentDrawKeySequence = drawList->sequence;
+
+	// If content changed since the cached texture was rendered, this recording draws the content directly, and doUpdate evicts the texture afterward
+	if (isTextureCacheDrawn && (key == textureCacheKey)) {
+		return (getTextureDrawKey (originX, originY, key));
+	}
+	return (key);
+}
+
+uint64_t Panel::getTextureDrawKey (float originX, float originY, uint64_t contentKey) {
+	uint64_t key;
+
+	key = DrawList::DrawKeyBasis;
+	key = DrawList::hashDrawKey (key, (int) (originX + position.x));
+	key = DrawList::hashDrawKey (key, (int) (originY + position.y));
+	key = DrawList::hashDrawKey (key, (int) width);
+	key = DrawList::hashDrawKey (key, (int) height);
+	key = DrawList::hashDrawKey (key, true);
+	SDL_LockMutex (widgetListMutex);
+	key = DrawList::hashDrawKey (key, (int64_t) (intptr_t) drawTexture);
+	key = DrawList::hashDrawKey (key, drawTextureWidth);
+	key = DrawList::hashDrawKey (key, drawTextureHeight);
+	SDL_UnlockMutex (widgetListMutex);
+	key = DrawList::hashDrawKey (key, (int64_t) (animationScale.x * 1000.0f));
+	key = DrawList::hashDrawKey (key, (int64_t) contentKey);
+	key = DrawList::hashDrawKey (key, isTextureCached && App::instance->isPanelTextureCacheOutlineEnabled);
+	return (key);
+}
+
+uint64_t Panel::getContentDrawKey (DrawList *drawList, const SDL_Rect &clipRect, float originX, float originY) {
+	SDL_Rect rect, childclip;
+	std::vector<Widget *>::iterator i, end;
+	Widget *widget;
+	uint64_t key, childkey;
+	int x0, y0;
+	float childx, childy;
+
+	x0 = (int) (originX + position.x);
+	y0 = (int) (originY + position.y);
+	key = DrawList::DrawKeyBasis;
+	key = DrawList::hashDrawKey (key, x0);
+	key = DrawList::hashDrawKey (key, y0);
+	key = DrawList::hashDrawKey (key, (int) width);
+	key = DrawList::hashDrawKey (key, (int) height);
+	key = DrawList::hashDrawKey (key, false);
+	key = DrawList::hashDrawKey (key, clipRect.x);
+	key = DrawList::hashDrawKey (key, clipRect.y);
+	key = DrawList::hashDrawKey (key, clipRect.w);
+	key = DrawList::hashDrawKey (key, clipRect.h);
+	key = DrawList::hashDrawKey (key, isFilledBg);
+	key = DrawList::hashDrawKey (key, (bgColor.rByte << 24) | (bgColor.gByte << 16) | (bgColor.bByte << 8) | bgColor.aByte);
+	key = DrawList::hashDrawKey (key, cornerSize);
+	key = DrawList::hashDrawKey (key, topLeftCornerRadius);
+	key = DrawList::hashDrawKey (key, topRightCornerRadius);
+	key = DrawList::hashDrawKey (key, bottomLeftCornerRadius);
+	key = DrawList::hashDrawKey (key, bottomRightCornerRadius);
+	if (cornerSize > 0) {
+		key = DrawList::hashDrawKey (key, (int64_t) (intptr_t) App::instance->getRoundedCornerAtlas ());
+	}
+	key = DrawList::hashDrawKey (key, isBordered);
+	key = DrawList::hashDrawKey (key, (borderColor.rByte << 24) | (borderColor.gByte << 16) | (borderColor.bByte << 8) | borderColor.aByte);
+	key = DrawList::hashDrawKey (key, (int64_t) (borderWidth * 1000.0f));
+	key = DrawList::hashDrawKey (key, isDropShadowed);
+	key = DrawList::hashDrawKey (key, (dropShadowColor.rByte << 24) | (dropShadowColor.gByte << 16) | (dropShadowColor.bByte << 8) | dropShadowColor.aByte);
+	key = DrawList::hashDrawKey (key, (int64_t) (dropShadowWidth * 1000.0f));
+	key = DrawList::hashDrawKey (key, (int) viewOriginX);
+	key = DrawList::hashDrawKey (key, (int) viewOriginY);
+
+	// Child keys are computed with the clip rectangle that doDraw pushes for this panel
+	rect.x = x0;
+	rect.y = y0;
+	rect.w = (int) width;
+	rect.h = (int) height;
+	childclip = DrawList::intersectRect (rect, clipRect);
+	childx = (float) (x0 - (int) viewOriginX);
+	childy = (float) (y0 - (int) viewOriginY);
+	SDL_LockMutex (widgetListMutex);
+	i = widgetList.begin ();
+	end = widgetList.end ();
+	while (i != end) {
+		widget = *i;
+		++i;
+		key = DrawList::hashDrawKey (key, (int64_t) (intptr_t) widget);
+		if (widget->isDestroyed || (! widget->isVisible)) {
+			key = DrawList::hashDrawKey (key, 0);
+			continue;
+		}
+		if (! widget->isDrawVisible (childclip, childx, childy)) {
+			key = DrawList::hashDrawKey (key, 1);
+			continue;
+		}
+
+		childkey = widget->findDrawKey (drawList, childclip, childx, childy);
+		if (childkey == 0) {
+			key = 0;
+			break;
+		}
+		key = DrawList::hashDrawKey (key, (int64_t) childkey);
+	}
+	SDL_UnlockMutex (widgetListMutex);
+
+	return (key);
+}
+
+void Panel::updateTextureCache (uint64_t contentKey) {
+	int bytes;
+	bool haschildren;
+
+	if (isTextureCached) {
+		if (contentKey != textureCacheKey) {
+			// Content changed since the texture was rendered. Evict the texture and draw directly until the content has been stable for panelTextureCacheFrames again.
+			releaseTextureCache ();
+			isTextureRenderEnabled = false;
+			lastDrawKey = contentKey;
+			return;
+		}
+		isTextureCacheDrawn = isTextureCacheReady;
+		return;
+	}
+
+	if ((contentKey == 0) || (contentKey != lastDrawKey)) {
+		lastDrawKey = contentKey;
+		cleanDrawCount = 0;
+		return;
+	}
+	if (cleanDrawCount < App::instance->panelTextureCacheFrames) {
+		++cleanDrawCount;
+		if (cleanDrawCount < App::instance->panelTextureCacheFrames) {
+			return;
+		}
+	}
+
+	// Panels already using a texture for an animation, and panels with content that a texture can't hold, are not eligible for caching
+	if (isTextureRenderEnabled || (! App::instance->isTextureRenderEnabled) || (width < 1.0f) || (height < 1.0f)) {
+		return;
+	}
+	if (isDropShadowed && (dropShadowColor.aByte > 0) && (dropShadowWidth >= 1.0f)) {
+		return;
+	}
+	SDL_LockMutex (widgetListMutex);
+	haschildren = (! widgetList.empty ());
+	SDL_UnlockMutex (widgetListMutex);
+	if (! haschildren) {
+		return;
+	}
+
+	bytes = ((int) width) * ((int) height) * 4;
+	if (! App::instance->reservePanelTextureCache (bytes)) {
+		return;
+	}
+	textureCacheBytes = bytes;
+	textureCacheKey = contentKey;
+	isTextureCached = true;
+	isTextureCacheReady = false;
+	isTextureCacheDrawn = false;
+	isTextureRenderEnabled = true;
+}
+
+void Panel::releaseTextureCache () {
+	if (textureCacheBytes > 0) {
+		App::instance->releasePanelTextureCache (textureCacheBytes);
+		textureCacheBytes = 0;
+	}
+	isTextureCached = false;
+	isTextureCacheReady = false;
+	isTextureCacheDrawn = false;
+	textureCacheKey = 0;
+	cleanDrawCount = 0;
+}
+
+void Panel::doDraw (DrawList *drawList, float originX, float originY) {
 	SDL_Rect rect;
-	std::list<Widget *>::iterator i, end;
+	std::vector<Widget *>::iterator i, end;
 	Widget *widget;
-	int x0, y0, texturew, textureh;
-	float w, h;
+	SDL_Texture *texture;
+	SDL_BlendMode blendmode;
+	int x0, y0;
+	float w, h, childx, childy;
 
-	render = App::instance->render;
 	x0 = (int) (originX + position.x);
 	y0 = (int) (originY + position.y);
 
-	if ((! targetTexture) && isTextureRenderEnabled) {
-		if (drawTexture) {
+	if ((! drawList->targetTexture) && isTextureRenderEnabled && ((! isTextureCached) || (isTextureCacheDrawn && (contentDrawKey == textureCacheKey)))) {
+		SDL_LockMutex (widgetListMutex);
+		texture = drawTexture;
+		w = (float) drawTextureWidth;
+		h = (float) drawTextureHeight;
+		SDL_UnlockMutex (widgetListMutex);
+		if (texture) {
 			rect.x = x0;
 			rect.y = y0;
-			w = drawTextureWidth;
-			h = drawTextureHeight;
 			if (! FLOAT_EQUALS (animationScale.x, 1.0f)) {
 				w *= animationScale.x;
 				h *= animationScale.x;
@@ -764,129 +1072,43 @@ void Panel::doDraw (SDL_Texture *targetTexture, float originX, float originY) {
 
 			rect.w = (int) w;
 			rect.h = (int) h;
-			SDL_RenderCopy (render, drawTexture, NULL, &rect);
+			drawList->copyTexture (texture, NULL, rect);
+			if (isTextureCached && App::instance->isPanelTextureCacheOutlineEnabled) {
+				drawList->drawLine (rect.x, rect.y, rect.x + rect.w - 1, rect.y, 255, 0, 255);
+				drawList->drawLine (rect.x, rect.y + rect.h - 1, rect.x + rect.w - 1, rect.y + rect.h - 1, 255, 0, 255);
+				drawList->drawLine (rect.x, rect.y, rect.x, rect.y + rect.h - 1, 255, 0, 255);
+				drawList->drawLine (rect.x + rect.w - 1, rect.y, rect.x + rect.w - 1, rect.y + rect.h - 1, 255, 0, 255);
+			}
 		}
 		return;
 	}
 
-	SDL_SetRenderTarget (render, targetTexture);
 	rect.x = x0;
 	rect.y = y0;
 	rect.w = (int) width;
 	rect.h = (int) height;
-	App::instance->pushClipRect (&rect);
+	drawList->pushClipRect (rect);
 
 	if (isFilledBg && (bgColor.aByte > 0)) {
-		SDL_SetRenderTarget (render, targetTexture);
-		if (bgColor.aByte < 255) {
-			SDL_SetRenderDrawBlendMode (render, SDL_BLENDMODE_BLEND);
-		}
-		SDL_SetRenderDrawColor (render, bgColor.rByte, bgColor.gByte, bgColor.bByte, bgColor.aByte);
-
+		blendmode = (bgColor.aByte < 255) ? SDL_BLENDMODE_BLEND : SDL_BLENDMODE_NONE;
 		if ((cornerSize > 0) && ((int) width >= cornerSize) && ((int) height >= cornerSize)) {
-			if (topLeftCornerRadius > 0) {
-				cornertexture = App::instance->getRoundedCornerTexture (topLeftCornerRadius, &texturew, &textureh);
-				if (cornertexture) {
-					rect.x = x0;
-					rect.y = y0;
-					rect.w = texturew;
-					rect.h = textureh;
-					SDL_SetTextureColorMod (cornertexture, bgColor.rByte, bgColor.gByte, bgColor.bByte);
-					SDL_SetTextureBlendMode (cornertexture, SDL_BLENDMODE_BLEND);
-					SDL_RenderCopy (render, cornertexture, NULL, &rect);
-				}
-			}
-			if (topRightCornerRadius > 0) {
-				cornertexture = App::instance->getRoundedCornerTexture (topRightCornerRadius, &texturew, &textureh);
-				if (cornertexture) {
-					rect.x = x0 + (int) width - texturew;
-					rect.y = y0;
-					rect.w = texturew;
-					rect.h = textureh;
-					SDL_SetTextureColorMod (cornertexture, bgColor.rByte, bgColor.gByte, bgColor.bByte);
-					SDL_SetTextureBlendMode (cornertexture, SDL_BLENDMODE_BLEND);
-					SDL_RenderCopy (render, cornertexture, NULL, &rect);
-				}
-			}
-			if (bottomLeftCornerRadius > 0) {
-				cornertexture = App::instance->getRoundedCornerTexture (bottomLeftCornerRadius, &texturew, &textureh);
-				if (cornertexture) {
-					rect.x = x0;
-					rect.y = y0 + (int) height - textureh;
-					rect.w = texturew;
-					rect.h = textureh;
-					SDL_SetTextureColorMod (cornertexture, bgColor.rByte, bgColor.gByte, bgColor.bByte);
-					SDL_SetTextureBlendMode (cornertexture, SDL_BLENDMODE_BLEND);
-					SDL_RenderCopy (render, cornertexture, NULL, &rect);
-				}
-			}
-			if (bottomRightCornerRadius > 0) {
-				cornertexture = App::instance->getRoundedCornerTexture (bottomRightCornerRadius, &texturew, &textureh);
-				if (cornertexture) {
-					rect.x = x0 + (int) width - texturew;
-					rect.y = y0 + (int) height - textureh;
-					rect.w = texturew;
-					rect.h = textureh;
-					SDL_SetTextureColorMod (cornertexture, bgColor.rByte, bgColor.gByte, bgColor.bByte);
-					SDL_SetTextureBlendMode (cornertexture, SDL_BLENDMODE_BLEND);
-					SDL_RenderCopy (render, cornertexture, NULL, &rect);
-				}
-			}
-
 			rect.x = x0;
 			rect.y = y0;
 			rect.w = (int) width;
 			rect.h = (int) height;
-			rect.x += cornerCenterDx;
-			rect.y += cornerCenterDy;
-			rect.w += cornerCenterDw;
-			rect.h += cornerCenterDh;
-			SDL_RenderFillRect (render, &rect);
-
-			if (cornerTopDh > 0) {
-				rect.x = x0 + cornerTopDx;
-				rect.y = y0 + cornerTopDy;
-				rect.w = ((int) width) + cornerTopDw;
-				rect.h = cornerTopDh;
-				SDL_RenderFillRect (render, &rect);
-			}
-			if (cornerLeftDw > 0) {
-				rect.x = x0 + cornerLeftDx;
-				rect.y = y0 + cornerLeftDy;
-				rect.w = cornerLeftDw;
-				rect.h = ((int) height) + cornerLeftDh;
-				SDL_RenderFillRect (render, &rect);
-			}
-			if (cornerRightDw > 0) {
-				rect.x = x0 + width + cornerRightDx;
-				rect.y = y0 + cornerRightDy;
-				rect.w = cornerRightDw;
-				rect.h = ((int) height) + cornerRightDh;
-				SDL_RenderFillRect (render, &rect);
-			}
-			if (cornerBottomDh > 0) {
-				rect.x = x0 + cornerBottomDx;
-				rect.y = y0 + height + cornerBottomDy;
-				rect.w = ((int) width) + cornerBottomDw;
-				rect.h = cornerBottomDh;
-				SDL_RenderFillRect (render, &rect);
-			}
+			drawList->fillRoundedRect (App::instance->getRoundedCornerAtlas (), rect, topLeftCornerRadius, topRightCornerRadius, bottomLeftCornerRadius, bottomRightCornerRadius, bgColor.rByte, bgColor.gByte, bgColor.bByte, bgColor.aByte);
 		}
 		else {
 			rect.x = x0;
 			rect.y = y0;
 			rect.w = (int) width;
 			rect.h = (int) height;
-			SDL_RenderFillRect (render, &rect);
-		}
-
-		if (bgColor.aByte < 255) {
-			SDL_SetRenderDrawBlendMode (render, SDL_BLENDMODE_NONE);
+			drawList->fillRect (rect, bgColor.rByte, bgColor.gByte, bgColor.bByte, bgColor.aByte, blendmode);
 		}
-		SDL_SetRenderDrawColor (render, 0, 0, 0, 0);
-		SDL_SetRenderTarget (render, NULL);
 	}
 
+	childx = (float) (x0 - (int) viewOriginX);
+	childy = (float) (y0 - (int) viewOriginY);
 	SDL_LockMutex (widgetListMutex);
 	i = widgetList.begin ();
 	end = widgetList.end ();
@@ -896,85 +1118,72 @@ void Panel::doDraw (SDL_Texture *targetTexture, float originX, float originY) {
 		if (widget->isDestroyed || (! widget->isVisible)) {
 			continue;
 		}
+		if (! widget->isDrawVisible (drawList->clipRect, childx, childy)) {
+			++(drawList->culledWidgetCount);
+			continue;
+		}
 
-		widget->draw (targetTexture, x0 - (int) viewOriginX, y0 - (int) viewOriginY);
+		++(drawList->drawnWidgetCount);
+		widget->draw (drawList, childx, childy);
 	}
 	SDL_UnlockMutex (widgetListMutex);
 
 	if (isBordered && (borderColor.aByte > 0) && (borderWidth >= 1.0f)) {
-		SDL_SetRenderTarget (render, targetTexture);
-		if (borderColor.aByte < 255) {
-			SDL_SetRenderDrawBlendMode (render, SDL_BLENDMODE_BLEND);
-		}
-		SDL_SetRenderDrawColor (render, borderColor.rByte, borderColor.gByte, borderColor.bByte, borderColor.aByte);
-
+		blendmode = (borderColor.aByte < 255) ? SDL_BLENDMODE_BLEND : SDL_BLENDMODE_NONE;
 		rect.x = x0;
 		rect.y = y0;
 		rect.w = (int) width;
 		rect.h = (int) borderWidth;
-		SDL_RenderFillRect (render, &rect);
+		drawList->fillRect (rect, borderColor.rByte, borderColor.gByte, borderColor.bByte, borderColor.aByte, blendmode);
 
 		rect.y = y0 + (int) (height - borderWidth);
-		SDL_RenderFillRect (render, &rect);
+		drawList->fillRect (rect, borderColor.rByte, borderColor.gByte, borderColor.bByte, borderColor.aByte, blendmode);
 
 		rect.y = y0 + (int) borderWidth;
 		rect.w = (int) borderWidth;
 		rect.h = ((int) height) - (int) (borderWidth * 2.0f);
-		SDL_RenderFillRect (render, &rect);
+		drawList->fillRect (rect, borderColor.rByte, borderColor.gByte, borderColor.bByte, borderColor.aByte, blendmode);
 
 		rect.x = x0 + (int) (width - borderWidth);
-		SDL_RenderFillRect (render, &rect);
-
-		if (borderColor.aByte < 255) {
-			SDL_SetRenderDrawBlendMode (render, SDL_BLENDMODE_NONE);
-		}
-		SDL_SetRenderDrawColor (render, 0, 0, 0, 0);
-		SDL_SetRenderTarget (render, NULL);
+		drawList->fillRect (rect, borderColor.rByte, borderColor.gByte, borderColor.bByte, borderColor.aByte, blendmode);
 	}
-	App::instance->popClipRect ();
+	drawList->popClipRect ();
 
 	if (isDropShadowed && (dropShadowColor.aByte > 0) && (dropShadowWidth >= 1.0f)) {
-		SDL_SetRenderTarget (render, targetTexture);
-		SDL_SetRenderDrawBlendMode (render, SDL_BLENDMODE_BLEND);
-		SDL_SetRenderDrawColor (render, dropShadowColor.rByte, dropShadowColor.gByte, dropShadowColor.bByte, dropShadowColor.aByte);
-
-		rect.x = App::instance->clipRect.x;
-		rect.y = App::instance->clipRect.y;
-		rect.w = App::instance->clipRect.w + dropShadowWidth;
-		rect.h = App::instance->clipRect.h + dropShadowWidth;
-		App::instance->pushClipRect (&rect, true);
+		rect.x = drawList->clipRect.x;
+		rect.y = drawList->clipRect.y;
+		rect.w = drawList->clipRect.w + dropShadowWidth;
+		rect.h = drawList->clipRect.h + dropShadowWidth;
+		drawList->pushClipRect (rect, true);
 
 		rect.x = x0 + (int) width;
 		rect.y = y0 + (int) dropShadowWidth;
 		rect.w = (int) dropShadowWidth;
 		rect.h = (int) height;
-		SDL_RenderFillRect (render, &rect);
+		drawList->fillRect (rect, dropShadowColor.rByte, dropShadowColor.gByte, dropShadowColor.bByte, dropShadowColor.aByte, SDL_BLENDMODE_BLEND);
 
 		rect.x = x0 + (int) dropShadowWidth;
 		rect.y = y0 + (int) height;
 		rect.w = (int) (width - dropShadowWidth);
 		rect.h = (int) dropShadowWidth;
-		SDL_RenderFillRect (render, &rect);
-
-		App::instance->popClipRect ();
+		drawList->fillRect (rect, dropShadowColor.rByte, dropShadowColor.gByte, dropShadowColor.bByte, dropShadowColor.aByte, SDL_BLENDMODE_BLEND);
 
-		SDL_SetRenderDrawBlendMode (render, SDL_BLENDMODE_NONE);
-		SDL_SetRenderDrawColor (render, 0, 0, 0, 0);
-		SDL_SetRenderTarget (render, NULL);
+		drawList->popClipRect ();
 	}
 }
 
 void Panel::doRefresh () {
-	std::list<Widget *>::iterator i, end;
+	std::vector<Widget *>::iterator i, end;
 	Widget *widget;
 
+	// Children with clean layouts keep the size measured by their last refresh, so their subtrees are skipped
 	SDL_LockMutex (widgetListMutex);
 	i = widgetList.begin ();
 	end = widgetList.end ();
 	while (i != end) {
 		widget = *i;
 		++i;
-		if (widget->isDestroyed) {
+		if (widget->isDestroyed || (! widget->isRefreshNeeded ())) {
 			continue;
 		}
 		widget->refresh ();
@@ -987,7 +1196,7 @@ void Panel::doRefresh () {
 	while (i != end) {
 		widget = *i;
 		++i;
-		if (widget->isDestroyed) {
+		if (widget->isDestroyed || (! widget->isRefreshNeeded ())) {
 			continue;
 		}
 		widget->refresh ();
@@ -998,10 +1207,11 @@ void Panel::doRefresh () {
 }
 
 void Panel::resetSize () {
-	std::list<Widget *>::iterator i, end;
+	std::vector<Widget *>::iterator i, end;
 	Widget *widget;
 	float xmax, ymax, wx, wy;
 
+	isSizeDirty = false;
 	xmax = 0.0f;
 	ymax = 0.0f;
 
@@ -1048,13 +1258,38 @@ void Panel::resetSize () {
 	maxWidgetX = xmax;
 	maxWidgetY = ymax;
 	if (! isFixedSize) {
-		width = xmax + widthPadding;
-		height = ymax + heightPadding;
+		assignSize (xmax + widthPadding, ymax + heightPadding);
+	}
+}
+
+void Panel::extendSize (Widget *widget) {
+	float wx, wy;
+
+	// resetSize computes a plain maximum once both extents are positive, allowing a widget added at the end of widgetAddList to be merged without a rescan
+	if ((maxWidgetX <= 0.0f) || (maxWidgetY <= 0.0f)) {
+		resetSize ();
+		return;
+	}
+
+	isSizeDirty = true;
+	if (widget->isDestroyed || (! widget->isVisible) || widget->isPanelSizeClipEnabled) {
+		return;
+	}
+	wx = widget->position.x + widget->width;
+	wy = widget->position.y + widget->height;
+	if (wx > maxWidgetX) {
+		maxWidgetX = wx;
+	}
+	if (wy > maxWidgetY) {
+		maxWidgetY = wy;
+	}
+	if (! isFixedSize) {
+		assignSize (maxWidgetX + widthPadding, maxWidgetY + heightPadding);
 	}
 }
 
 void Panel::refreshLayout () {
-	std::list<Widget *>::iterator i, end;
+	std::vector<Widget *>::iterator i, end;
 	Widget *widget;
 	float x, y, maxw, maxh, margin;
 
@@ -1263,34 +1498,35 @@ void Panel::refreshLayout () {
 }
 
 void Panel::sortWidgetList () {
-	std::list<Widget *>::iterator i, end;
+	std::vector<Panel::ChildState>::iterator i, end;
+	Panel::ChildState state;
 	Widget *widget;
-	int minlevel, maxlevel;
+	int minlevel, maxlevel, count, index, pos;
 	bool sorted;
 
+	// zLevel values are read from childStates, which updateChildState refreshes on each update pass; a zLevel change made to an existing child takes effect on the following update
 	sorted = true;
 	minlevel = Widget::MinZLevel - 1;
 	maxlevel = Widget::MinZLevel - 1;
-	i = widgetList.begin ();
-	end = widgetList.end ();
+	i = childStates.begin ();
+	end = childStates.end ();
 	while (i != end) {
-		widget = *i;
 		if (minlevel < Widget::MinZLevel) {
-			minlevel = widget->zLevel;
+			minlevel = i->zLevel;
 		}
 		if (maxlevel < Widget::MinZLevel) {
-			maxlevel = widget->zLevel;
+			maxlevel = i->zLevel;
 		}
 
-		if (widget->zLevel < minlevel) {
+		if (i->zLevel < minlevel) {
 			sorted = false;
-			minlevel = widget->zLevel;
+			minlevel = i->zLevel;
 		}
-		if (widget->zLevel < maxlevel) {
+		if (i->zLevel < maxlevel) {
 			sorted = false;
 		}
-		if (widget->zLevel > maxlevel) {
-			maxlevel = widget->zLevel;
+		if (i->zLevel > maxlevel) {
+			maxlevel = i->zLevel;
 		}
 		++i;
 	}
@@ -1300,7 +1536,227 @@ void Panel::sortWidgetList () {
 		return;
 	}
 
-	widgetList.sort (Widget::compareZLevel);
+	// Widgets are appended in insertion order and zLevel values change rarely, so an insertion sort moves few items and preserves the order of widgets with equal zLevel
+	count = (int) childStates.size ();
+	for (index = 1; index < count; ++index) {
+		widget = widgetList[index];
+		state = childStates[index];
+		pos = index;
+		while ((pos > 0) && (state.zLevel < childStates[pos - 1].zLevel)) {
+			widgetList[pos] = widgetList[pos - 1];
+			childStates[pos] = childStates[pos - 1];
+			--pos;
+		}
+		widgetList[pos] = widget;
+		childStates[pos] = state;
+	}
+	isHitGridValid = false;
+}
+
+bool Panel::updateChildState (Panel::ChildState *state, Widget *widget, bool *isLayoutChanged) {
+	int flags;
+	bool changed;
+
+	flags = 0;
+	if ((! widget->isDestroyed) && widget->isVisible && widget->hasScreenPosition && (widget->width > 0.0f) && (widget->height > 0.0f)) {
+		flags |= Panel::ChildVisibleFlag;
+	}
+	if ((! widget->isDestroyed) && widget->isVisible && (! widget->isPanelSizeClipEnabled)) {
+		flags |= Panel::ChildLayoutFlag;
+	}
+	*isLayoutChanged = (state->widget != widget) || ((state->flags & Panel::ChildLayoutFlag) != (flags & Panel::ChildLayoutFlag)) || (state->zLevel != widget->zLevel) || (! FLOAT_EQUALS (state->width, widget->width)) || (! FLOAT_EQUALS (state->height, widget->height));
+	changed = *isLayoutChanged || (state->flags != flags) || (! FLOAT_EQUALS (state->screenX, widget->screenX)) || (! FLOAT_EQUALS (state->screenY, widget->screenY));
+	state->widget = widget;
+	state->zLevel = widget->zLevel;
+	state->screenX = widget->screenX;
+	state->screenY = widget->screenY;
+	state->width = widget->width;
+	state->height = widget->height;
+	state->flags = flags;
+
+	return (changed);
+}
+
+void Panel::updateHitGrid () {
+	std::vector<Panel::ChildState>::iterator j, jend;
+	Panel::ChildState *item;
+	float x1, y1, x2, y2, cellsize;
+	int count, pass, itemindex, col1, row1, col2, row2, col, row, cell;
+	bool found;
+
+	count = (int) childStates.size ();
+	if ((count < Panel::HitGridMinWidgetCount) || (count != (int) widgetList.size ())) {
+		isHitGridValid = false;
+		return;
+	}
+	if (isHitGridValid) {
+		return;
+	}
+
+	found = false;
+	x1 = 0.0f;
+	y1 = 0.0f;
+	x2 = 0.0f;
+	y2 = 0.0f;
+	j = childStates.begin ();
+	jend = childStates.end ();
+	while (j != jend) {
+		item = &(*j);
+		++j;
+		if (! (item->flags & Panel::ChildVisibleFlag)) {
+			continue;
+		}
+		if (! found) {
+			x1 = item->screenX;
+			y1 = item->screenY;
+			x2 = item->screenX + item->width;
+			y2 = item->screenY + item->height;
+			found = true;
+			continue;
+		}
+		if (item->screenX < x1) {
+			x1 = item->screenX;
+		}
+		if (item->screenY < y1) {
+			y1 = item->screenY;
+		}
+		if ((item->screenX + item->width) > x2) {
+			x2 = item->screenX + item->width;
+		}
+		if ((item->screenY + item->height) > y2) {
+			y2 = item->screenY + item->height;
+		}
+	}
+
+	// Input hit tests truncate widget extents to integer values, so each grid cell covers an extra unit on its edges
+	hitGridX = floorf (x1) - 1.0f;
+	hitGridY = floorf (y1) - 1.0f;
+	x2 = ceilf (x2) + 1.0f;
+	y2 = ceilf (y2) + 1.0f;
+	cellsize = sqrtf (((x2 - hitGridX) * (y2 - hitGridY)) / (float) count);
+	if (cellsize < Panel::HitGridMinCellSize) {
+		cellsize = Panel::HitGridMinCellSize;
+	}
+	hitGridColumnCount = (int) ceilf ((x2 - hitGridX) / cellsize);
+	hitGridRowCount = (int) ceilf ((y2 - hitGridY) / cellsize);
+	while ((hitGridColumnCount * hitGridRowCount) > Panel::HitGridMaxCellCount) {
+		cellsize *= 2.0f;
+		hitGridColumnCount = (int) ceilf ((x2 - hitGridX) / cellsize);
+		hitGridRowCount = (int) ceilf ((y2 - hitGridY) / cellsize);
+	}
+	if (hitGridColumnCount < 1) {
+		hitGridColumnCount = 1;
+	}
+	if (hitGridRowCount < 1) {
+		hitGridRowCount = 1;
+	}
+	hitGridCellWidth = cellsize;
+	hitGridCellHeight = cellsize;
+
+	// Count the items held by each cell, then convert counts to start offsets and fill each cell's item range in widget list order
+	hitGridCellStarts.assign ((hitGridColumnCount * hitGridRowCount) + 1, 0);
+	for (pass = 0; pass < 2; ++pass) {
+		if (pass == 1) {
+			for (cell = 1; cell < (int) hitGridCellStarts.size (); ++cell) {
+				hitGridCellStarts[cell] += hitGridCellStarts[cell - 1];
+			}
+			hitGridCellItems.assign (hitGridCellStarts.back (), 0);
+			for (cell = ((int) hitGridCellStarts.size ()) - 1; cell > 0; --cell) {
+				hitGridCellStarts[cell] = hitGridCellStarts[cell - 1];
+			}
+			hitGridCellStarts[0] = 0;
+		}
+
+		for (itemindex = 0; itemindex < count; ++itemindex) {
+			item = &(childStates[itemindex]);
+			if (! (item->flags & Panel::ChildVisibleFlag)) {
+				continue;
+			}
+			col1 = (int) ((item->screenX - 1.0f - hitGridX) / hitGridCellWidth);
+			row1 = (int) ((item->screenY - 1.0f - hitGridY) / hitGridCellHeight);
+			col2 = (int) ((item->screenX + item->width + 1.0f - hitGridX) / hitGridCellWidth);
+			row2 = (int) ((item->screenY + item->height + 1.0f - hitGridY) / hitGridCellHeight);
+			col1 = (col1 < 0) ? 0 : col1;
+			row1 = (row1 < 0) ? 0 : row1;
+			col2 = (col2 >= hitGridColumnCount) ? (hitGridColumnCount - 1) : col2;
+			row2 = (row2 >= hitGridRowCount) ? (hitGridRowCount - 1) : row2;
+			for (row = row1; row <= row2; ++row) {
+				for (col = col1; col <= col2; ++col) {
+					cell = (row * hitGridColumnCount) + col;
+					if (pass == 0) {
+						++(hitGridCellStarts[cell + 1]);
+					}
+					else {
+						hitGridCellItems[hitGridCellStarts[cell + 1]] = itemindex;
+						++(hitGridCellStarts[cell + 1]);
+					}
+				}
+			}
+		}
+	}
+	isHitGridValid = true;
+}
+
+bool Panel::isHitTarget (Widget *widget, float screenPositionX, float screenPositionY, bool isInputTarget) {
+	if (widget->isDestroyed || (! widget->isVisible) || (! widget->hasScreenPosition)) {
+		return (false);
+	}
+	if ((widget->width <= 0.0f) || (widget->height <= 0.0f)) {
+		return (false);
+	}
+	if (isInputTarget) {
+		if (widget->isInputSuspended) {
+			return (false);
+		}
+		return ((screenPositionX >= (int) widget->screenX) && (screenPositionX <= (int) (widget->screenX + widget->width)) && (screenPositionY >= (int) widget->screenY) && (screenPositionY <= (int) (widget->screenY + widget->height)));
+	}
+	return ((screenPositionX >= widget->screenX) && (screenPositionX <= (widget->screenX + widget->width)) && (screenPositionY >= widget->screenY) && (screenPositionY <= (widget->screenY + widget->height)));
+}
+
+Widget *Panel::findHitWidget (float screenPositionX, float screenPositionY, bool isInputTarget) {
+	std::vector<Widget *>::reverse_iterator i, end;
+	Widget *widget;
+	Panel::ChildState *state;
+	int col, row, cell, index, start;
+
+	if (! isHitGridValid) {
+		i = widgetList.rbegin ();
+		end = widgetList.rend ();
+		while (i != end) {
+			widget = *i;
+			++i;
+			if (Panel::isHitTarget (widget, screenPositionX, screenPositionY, isInputTarget)) {
+				return (widget);
+			}
+		}
+		return (NULL);
+	}
+
+	if ((screenPositionX < hitGridX) || (screenPositionY < hitGridY)) {
+		return (NULL);
+	}
+	col = (int) ((screenPositionX - hitGridX) / hitGridCellWidth);
+	row = (int) ((screenPositionY - hitGridY) / hitGridCellHeight);
+	if ((col >= hitGridColumnCount) || (row >= hitGridRowCount)) {
+		return (NULL);
+	}
+
+	// Cell items are stored in widget list order, so a reverse scan finds the topmost widget first
+	cell = (row * hitGridColumnCount) + col;
+	start = hitGridCellStarts[cell];
+	index = hitGridCellStarts[cell + 1];
+	while (index > start) {
+		--index;
+		state = &(childStates[hitGridCellItems[index]]);
+		if ((screenPositionX < (state->screenX - 1.0f)) || (screenPositionX > (state->screenX + state->width)) || (screenPositionY < (state->screenY - 1.0f)) || (screenPositionY > (state->screenY + state->height))) {
+			continue;
+		}
+		widget = state->widget;
+		if (Panel::isHitTarget (widget, screenPositionX, screenPositionY, isInputTarget)) {
+			return (widget);
+		}
+	}
+	return (NULL);
 }
 
 void Panel::setLayout (int layoutType, float maxPanelWidth) {
@@ -1327,7 +1783,7 @@ void Panel::setCornerRadius (int radius) {
 }
 
 void Panel::setCornerRadius (int topLeftRadius, int topRightRadius, int bottomLeftRadius, int bottomRightRadius) {
-	int centerx, centery, centerw, centerh, topx, topy, topw, toph, leftx, lefty, leftw, lefth, rightx, righty, rightw, righth, bottomx, bottomy, bottomw, bottomh, amt;
+	int amt;
 
 	if (topLeftRadius < 0) {
 		topLeftRadius = 0;
@@ -1358,138 +1814,6 @@ void Panel::setCornerRadius (int topLeftRadius, int topRightRadius, int bottomLe
 		return;
 	}
 
-	centerx = 0;
-	centery = 0;
-	centerw = 0;
-	centerh = 0;
-	topx = 0;
-	topy = 0;
-	topw = 0;
-	toph = 0;
-	leftx = 0;
-	lefty = 0;
-	leftw = 0;
-	lefth = 0;
-	rightx = 0;
-	righty = 0;
-	rightw = 0;
-	righth = 0;
-	bottomx = 0;
-	bottomy = 0;
-	bottomw = 0;
-	bottomh = 0;
-
-	if ((topLeftRadius > 0) || (topRightRadius > 0)) {
-		amt = (topLeftRadius > topRightRadius) ? topLeftRadius : topRightRadius;
-		centery += amt;
-		centerh -= amt;
-		toph = amt;
-		if (topLeftRadius > 0) {
-			topx = topLeftRadius;
-			topw -= topLeftRadius;
-		}
-		if (topRightRadius > 0) {
-			topw -= topRightRadius;
-		}
-	}
-	if ((topLeftRadius > 0) || (bottomLeftRadius > 0)) {
-		amt = (topLeftRadius > bottomLeftRadius) ? topLeftRadius : bottomLeftRadius;
-		centerx += amt;
-		centerw -= amt;
-		leftw = amt;
-		if (topLeftRadius > 0) {
-			lefty = topLeftRadius;
-			lefth -= topLeftRadius;
-		}
-		if (bottomLeftRadius > 0) {
-			lefth -= bottomLeftRadius;
-		}
-	}
-	if ((topRightRadius > 0) || (bottomRightRadius > 0)) {
-		amt = (topRightRadius > bottomRightRadius) ? topRightRadius : bottomRightRadius;
-		centerw -= amt;
-		rightx -= amt;
-		rightw = amt;
-		if (topRightRadius > 0) {
-			righty = topRightRadius;
-			righth -= topRightRadius;
-		}
-		if (bottomRightRadius > 0) {
-			righth -= bottomRightRadius;
-		}
-	}
-	if ((bottomLeftRadius > 0) || (bottomRightRadius > 0)) {
-		amt = (bottomLeftRadius > bottomRightRadius) ? bottomLeftRadius : bottomRightRadius;
-		centerh -= amt;
-		bottomy -= amt;
-		bottomh = amt;
-		if (bottomLeftRadius > 0) {
-			bottomx = bottomLeftRadius;
-			bottomw -= bottomLeftRadius;
-		}
-		if (bottomRightRadius > 0) {
-			bottomw -= bottomRightRadius;
-		}
-	}
-
-	if ((topLeftRadius <= 0) && (leftw > 0) && (toph > 0)) {
-		if (topRightRadius > 0) {
-			lefty += topRightRadius;
-			lefth -= topRightRadius;
-		}
-		else if (bottomLeftRadius > 0) {
-			topx += bottomLeftRadius;
-			topw -= bottomLeftRadius;
-		}
-	}
-	if ((topRightRadius <= 0) && (rightw > 0) && (toph > 0)) {
-		if (topLeftRadius > 0) {
-			righty += topLeftRadius;
-			righth -= topLeftRadius;
-		}
-		else if (bottomRightRadius > 0) {
-			topw -= bottomRightRadius;
-		}
-	}
-	if ((bottomLeftRadius <= 0) && (leftw > 0) && (bottomh > 0)) {
-		if (topLeftRadius > 0) {
-			bottomx += topLeftRadius;
-			bottomw -= topLeftRadius;
-		}
-		else if (bottomRightRadius > 0) {
-			lefth -= bottomRightRadius;
-		}
-	}
-	if ((bottomRightRadius <= 0) && (rightw > 0) && (bottomh > 0)) {
-		if (topRightRadius > 0) {
-			bottomw -= topRightRadius;
-		}
-		else if (bottomLeftRadius > 0) {
-			righty += bottomLeftRadius;
-			righth -= bottomLeftRadius;
-		}
-	}
-
-	cornerCenterDx = centerx;
-	cornerCenterDy = centery;
-	cornerCenterDw = centerw;
-	cornerCenterDh = centerh;
-	cornerTopDx = topx;
-	cornerTopDy = topy;
-	cornerTopDw = topw;
-	cornerTopDh = toph;
-	cornerLeftDx = leftx;
-	cornerLeftDy = lefty;
-	cornerLeftDw = leftw;
-	cornerLeftDh = lefth;
-	cornerRightDx = rightx;
-	cornerRightDy = righty;
-	cornerRightDw = rightw;
-	cornerRightDh = righth;
-	cornerBottomDx = bottomx;
-	cornerBottomDy = bottomy;
-	cornerBottomDw = bottomw;
-	cornerBottomDh = bottomh;
 	topLeftCornerRadius = topLeftRadius;
 	topRightCornerRadius = topRightRadius;
 	bottomLeftCornerRadius = bottomLeftRadius;
@@ -1578,8 +1902,7 @@ void Panel::setPadding (float widthPaddingSize, float heightPaddingSize) {
 void Panel::setFixedSize (bool enable, float fixedWidth, float fixedHeight) {
 	if (enable) {
 		isFixedSize = true;
-		width = fixedWidth;
-		height = fixedHeight;
+		assignSize (fixedWidth, fixedHeight);
 	}
 	else {
 		isFixedSize = false;
@@ -33,13 +33,14 @@
 #define PANEL_H
 
 #include <stdint.h>
-#include <list>
+#include <vector>
 #include "SDL2/SDL.h"
 #include "StdString.h"
 #include "StringList.h"
 #include "Color.h"
 #include "Position.h"
 #include "WidgetHandle.h"
+#include "DrawList.h"
 #include "Widget.h"
 
 class Panel : public Widget {
@@ -48,6 +49,9 @@ public:
 	virtual ~Panel ();
 
 	static const int LongPressDuration; // ms
+	static const int HitGridMinWidgetCount; // Minimum number of child widgets required to index widget positions in a hit grid
+	static const float HitGridMinCellSize;
+	static const int HitGridMaxCellCount;
 
 	// Layout types
 	enum {
@@ -153,15 +157,54 @@ public:
 	// Update widget state to reflect the latest input events
 	void processInput ();
 
+	// Superclass override methods
+	bool isDrawVisible (const SDL_Rect &clipRect, float originX, float originY);
+
 	// Reset the panel's draw texture as appropriate for a new enable state
 	static void resetDrawTexture (void *panelPtr);
 
 protected:
+	// Child state flags
+	enum {
+		ChildVisibleFlag = 0x1,
+		ChildLayoutFlag = 0x2
+	};
+	struct ChildState {
+		Widget *widget;
+		float screenX, screenY;
+		float width, height;
+		int zLevel;
+		int flags;
+		ChildState ():
+			widget (NULL),
+			screenX (0.0f),
+			screenY (0.0f),
+			width (0.0f),
+			height (0.0f),
+			zLevel (0),
+			flags (0) { }
+	};
+
 	// Execute operations to update object state as appropriate for an elapsed millisecond time period
 	virtual void doUpdate (int msElapsed);
 
-	// Add subclass-specific draw commands for execution by the App. If targetTexture is non-NULL, it has been set as the render target and draw commands should adjust coordinates as appropriate.
-	virtual void doDraw (SDL_Texture *targetTexture, float originX, float originY);
+	// Add subclass-specific draw commands to drawList. If the list holds a non-NULL targetTexture, draw commands render to that texture and should adjust coordinates as appropriate.
+	virtual void doDraw (DrawList *drawList, float originX, float originY);
+
+	// Return a hash of all values that affect commands added by doDraw with the specified clip rectangle and origin position, or zero if the widget's draw commands should not be retained for replay
+	virtual uint64_t getDrawKey (DrawList *drawList, const SDL_Rect &clipRect, float originX, float originY);
+
+	// Return the draw key for commands that draw the panel from drawTexture. contentKey holds the content draw key that the texture was rendered from, if any.
+	uint64_t getTextureDrawKey (float originX, float originY, uint64_t contentKey);
+
+	// Return the draw key for commands that draw the panel's background and child widgets directly
+	uint64_t getContentDrawKey (DrawList *drawList, const SDL_Rect &clipRect, float originX, float originY);
+
+	// Update the automatic texture cache for a draw with the specified content key, enabling texture render if the content has been unchanged for App::panelTextureCacheFrames and evicting the texture if the content has changed. This method must only be invoked by doUpdate while holding a lock on widgetListMutex.
+	void updateTextureCache (uint64_t contentKey);
+
+	// Clear automatic texture cache state and release its reserved texture memory, leaving isTextureRenderEnabled unchanged
+	void releaseTextureCache ();
 
 	// Execute subclass-specific operations to refresh the widget's layout as appropriate for the current set of UiConfiguration values
 	virtual void doRefresh ();
@@ -178,34 +221,68 @@ protected:
 	// Reset the panel's w and h values as appropriate for its content and configuration
 	void resetSize ();
 
+	// Extend the panel's w and h values to include a newly added widget without scanning other child widgets, and schedule a full resetSize for the panel's next update
+	void extendSize (Widget *widget);
+
 	// Reset the panel's widget layout as appropriate for its content and configuration
 	virtual void refreshLayout ();
 
-	// Check if the widget list is correctly sorted for drawing by z-level, and sort the list if not. This method must only be invoked while holding a lock on widgetListMutex.
+	// Check if the widget list is correctly sorted for drawing by the z-level values held in childStates, and apply a stable insertion sort to both lists if not. This method must only be invoked while holding a lock on widgetListMutex.
 	void sortWidgetList ();
 
+	// Copy fields from widget into state and return a boolean value indicating if any hit test fields changed. isLayoutChanged is set to indicate if any of the widget's layout inputs changed, including its size, visibility, and z-level.
+	static bool updateChildState (Panel::ChildState *state, Widget *widget, bool *isLayoutChanged);
+
+	// Rebuild the hit grid from childStates if it was invalidated by a change to child widgets. This method must only be invoked while holding a lock on widgetListMutex.
+	void updateHitGrid ();
+
+	// Update child widgets with key events and mouse state generated by processInput from a consecutive group of input events. Key events consumed by a widget are removed from keyEvents.
+	void processInputStep (std::vector<SDL_Keycode> *keyEvents, const Widget::MouseState &mouseState);
+
+	// Return the topmost child widget with screen extents containing the specified position, or NULL if no such widget was found. If isInputTarget is true, match only widgets that accept input, using integer screen extents. This method must only be invoked while holding a lock on widgetListMutex.
+	Widget *findHitWidget (float screenPositionX, float screenPositionY, bool isInputTarget);
+
+	// Return a boolean value indicating if the specified widget is a hit target at a screen position
+	static bool isHitTarget (Widget *widget, float screenPositionX, float screenPositionY, bool isInputTarget);
+
 	SDL_Texture *drawTexture;
 	int drawTextureWidth, drawTextureHeight;
-	StdString drawTexturePath;
+	uint64_t drawTextureId;
 	bool isResettingDrawTexture;
-	bool isMouseInputStarted;
-	int lastMouseLeftUpCount, lastMouseLeftDownCount;
-	int lastMouseRightUpCount, lastMouseRightDownCount;
-	int lastMouseWheelUpCount, lastMouseWheelDownCount;
+	int64_t inputResetTime; // Input events received before this monotonic clock value are discarded by processInput
+	bool isInputLeftDown;
+	int lastMouseX, lastMouseY;
 	int lastMouseDownX, lastMouseDownY;
 	int64_t lastMouseDownTime;
-	int cornerCenterDx, cornerCenterDy, cornerCenterDw, cornerCenterDh;
-	int cornerTopDx, cornerTopDy, cornerTopDw, cornerTopDh;
-	int cornerLeftDx, cornerLeftDy, cornerLeftDw, cornerLeftDh;
-	int cornerRightDx, cornerRightDy, cornerRightDw, cornerRightDh;
-	int cornerBottomDx, cornerBottomDy, cornerBottomDw, cornerBottomDh;
 	int cornerSize;
+	bool isSizeDirty;
+
+	// Automatic texture cache state. isTextureCached indicates that isTextureRenderEnabled was set by the caching policy, and isTextureCacheReady that drawTexture holds content rendered for textureCacheKey. These fields are changed only while holding a lock on widgetListMutex, by doUpdate or by a pending resetDrawTexture task.
+	bool isTextureCached;
+	bool isTextureCacheReady;
+	bool isTextureCacheDrawn;
+	uint64_t textureCacheKey;
+	int textureCacheBytes;
+	uint64_t lastDrawKey;
+	int cleanDrawCount;
+	uint64_t contentDrawKey; // The content key computed by the last getDrawKey call, for use by the texture cache decision in doUpdate
+	int64_t contentDrawKeySequence;
+	int64_t textureCacheSequence; // The contentDrawKeySequence value last applied to the texture cache
 	SDL_mutex *widgetListMutex;
-	std::list<Widget *> widgetList;
+	std::vector<Widget *> widgetList;
 	SDL_mutex *widgetAddListMutex;
-	std::list<Widget *> widgetAddList;
+	std::vector<Widget *> widgetAddList;
 	WidgetHandle waitPanel;
 	WidgetHandle waitProgressBar;
+
+	// Packed copies of child widget fields, stored in widgetList order and refreshed as each child is updated. Child state and hit grid data members are accessed only while holding a lock on widgetListMutex.
+	std::vector<Panel::ChildState> childStates;
+	bool isHitGridValid;
+	std::vector<int> hitGridCellStarts;
+	std::vector<int> hitGridCellItems;
+	float hitGridX, hitGridY;
+	float hitGridCellWidth, hitGridCellHeight;
+	int hitGridColumnCount, hitGridRowCount;
 };
 
 #endif
@@ -0,0 +1,177 @@
+/*
+* Copyright 2018-2022 Membrane Software <author@membranesoftware.com> https://membranesoftware.com
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+* this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+* this list of conditions and the following disclaimer in the documentation
+* and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors
+* may be used to endorse or promote products derived from this software without
+* specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "Config.h"
+#include <stdlib.h>
+#include <stdint.h>
+#include <vector>
+#include "StdString.h"
+#include "App.h"
+#include "OsUtil.h"
+#include "Input.h"
+#include "Resource.h"
+#include "Network.h"
+#include "TaskGroup.h"
+#include "FrameProfiler.h"
+#include "DurationSampler.h"
+#include "UiConfiguration.h"
+#include "Widget.h"
+#include "Panel.h"
+#include "Label.h"
+#include "StatsWindow.h"
+#include "BarGraph.h"
+#include "PerformanceWindow.h"
+
+const int PerformanceWindow::UpdatePeriod = 500;
+const int64_t PerformanceWindow::HistogramBucketDuration = 2000000;
+
+PerformanceWindow::PerformanceWindow ()
+: Panel ()
+, statsWindow (NULL)
+, histogramLabel (NULL)
+, histogramGraph (NULL)
+, updateClock (0)
+, lastSampleTime (0)
+, lastDrawCount (0)
+, lastUpdateCount (0)
+{
+	setFillBg (true, UiConfiguration::instance->lightBackgroundColor);
+	setBorder (true, UiConfiguration::instance->darkBackgroundColor);
+	setPadding (UiConfiguration::instance->paddingSize, UiConfiguration::instance->paddingSize);
+
+	histogramCounts.resize (PerformanceWindow::HistogramBucketCount, 0);
+
+	statsWindow = (StatsWindow *) addWidget (new StatsWindow ());
+	statsWindow->isValueChangeHighlighted = false;
+
+	histogramLabel = (Label *) addWidget (new Label (StdString::createSprintf ("Frame time, 0-%ims", (int) ((PerformanceWindow::HistogramBucketDuration * PerformanceWindow::HistogramBucketCount) / 1000000)), UiConfiguration::CaptionFont, UiConfiguration::instance->primaryTextColor));
+	histogramGraph = (BarGraph *) addWidget (new BarGraph (PerformanceWindow::HistogramBucketCount));
+
+	lastSampleTime = OsUtil::getMonotonicTime ();
+	lastDrawCount = App::instance->drawCount;
+	lastUpdateCount = App::instance->updateCount;
+	updateMetrics ();
+}
+
+PerformanceWindow::~PerformanceWindow () {
+
+}
+
+StdString PerformanceWindow::toStringDetail () {
+	return (StdString (" PerformanceWindow"));
+}
+
+void PerformanceWindow::doUpdate (int msElapsed) {
+	Panel::doUpdate (msElapsed);
+	updateClock -= msElapsed;
+	if (updateClock <= 0) {
+		updateClock = PerformanceWindow::UpdatePeriod;
+		updateMetrics ();
+	}
+}
+
+void PerformanceWindow::updateMetrics () {
+	App *app;
+	DurationSampler::Percentiles percentiles;
+	Resource::TextureMemoryStats texturestats;
+	Input::LatencyStats latencystats;
+	int64_t now, drawcount, updatecount;
+	double seconds;
+
+	app = App::instance;
+	now = OsUtil::getMonotonicTime ();
+	seconds = ((double) (now - lastSampleTime)) / 1000000000.0f;
+	drawcount = app->drawCount;
+	updatecount = app->updateCount;
+	if (seconds > 0.0f) {
+		valueText.sprintf ("%.1f", ((double) (drawcount - lastDrawCount)) / seconds);
+		statsWindow->setItem (StdString ("FPS"), valueText);
+		valueText.sprintf ("%.1f/s", ((double) (updatecount - lastUpdateCount)) / seconds);
+		statsWindow->setItem (StdString ("Update rate"), valueText);
+	}
+	lastSampleTime = now;
+	lastDrawCount = drawcount;
+	lastUpdateCount = updatecount;
+
+	percentiles = app->frameProfiler.getPercentiles (-1);
+	valueText.sprintf ("p50 %.1fms, p95 %.1fms, p99 %.1fms", ((double) percentiles.p50) / 1000000.0f, ((double) percentiles.p95) / 1000000.0f, ((double) percentiles.p99) / 1000000.0f);
+	statsWindow->setItem (StdString ("Frame time"), valueText);
+
+	percentiles = app->updateProfiler.getPercentiles (-1);
+	valueText.sprintf ("p50 %.1fms, p95 %.1fms, p99 %.1fms", ((double) percentiles.p50) / 1000000.0f, ((double) percentiles.p95) / 1000000.0f, ((double) percentiles.p99) / 1000000.0f);
+	statsWindow->setItem (StdString ("Update time"), valueText);
+
+	valueText.sprintf ("%i (%i drawn, %i cached)", app->lastDrawnWidgetCount + app->lastCulledWidgetCount, app->lastDrawnWidgetCount, app->lastCachedWidgetCount);
+	statsWindow->setItem (StdString ("Widgets"), valueText);
+
+	texturestats = app->resource.getTextureMemoryStats ();
+	valueText.sprintf ("%i (%.1fMB)", texturestats.textureCount, ((double) texturestats.textureBytes) / 1048576.0f);
+	statsWindow->setItem (StdString ("Textures"), valueText);
+
+	valueText.sprintf ("%i", app->network.getHttpRequestCount ());
+	statsWindow->setItem (StdString ("HTTP requests"), valueText);
+
+	valueText.sprintf ("%i", app->taskGroup.getTaskCount ());
+	statsWindow->setItem (StdString ("Tasks"), valueText);
+
+	latencystats = app->input.getLatencyStats ();
+	valueText.sprintf ("p50 %.1fms, p99 %.1fms", ((double) latencystats.present.p50) / 1000000.0f, ((double) latencystats.present.p99) / 1000000.0f);
+	statsWindow->setItem (StdString ("Input latency"), valueText);
+
+	app->frameProfiler.getHistogram (-1, PerformanceWindow::HistogramBucketDuration, &histogramCounts);
+	histogramGraph->setValues (histogramCounts);
+
+	refreshLayout ();
+}
+
+void PerformanceWindow::doRefresh () {
+	setPadding (UiConfiguration::instance->paddingSize, UiConfiguration::instance->paddingSize);
+	Panel::doRefresh ();
+}
+
+void PerformanceWindow::refreshLayout () {
+	float x, y, w;
+
+	x = widthPadding;
+	y = heightPadding;
+	statsWindow->position.assign (x, y);
+	y += statsWindow->height + UiConfiguration::instance->marginSize;
+
+	histogramLabel->position.assign (x + UiConfiguration::instance->paddingSize, histogramLabel->getLinePosition (y));
+	y += histogramLabel->maxLineHeight + UiConfiguration::instance->textLineHeightMargin;
+
+	w = statsWindow->width - (UiConfiguration::instance->paddingSize * 2.0f);
+	if (w < histogramLabel->width) {
+		w = histogramLabel->width;
+	}
+	histogramGraph->setSize (w, UiConfiguration::instance->paddingSize * 4.0f);
+	histogramGraph->position.assign (x + UiConfiguration::instance->paddingSize, y);
+
+	resetSize ();
+}
@@ -30,7 +30,7 @@
 #include "Config.h"
 #include <stdlib.h>
 #include <math.h>
-#include <queue>
+#include "Animator.h"
 #include "Position.h"
 
 Position::Position (float x, float y)
@@ -39,79 +39,46 @@ Position::Position (float x, float y)
 , isTranslating (false)
 , translateTargetX (0.0f)
 , translateTargetY (0.0f)
-, translateDx (0.0f)
-, translateDy (0.0f)
 , translateDuration (0)
-, translateClock (0)
+, translateEasing (Animator::LinearEasing)
+, tweenIndex (-1)
 {
 }
 
-Position::~Position () {
-
+Position::Position (const Position &copySource)
+: x (copySource.x)
+, y (copySource.y)
+, isTranslating (false)
+, translateTargetX (0.0f)
+, translateTargetY (0.0f)
+, translateDuration (0)
+, translateEasing (copySource.translateEasing)
+, tweenIndex (-1)
+{
 }
 
-void Position::update (int msElapsed) {
-	Position::Translation t;
-	float dx, dy;
-	int ms, dt;
-
-	ms = msElapsed;
-	while (isTranslating && (ms > 0)) {
-		dt = ms;
-		if (dt > translateClock) {
-			dt = translateClock;
-		}
-		translateClock -= dt;
-		ms -= dt;
-
-		dx = translateDx * (float) dt;
-		x += dx;
-		if (translateDx < 0.0f) {
-			if (x < translateTargetX) {
-				x = translateTargetX;
-			}
-		}
-		else {
-			if (x > translateTargetX) {
-				x = translateTargetX;
-			}
-		}
-
-		dy = translateDy * (float) dt;
-		y += dy;
-		if (translateDy < 0.0f) {
-			if (y < translateTargetY) {
-				y = translateTargetY;
-			}
-		}
-		else {
-			if (y > translateTargetY) {
-				y = translateTargetY;
-			}
-		}
+Position::~Position () {
+	if ((tweenIndex >= 0) && Animator::instance) {
+		Animator::instance->cancelPosition (this);
+	}
+}
 
-		if (translateClock <= 0) {
-			x = translateTargetX;
-			y = translateTargetY;
-			if (translationQueue.empty ()) {
-				isTranslating = false;
-			}
-			else {
-				t = translationQueue.front ();
-				translationQueue.pop ();
-				translate (x + t.deltaX, y + t.deltaY, t.duration);
-			}
-		}
+Position &Position::operator= (const Position &sourcePosition) {
+	// Copies take the source's current coordinates, but not its active tween
+	if (this != &sourcePosition) {
+		assign (sourcePosition.x, sourcePosition.y);
+		translateEasing = sourcePosition.translateEasing;
 	}
+	return (*this);
 }
 
 void Position::assign (float positionX, float positionY) {
+	if ((tweenIndex >= 0) && Animator::instance) {
+		Animator::instance->cancelPosition (this);
+	}
 	x = positionX;
 	y = positionY;
 	isTranslating = false;
-	while (! translationQueue.empty ()) {
-		translationQueue.pop ();
-	}
 }
 
 void Position::assign (const Position &otherPosition) {
@@ -158,28 +125,23 @@ void Position::move (float dx, float dy) {
 	assign (x + dx, y + dy);
 }
 
-void Position::translate (float targetX, float targetY, int durationMs) {
-	float dx, dy;
+void Position::setEasing (Animator::Easing easing) {
+	translateEasing = easing;
+}
 
-	if (durationMs <= 0) {
-		x = targetX;
-		y = targetY;
+void Position::translate (float targetX, float targetY, int durationMs) {
+	if ((durationMs <= 0) || (! Animator::instance)) {
+		assign (targetX, targetY);
 		translateTargetX = targetX;
 		translateTargetY = targetY;
 		translateDuration = 0;
-		translateClock = 0;
-		translateDx = 0.0f;
-		translateDy = 0.0f;
-		if (translationQueue.empty ()) {
-			isTranslating = false;
-		}
 		return;
 	}
 
-	dx = targetX - x;
-	dy = targetY - y;
-	if ((fabs (dx) <= CONFIG_FLOAT_EPSILON) && (fabs (dy) <= CONFIG_FLOAT_EPSILON) && translationQueue.empty ()) {
-		isTranslating = false;
+	if ((fabs (targetX - x) <= CONFIG_FLOAT_EPSILON) && (fabs (targetY - y) <= CONFIG_FLOAT_EPSILON)) {
+		if (isTranslating) {
+			assign (x, y);
+		}
 		return;
 	}
 
@@ -187,13 +149,10 @@ void Position::translate (float targetX, float targetY, int durationMs) {
 		return;
 	}
 
-	isTranslating = true;
 	translateTargetX = targetX;
 	translateTargetY = targetY;
 	translateDuration = durationMs;
-	translateClock = durationMs;
-	translateDx = dx / (float) durationMs;
-	translateDy = dy / (float) durationMs;
+	Animator::instance->translatePosition (this, targetX, targetY, durationMs, translateEasing);
 }
 
 void Position::translate (const Position &targetPosition, int durationMs) {
@@ -229,20 +188,12 @@ void Position::translateY (float startY, float targetY, int durationMs) {
 }
 
 void Position::plot (float deltaX, float deltaY, int durationMs) {
-	Position::Translation t;
-
-	if (! isTranslating) {
-		while (! translationQueue.empty ()) {
-			translationQueue.pop ();
+	if (isTranslating && Animator::instance) {
+		if (Animator::instance->plotPosition (this, deltaX, deltaY, durationMs)) {
+			return;
 		}
-		translate (x + deltaX, y + deltaY, durationMs);
-		return;
 	}
-
-	t.deltaX = deltaX;
-	t.deltaY = deltaY;
-	t.duration = durationMs;
-	translationQueue.push (t);
+	translate (x + deltaX, y + deltaY, durationMs);
 }
 
 void Position::plotX (float deltaX, int durationMs) {
@@ -32,23 +32,22 @@
 #ifndef POSITION_H
 #define POSITION_H
 
-#include <queue>
+#include "Animator.h"
 
 class Position {
 public:
 	Position (float x = 0.0f, float y = 0.0f);
+	Position (const Position &copySource);
 	~Position ();
+	Position &operator= (const Position &sourcePosition);
 
 	// Read-only data members
 	float x, y;
 	bool isTranslating;
 	float translateTargetX, translateTargetY;
-	float translateDx, translateDy;
 	int translateDuration;
-	int translateClock;
-
-	// Update state as appropriate for an elapsed millisecond time period
-	void update (int msElapsed);
+	Animator::Easing translateEasing;
+	int tweenIndex; // The index of the position's active tween in Animator storage, or -1 if no tween is active
 
 	// Set the position's coordinate values
 	void assign (float positionX, float positionY);
@@ -67,6 +66,9 @@ public:
 	// Change the position's coordinate values by adding the specified deltas
 	void move (float dx, float dy);
 
+	// Set the easing curve applied to translations begun after this call
+	void setEasing (Animator::Easing easing);
+
 	// Begin a translation operation using the provided parameters
 	void translate (float targetX, float targetY, int durationMs);
 	void translate (const Position &targetPosition, int durationMs);
@@ -93,17 +95,6 @@ public:
 	// Return a boolean value indicating if the position is equivalent to the provided one
 	bool equals (float positionX, float positionY) const;
 	bool equals (const Position &otherPosition) const;
-
-private:
-	struct Translation {
-		float deltaX, deltaY;
-		int duration;
-		Translation ():
-			deltaX (0.0f),
-			deltaY (0.0f),
-			duration (0) { }
-	};
-	std::queue<Position::Translation> translationQueue;
 };
 
 #endif
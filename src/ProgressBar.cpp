@@ -36,6 +36,7 @@
 #include "Ui.h"
 #include "Input.h"
 #include "Sprite.h"
+#include "DrawList.h"
 #include "Widget.h"
 #include "UiConfiguration.h"
 #include "ProgressBar.h"
@@ -67,8 +68,7 @@ void ProgressBar::setSize (float barWidth, float barHeight) {
 	if (FLOAT_EQUALS (width, barWidth) && FLOAT_EQUALS (height, barHeight)) {
 		return;
 	}
-	width = barWidth;
-	height = barHeight;
+	assignSize (barWidth, barHeight);
 	refreshLayout ();
 }
 
@@ -172,22 +172,33 @@ void ProgressBar::doUpdate (int msElapsed) {
 			}
 		}
 	}
+}
 
-	fillColor.update (msElapsed);
+uint64_t ProgressBar::getDrawKey (DrawList *drawList, const SDL_Rect &clipRect, float originX, float originY) {
+	uint64_t key;
+
+	key = DrawList::DrawKeyBasis;
+	key = DrawList::hashDrawKey (key, (int) (originX + position.x));
+	key = DrawList::hashDrawKey (key, (int) (originY + position.y));
+	key = DrawList::hashDrawKey (key, (int) width);
+	key = DrawList::hashDrawKey (key, (int) height);
+	key = DrawList::hashDrawKey (key, (bgColor.rByte << 16) | (bgColor.gByte << 8) | bgColor.bByte);
+	key = DrawList::hashDrawKey (key, (fillColor.rByte << 16) | (fillColor.gByte << 8) | fillColor.bByte);
+	key = DrawList::hashDrawKey (key, (int64_t) floorf (fillStart));
+	key = DrawList::hashDrawKey (key, (int64_t) floorf (fillEnd));
+
+	return (key);
 }
 
-void ProgressBar::doDraw (SDL_Texture *targetTexture, float originX, float originY) {
-	SDL_Renderer *render;
+void ProgressBar::doDraw (DrawList *drawList, float originX, float originY) {
 	SDL_Rect rect;
 	float x1, x2, w;
 
-	render = App::instance->render;
 	rect.x = (int) (originX + position.x);
 	rect.y = (int) (originY + position.y);
 	rect.w = (int) width;
 	rect.h = (int) height;
-	SDL_SetRenderDrawColor (render, bgColor.rByte, bgColor.gByte, bgColor.bByte, 255);
-	SDL_RenderFillRect (render, &rect);
+	drawList->fillRect (rect, bgColor.rByte, bgColor.gByte, bgColor.bByte);
 
 	x1 = floorf (fillStart);
 	x2 = floorf (fillEnd);
@@ -195,34 +206,28 @@ void ProgressBar::doDraw (SDL_Texture *targetTexture, float originX, float origi
 	if (w > 0.0f) {
 		rect.x = (int) (originX + position.x + x1);
 		rect.w = (int) w;
-		SDL_SetRenderDrawColor (render, fillColor.rByte, fillColor.gByte, fillColor.bByte, 255);
-		SDL_RenderFillRect (render, &rect);
+		drawList->fillRect (rect, fillColor.rByte, fillColor.gByte, fillColor.bByte);
 	}
 
-	SDL_SetRenderDrawBlendMode (render, SDL_BLENDMODE_BLEND);
-	SDL_SetRenderDrawColor (render, 0, 0, 0, 128);
 	rect.x = (int) (originX + position.x);
 	rect.y = (int) (originY + position.y);
 	rect.w = (int) width;
 	rect.h = 1;
-	SDL_RenderFillRect (render, &rect);
+	drawList->fillRect (rect, 0, 0, 0, 128, SDL_BLENDMODE_BLEND);
 	++(rect.y);
 	rect.w = 1;
 	rect.h = ((int) height) - 1;
-	SDL_RenderFillRect (render, &rect);
+	drawList->fillRect (rect, 0, 0, 0, 128, SDL_BLENDMODE_BLEND);
 	++(rect.x);
 	rect.y = (int) (originY + position.y) + ((int) height) - 1;
 	rect.w = ((int) width) - 1;
 	rect.h = 1;
-	SDL_RenderFillRect (render, &rect);
+	drawList->fillRect (rect, 0, 0, 0, 128, SDL_BLENDMODE_BLEND);
 	rect.x = (int) (originX + position.x) + ((int) width) - 1;
 	rect.y = (int) (originY + position.y + 1);
 	rect.w = 1;
 	rect.h = ((int) height) - 2;
-	SDL_RenderFillRect (render, &rect);
-	SDL_SetRenderDrawBlendMode (render, SDL_BLENDMODE_NONE);
-
-	SDL_SetRenderDrawColor (render, 0, 0, 0, 0);
+	drawList->fillRect (rect, 0, 0, 0, 128, SDL_BLENDMODE_BLEND);
 }
 
 void ProgressBar::refreshLayout () {
@@ -33,6 +33,7 @@
 #define PROGRESS_BAR_H
 
 #include "Color.h"
+#include "DrawList.h"
 #include "Widget.h"
 
 class ProgressBar : public Widget {
@@ -56,8 +57,11 @@ protected:
 	// Execute operations to update object state as appropriate for an elapsed millisecond time period
 	virtual void doUpdate (int msElapsed);
 
-	// Add subclass-specific draw commands for execution by the App. If targetTexture is non-NULL, it has been set as the render target and draw commands should adjust coordinates as appropriate.
-	virtual void doDraw (SDL_Texture *targetTexture, float originX, float originY);
+	// Add subclass-specific draw commands to drawList. If the list holds a non-NULL targetTexture, draw commands render to that texture and should adjust coordinates as appropriate.
+	virtual void doDraw (DrawList *drawList, float originX, float originY);
+
+	// Return a hash of all values that affect commands added by doDraw with the specified clip rectangle and origin position, or zero if the widget's draw commands should not be retained for replay
+	virtual uint64_t getDrawKey (DrawList *drawList, const SDL_Rect &clipRect, float originX, float originY);
 
 	// Execute subclass-specific operations to refresh the widget's layout as appropriate for the current set of UiConfiguration values
 	virtual void doRefresh ();
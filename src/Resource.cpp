@@ -29,13 +29,16 @@
 */
 #include "Config.h"
 #include <stdlib.h>
+#include <limits.h>
 #include <errno.h>
 #include <string.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <map>
+#include <unordered_map>
 #include <vector>
+#include <list>
 #include "SDL2/SDL.h"
 #include "SDL2/SDL_image.h"
 #include "ft2build.h"
@@ -45,26 +48,56 @@
 #include "OsUtil.h"
 #include "Log.h"
 #include "StdString.h"
+#include "TaskGroup.h"
+#include "Trace.h"
 #include "Resource.h"
 
 Resource *Resource::instance = NULL;
 
+const int Resource::DefaultMaxTextureUploadsPerFrame = 4;
+const int Resource::DefaultMaxTextureDecodeTasks = 2;
+const int64_t Resource::DefaultTextureMemoryBudget = (64 * 1024 * 1024);
+const uint64_t Resource::GeneratedResourceIdFlag = 0x8000000000000000ULL;
+
 Resource::Resource ()
-: dataPath ("")
+: maxTextureUploadsPerFrame (Resource::DefaultMaxTextureUploadsPerFrame)
+, maxTextureDecodeTasks (Resource::DefaultMaxTextureDecodeTasks)
+, textureMemoryBudget (Resource::DefaultTextureMemoryBudget)
+, dataPath ("")
 , freetype (NULL)
 , isBundleFile (false)
 , isOpen (false)
 , fileMapMutex (NULL)
-, textureMapMutex (NULL)
+, nextTextureCacheStamp (0)
+, compactFreedCount (0)
+, compactFreedBytes (0)
+, compactStatsMutex (NULL)
 , fontMapMutex (NULL)
+, textureUploadGeneration (0)
+, textureDecodeTaskCount (0)
+, textureUploadListMutex (NULL)
 {
+	int i;
+
 	fileMapMutex = SDL_CreateMutex ();
-	textureMapMutex = SDL_CreateMutex ();
+	for (i = 0; i < Resource::TextureMapStripeCount; ++i) {
+		textureMapStripes[i].mutex = SDL_CreateMutex ();
+	}
 	fontMapMutex = SDL_CreateMutex ();
+	textureUploadListMutex = SDL_CreateMutex ();
+	compactStatsMutex = SDL_CreateMutex ();
+
+	// The compact sequence starts at its maximum value, allowing all released items to be freed until the application begins recording draw lists
+	SDL_AtomicSet (&releaseSequence, 0);
+	SDL_AtomicSet (&compactSequence, INT_MAX);
+	SDL_AtomicSet (&compactPendingCount, 0);
 }
 
 Resource::~Resource () {
+	int i;
+
 	close ();
+	clearTextureUploadList ();
 	clearFontMap ();
 	clearFileMap ();
 	clearTextureMap ();
@@ -77,14 +110,24 @@ Resource::~Resource () {
 		SDL_DestroyMutex (fileMapMutex);
 		fileMapMutex = NULL;
 	}
-	if (textureMapMutex) {
-		SDL_DestroyMutex (textureMapMutex);
-		textureMapMutex = NULL;
+	for (i = 0; i < Resource::TextureMapStripeCount; ++i) {
+		if (textureMapStripes[i].mutex) {
+			SDL_DestroyMutex (textureMapStripes[i].mutex);
+			textureMapStripes[i].mutex = NULL;
+		}
+	}
+	if (textureUploadListMutex) {
+		SDL_DestroyMutex (textureUploadListMutex);
+		textureUploadListMutex = NULL;
+	}
+	if (compactStatsMutex) {
+		SDL_DestroyMutex (compactStatsMutex);
+		compactStatsMutex = NULL;
 	}
 }
 
 void Resource::clearFileMap () {
-	std::map<StdString, Resource::FileData>::iterator i, end;
+	std::unordered_map<uint64_t, Resource::FileData>::iterator i, end;
 
 	SDL_LockMutex (fileMapMutex);
 	i = fileMap.begin ();
@@ -97,28 +140,40 @@ void Resource::clearFileMap () {
 		++i;
 	}
 	fileMap.clear ();
+	SDL_AtomicAdd (&compactPendingCount, -((int) fileCompactList.size ()));
+	fileCompactList.clear ();
 	SDL_UnlockMutex (fileMapMutex);
 }
 
 void Resource::clearTextureMap () {
-	std::map<StdString, Resource::TextureData>::iterator i, end;
-
-	SDL_LockMutex (textureMapMutex);
-	i = textureMap.begin ();
-	end = textureMap.end ();
-	while (i != end) {
-		if (i->second.texture) {
-			SDL_DestroyTexture (i->second.texture);
-			i->second.texture = NULL;
+	std::unordered_map<uint64_t, Resource::TextureData>::iterator i, end;
+	Resource::TextureMapStripe *stripe;
+	int j;
+
+	for (j = 0; j < Resource::TextureMapStripeCount; ++j) {
+		stripe = &(textureMapStripes[j]);
+		SDL_LockMutex (stripe->mutex);
+		i = stripe->textureMap.begin ();
+		end = stripe->textureMap.end ();
+		while (i != end) {
+			if (i->second.texture) {
+				SDL_DestroyTexture (i->second.texture);
+				i->second.texture = NULL;
+			}
+			++i;
 		}
-		++i;
+		stripe->textureMap.clear ();
+		SDL_AtomicAdd (&compactPendingCount, -((int) stripe->compactList.size ()));
+		stripe->compactList.clear ();
+		stripe->byteCount = 0;
+		SDL_UnlockMutex (stripe->mutex);
 	}
-	textureMap.clear ();
-	SDL_UnlockMutex (textureMapMutex);
+	textureCacheList.clear ();
 }
 
 void Resource::clearFontMap () {
-	std::map<StdString, Resource::FontData>::iterator i, end;
+	std::unordered_map<uint64_t, Resource::FontData>::iterator i, end;
+	std::unordered_map<uint64_t, Resource::FontFaceData>::iterator fi, fend;
 
 	SDL_LockMutex (fontMapMutex);
 	i = fontMap.begin ();
@@ -131,9 +186,56 @@ void Resource::clearFontMap () {
 		++i;
 	}
 	fontMap.clear ();
+	SDL_AtomicAdd (&compactPendingCount, -((int) fontCompactList.size ()));
+	fontCompactList.clear ();
+
+	fi = fontFaceMap.begin ();
+	fend = fontFaceMap.end ();
+	while (fi != fend) {
+		FT_Done_Face (fi->second.face);
+		SDL_DestroyMutex (fi->second.mutex);
+		++fi;
+	}
+	fontFaceMap.clear ();
+	SDL_AtomicAdd (&compactPendingCount, -((int) fontFaceCompactList.size ()));
+	fontFaceCompactList.clear ();
 	SDL_UnlockMutex (fontMapMutex);
 }
 
+void Resource::clearTextureUploadList () {
+	std::list<Resource::TextureLoadRequest *>::iterator i, end;
+
+	SDL_LockMutex (textureUploadListMutex);
+	i = textureUploadList.begin ();
+	end = textureUploadList.end ();
+	while (i != end) {
+		Resource::freeTextureLoadRequest (*i);
+		++i;
+	}
+	textureUploadList.clear ();
+
+	i = textureDecodeQueue.begin ();
+	end = textureDecodeQueue.end ();
+	while (i != end) {
+		Resource::freeTextureLoadRequest (*i);
+		++i;
+	}
+	textureDecodeQueue.clear ();
+
+	// Requests still held by decodeTextures tasks are freed by those tasks once they observe the generation change
+	textureDecodeList.clear ();
+	++textureUploadGeneration;
+	SDL_UnlockMutex (textureUploadListMutex);
+}
+
+void Resource::freeTextureLoadRequest (Resource::TextureLoadRequest *request) {
+	if (request->surface) {
+		SDL_FreeSurface (request->surface);
+		request->surface = NULL;
+	}
+	delete (request);
+}
+
 void Resource::setSource (const StdString &path) {
 	dataPath.assign (path);
 	isBundleFile = (dataPath.find (".dat") == (dataPath.length () - 4));
@@ -205,6 +307,7 @@ void Resource::close () {
 	if (! isOpen) {
 		return;
 	}
+	clearTextureUploadList ();
 	clearFileMap ();
 	clearTextureMap ();
 	clearFontMap ();
@@ -215,19 +318,90 @@ void Resource::close () {
 	isOpen = false;
 }
 
-void Resource::compact () {
-	compactFontMap ();
-	compactFileMap ();
-	compactTextureMap ();
+void Resource::compact (int64_t maxDuration) {
+	Uint64 start, deadline;
+
+	if (! isCompactPending ()) {
+		return;
+	}
+	start = SDL_GetPerformanceCounter ();
+	deadline = 0;
+	if (maxDuration > 0) {
+		deadline = start + (Uint64) ((maxDuration * (int64_t) SDL_GetPerformanceFrequency ()) / 1000000);
+		if (deadline == 0) {
+			deadline = 1;
+		}
+	}
+
+	compactFreedCount = 0;
+	compactFreedBytes = 0;
+	if (compactFontMap (deadline)) {
+		if (compactFileMap (deadline)) {
+			compactTextureMap (deadline);
+		}
+	}
+
+	SDL_LockMutex (compactStatsMutex);
+	++(compactStats.passCount);
+	compactStats.lastFreedCount = compactFreedCount;
+	compactStats.lastFreedBytes = compactFreedBytes;
+	compactStats.lastDuration = (int64_t) (((SDL_GetPerformanceCounter () - start) * 1000000) / SDL_GetPerformanceFrequency ());
+	compactStats.totalFreedCount += compactFreedCount;
+	compactStats.totalFreedBytes += compactFreedBytes;
+	SDL_UnlockMutex (compactStatsMutex);
 }
 
-void Resource::compactFileMap () {
-	std::vector<StdString>::iterator i, end;
-	std::map<StdString, Resource::FileData>::iterator mi;
+void Resource::setReleaseSequence (int sequence) {
+	SDL_AtomicSet (&releaseSequence, sequence);
+}
 
-	if (fileCompactList.empty ()) {
-		return;
+void Resource::setCompactSequence (int sequence) {
+	SDL_AtomicSet (&compactSequence, sequence);
+}
+
+bool Resource::isCompactPending () {
+	Resource::TextureMapStripe *stripe;
+	int64_t bytes;
+	int i;
+
+	if (SDL_AtomicGet (&compactPendingCount) > 0) {
+		return (true);
 	}
+
+	// textureCacheList is accessed only by the main thread, and the stripe byte counts are read under their locks only if cached textures could be freed
+	if (textureCacheList.empty ()) {
+		return (false);
+	}
+	bytes = 0;
+	for (i = 0; i < Resource::TextureMapStripeCount; ++i) {
+		stripe = &(textureMapStripes[i]);
+		SDL_LockMutex (stripe->mutex);
+		bytes += stripe->byteCount;
+		SDL_UnlockMutex (stripe->mutex);
+	}
+	return (bytes > textureMemoryBudget);
+}
+
+Resource::CompactStats Resource::getCompactStats () {
+	Resource::CompactStats stats;
+
+	SDL_LockMutex (compactStatsMutex);
+	stats = compactStats;
+	SDL_UnlockMutex (compactStatsMutex);
+
+	return (stats);
+}
+
+bool Resource::isCompactDeadlineReached (Uint64 deadline) {
+	return ((deadline > 0) && (SDL_GetPerformanceCounter () >= deadline));
+}
+
+bool Resource::compactFileMap (Uint64 deadline) {
+	std::vector<uint64_t>::iterator i, end;
+	std::unordered_map<uint64_t, Resource::FileData>::iterator mi;
+	bool complete;
+
+	complete = true;
 	SDL_LockMutex (fileMapMutex);
 	i = fileCompactList.begin ();
 	end = fileCompactList.end ();
@@ -235,65 +409,294 @@ void Resource::compactFileMap () {
 		mi = fileMap.find (*i);
 		if (mi != fileMap.end ()) {
 			if (mi->second.refcount <= 0) {
+				++compactFreedCount;
+				compactFreedBytes += (int64_t) mi->second.data->length;
 				delete (mi->second.data);
 				mi->second.data = NULL;
 				fileMap.erase (mi);
 			}
 		}
 		++i;
+		if (Resource::isCompactDeadlineReached (deadline)) {
+			complete = false;
+			break;
+		}
 	}
-	fileCompactList.clear ();
+	SDL_AtomicAdd (&compactPendingCount, -((int) (i - fileCompactList.begin ())));
+	fileCompactList.erase (fileCompactList.begin (), i);
 	SDL_UnlockMutex (fileMapMutex);
+
+	return (complete);
 }
 
-void Resource::compactTextureMap () {
-	std::vector<StdString>::iterator i, end;
-	std::map<StdString, Resource::TextureData>::iterator mi;
+bool Resource::compactTextureMap (Uint64 deadline) {
+	std::vector<Resource::CompactEntry>::iterator i, end;
+	std::unordered_map<uint64_t, Resource::TextureData>::iterator mi;
+	std::list<Resource::TextureCacheEntry>::iterator ci, cend;
+	Resource::TextureCacheEntry entry;
+	Resource::TextureMapStripe *stripe;
+	int64_t bytes;
+	size_t count;
+	bool complete;
+	int j, sequence;
+
+	complete = true;
+	bytes = 0;
+	count = 0;
+	sequence = SDL_AtomicGet (&compactSequence);
+	for (j = 0; j < Resource::TextureMapStripeCount; ++j) {
+		stripe = &(textureMapStripes[j]);
+		SDL_LockMutex (stripe->mutex);
+		if (complete && (! stripe->compactList.empty ())) {
+			i = stripe->compactList.begin ();
+			end = stripe->compactList.end ();
+			while (i != end) {
+				if (i->releaseSequence >= sequence) {
+					break;
+				}
+				mi = stripe->textureMap.find (i->resourceId);
+				if (mi != stripe->textureMap.end ()) {
+					if (mi->second.refcount <= 0) {
+						if ((! mi->second.isCacheable) || (textureMemoryBudget <= 0)) {
+							destroyTexture (stripe, mi);
+						}
+						else {
+							++nextTextureCacheStamp;
+							mi->second.cacheStamp = nextTextureCacheStamp;
+							textureCacheList.push_back (Resource::TextureCacheEntry (mi->first, nextTextureCacheStamp));
+						}
+					}
+				}
+				++i;
+				if (Resource::isCompactDeadlineReached (deadline)) {
+					complete = false;
+					break;
+				}
+			}
+			SDL_AtomicAdd (&compactPendingCount, -((int) (i - stripe->compactList.begin ())));
+			stripe->compactList.erase (stripe->compactList.begin (), i);
+		}
+		bytes += stripe->byteCount;
+		count += stripe->textureMap.size ();
+		SDL_UnlockMutex (stripe->mutex);
+	}
+	if (! complete) {
+		return (false);
+	}
 
-	if (textureCompactList.empty ()) {
-		return;
+	while ((bytes > textureMemoryBudget) && (! textureCacheList.empty ())) {
+		entry = textureCacheList.front ();
+		textureCacheList.pop_front ();
+		stripe = getTextureMapStripe (entry.resourceId);
+		SDL_LockMutex (stripe->mutex);
+		mi = stripe->textureMap.find (entry.resourceId);
+		if ((mi != stripe->textureMap.end ()) && (mi->second.refcount <= 0) && (mi->second.cacheStamp == entry.cacheStamp)) {
+			bytes -= mi->second.byteCount;
+			destroyTexture (stripe, mi);
+		}
+		SDL_UnlockMutex (stripe->mutex);
+		if (Resource::isCompactDeadlineReached (deadline)) {
+			return (false);
+		}
 	}
-	SDL_LockMutex (textureMapMutex);
-	i = textureCompactList.begin ();
-	end = textureCompactList.end ();
-	while (i != end) {
-		mi = textureMap.find (*i);
-		if (mi != textureMap.end ()) {
-			if (mi->second.refcount <= 0) {
-				SDL_DestroyTexture (mi->second.texture);
-				mi->second.texture = NULL;
-				textureMap.erase (mi);
+
+	if (textureCacheList.size () > (count * 2)) {
+		// Drop entries for textures that were referenced again or released more recently
+		ci = textureCacheList.begin ();
+		cend = textureCacheList.end ();
+		while (ci != cend) {
+			stripe = getTextureMapStripe (ci->resourceId);
+			SDL_LockMutex (stripe->mutex);
+			mi = stripe->textureMap.find (ci->resourceId);
+			if ((mi == stripe->textureMap.end ()) || (mi->second.refcount > 0) || (mi->second.cacheStamp != ci->cacheStamp)) {
+				ci = textureCacheList.erase (ci);
+			}
+			else {
+				++ci;
 			}
+			SDL_UnlockMutex (stripe->mutex);
 		}
-		++i;
 	}
-	textureCompactList.clear ();
-	SDL_UnlockMutex (textureMapMutex);
+	return (true);
 }
 
-void Resource::compactFontMap () {
-	std::vector<StdString>::iterator i, end;
-	std::map<StdString, Resource::FontData>::iterator mi;
+void Resource::destroyTexture (Resource::TextureMapStripe *stripe, std::unordered_map<uint64_t, Resource::TextureData>::iterator item) {
+	if (item->second.texture) {
+		SDL_DestroyTexture (item->second.texture);
+		item->second.texture = NULL;
+	}
+	++compactFreedCount;
+	compactFreedBytes += item->second.byteCount;
+	stripe->byteCount -= item->second.byteCount;
+	stripe->textureMap.erase (item);
+}
 
-	if (fontCompactList.empty ()) {
-		return;
+Resource::TextureMapStripe *Resource::getTextureMapStripe (uint64_t resourceId) {
+	return (&(textureMapStripes[resourceId % Resource::TextureMapStripeCount]));
+}
+
+SDL_Texture *Resource::acquireTexture (uint64_t resourceId, const StdString &path) {
+	std::unordered_map<uint64_t, Resource::TextureData>::iterator i;
+	Resource::TextureMapStripe *stripe;
+	SDL_Texture *texture;
+
+	texture = NULL;
+	stripe = getTextureMapStripe (resourceId);
+	SDL_LockMutex (stripe->mutex);
+	i = stripe->textureMap.find (resourceId);
+	if (i != stripe->textureMap.end ()) {
+		if (path.empty () || i->second.path.equals (path)) {
+			++(i->second.refcount);
+			texture = i->second.texture;
+		}
+	}
+	SDL_UnlockMutex (stripe->mutex);
+
+	return (texture);
+}
+
+SDL_Texture *Resource::insertTexture (uint64_t resourceId, const StdString &path, SDL_Texture *texture, bool isCacheable) {
+	std::unordered_map<uint64_t, Resource::TextureData>::iterator i;
+	Resource::TextureMapStripe *stripe;
+	Resource::TextureData data;
+	Uint32 format;
+	int w, h;
+	SDL_Texture *result;
+
+	data.path.assign (path);
+	data.texture = texture;
+	data.refcount = 1;
+	data.byteCount = 0;
+	data.isCacheable = isCacheable;
+	data.cacheStamp = 0;
+	if (SDL_QueryTexture (texture, &format, NULL, &w, &h) == 0) {
+		data.byteCount = ((int64_t) w) * ((int64_t) h) * SDL_BYTESPERPIXEL (format);
+	}
+
+	result = texture;
+	stripe = getTextureMapStripe (resourceId);
+	SDL_LockMutex (stripe->mutex);
+	i = stripe->textureMap.find (resourceId);
+	if (i != stripe->textureMap.end ()) {
+		if (i->second.path.equals (path)) {
+			++(i->second.refcount);
+			result = i->second.texture;
+		}
+		else {
+			result = NULL;
+		}
+	}
+	else {
+		stripe->textureMap.insert (std::pair<uint64_t, Resource::TextureData> (resourceId, data));
+		stripe->byteCount += data.byteCount;
 	}
+	SDL_UnlockMutex (stripe->mutex);
+
+	if (result != texture) {
+		SDL_DestroyTexture (texture);
+		if (! result) {
+			Log::err ("Failed to store texture resource; path=\"%s\" resourceId=0x%llx err=\"Resource ID conflict\"", path.c_str (), (long long int) resourceId);
+		}
+	}
+	return (result);
+}
+
+Resource::TextureMemoryStats Resource::getTextureMemoryStats () {
+	std::unordered_map<uint64_t, Resource::TextureData>::iterator i, end;
+	Resource::TextureMemoryStats stats;
+	Resource::TextureMapStripe *stripe;
+	int j;
+
+	stats.textureMemoryBudget = textureMemoryBudget;
+	for (j = 0; j < Resource::TextureMapStripeCount; ++j) {
+		stripe = &(textureMapStripes[j]);
+		SDL_LockMutex (stripe->mutex);
+		stats.textureCount += (int) stripe->textureMap.size ();
+		stats.textureBytes += stripe->byteCount;
+		i = stripe->textureMap.begin ();
+		end = stripe->textureMap.end ();
+		while (i != end) {
+			if (i->second.refcount <= 0) {
+				++(stats.cachedTextureCount);
+				stats.cachedTextureBytes += i->second.byteCount;
+			}
+			++i;
+		}
+		SDL_UnlockMutex (stripe->mutex);
+	}
+
+	return (stats);
+}
+
+bool Resource::compactFontMap (Uint64 deadline) {
+	std::vector<Resource::CompactEntry>::iterator i, end;
+	std::vector<uint64_t>::iterator k, kend;
+	std::unordered_map<uint64_t, Resource::FontData>::iterator mi;
+	std::unordered_map<uint64_t, Resource::FontFaceData>::iterator fi;
+	std::vector<uint64_t> fileids;
+	std::vector<uint64_t>::iterator j, jend;
+	bool complete;
+	int sequence;
+
+	complete = true;
+	sequence = SDL_AtomicGet (&compactSequence);
 	SDL_LockMutex (fontMapMutex);
+	if (fontCompactList.empty () && fontFaceCompactList.empty ()) {
+		SDL_UnlockMutex (fontMapMutex);
+		return (true);
+	}
 	i = fontCompactList.begin ();
 	end = fontCompactList.end ();
 	while (i != end) {
-		mi = fontMap.find (*i);
+		if (i->releaseSequence >= sequence) {
+			break;
+		}
+		mi = fontMap.find (i->resourceId);
 		if (mi != fontMap.end ()) {
 			if (mi->second.refcount <= 0) {
+				++compactFreedCount;
 				delete (mi->second.font);
 				mi->second.font = NULL;
 				fontMap.erase (mi);
 			}
 		}
 		++i;
+		if (Resource::isCompactDeadlineReached (deadline)) {
+			complete = false;
+			break;
+		}
+	}
+	SDL_AtomicAdd (&compactPendingCount, -((int) (i - fontCompactList.begin ())));
+	fontCompactList.erase (fontCompactList.begin (), i);
+
+	// Font faces are freed only after all pending Font objects, which hold FT_Size objects belonging to those faces
+	if (complete && fontCompactList.empty ()) {
+		k = fontFaceCompactList.begin ();
+		kend = fontFaceCompactList.end ();
+		while (k != kend) {
+			fi = fontFaceMap.find (*k);
+			if (fi != fontFaceMap.end ()) {
+				if (fi->second.refcount <= 0) {
+					FT_Done_Face (fi->second.face);
+					SDL_DestroyMutex (fi->second.mutex);
+					fontFaceMap.erase (fi);
+					fileids.push_back (*k);
+				}
+			}
+			++k;
+		}
+		SDL_AtomicAdd (&compactPendingCount, -((int) fontFaceCompactList.size ()));
+		fontFaceCompactList.clear ();
 	}
-	fontCompactList.clear ();
 	SDL_UnlockMutex (fontMapMutex);
+
+	j = fileids.begin ();
+	jend = fileids.end ();
+	while (j != jend) {
+		unloadFile (*j);
+		++j;
+	}
+	return (complete);
 }
 
 bool Resource::fileExists (const StdString &path) {
@@ -485,19 +888,44 @@ int Resource::rwopsClose (SDL_RWops *rw) {
 	return (0);
 }
 
+uint64_t Resource::getResourceId (const StdString &path) {
+	uint64_t id;
+	unsigned char *s, c;
+
+	// 64-bit FNV-1a
+	id = 0xCBF29CE484222325ULL;
+	s = (unsigned char *) path.c_str ();
+	while (true) {
+		c = *s;
+		if (! c) {
+			break;
+		}
+		id ^= (uint64_t) c;
+		id *= 0x100000001B3ULL;
+		++s;
+	}
+	return (id & ~(Resource::GeneratedResourceIdFlag));
+}
+
+uint64_t Resource::createResourceId () {
+	return (((uint64_t) App::instance->getUniqueId ()) | Resource::GeneratedResourceIdFlag);
+}
+
 Buffer *Resource::loadFile (const StdString &path) {
-	std::map<StdString, Resource::FileData>::iterator i;
+	std::unordered_map<uint64_t, Resource::FileData>::iterator i;
 	Resource::FileData data;
 	Buffer *buffer;
 	SDL_RWops *rw;
-	uint64_t sz;
+	uint64_t id, sz;
 	uint8_t buf[8192];
 	size_t len, rlen;
+	Trace::Scope scope ("Resource::loadFile", "resource");
 
 	buffer = NULL;
+	id = Resource::getResourceId (path);
 	SDL_LockMutex (fileMapMutex);
-	i = fileMap.find (path);
-	if (i != fileMap.end ()) {
+	i = fileMap.find (id);
+	if ((i != fileMap.end ()) && i->second.path.equals (path)) {
 		++(i->second.refcount);
 		buffer = i->second.data;
 	}
@@ -532,25 +960,46 @@ Buffer *Resource::loadFile (const StdString &path) {
 		return (NULL);
 	}
 
+	data.path.assign (path);
 	data.data = buffer;
 	data.refcount = 1;
 	SDL_LockMutex (fileMapMutex);
-	fileMap.insert (std::pair<StdString, Resource::FileData> (path, data));
+	i = fileMap.find (id);
+	if (i != fileMap.end ()) {
+		if (i->second.path.equals (path)) {
+			++(i->second.refcount);
+			delete (buffer);
+			buffer = i->second.data;
+		}
+		else {
+			Log::err ("Failed to store file resource; path=\"%s\" resourceId=0x%llx err=\"Resource ID conflict\"", path.c_str (), (long long int) id);
+			delete (buffer);
+			buffer = NULL;
+		}
+	}
+	else {
+		fileMap.insert (std::pair<uint64_t, Resource::FileData> (id, data));
+	}
 	SDL_UnlockMutex (fileMapMutex);
 
 	return (buffer);
 }
 
 void Resource::unloadFile (const StdString &path) {
-	std::map<StdString, Resource::FileData>::iterator i;
+	unloadFile (Resource::getResourceId (path));
+}
+
+void Resource::unloadFile (uint64_t resourceId) {
+	std::unordered_map<uint64_t, Resource::FileData>::iterator i;
 
 	SDL_LockMutex (fileMapMutex);
-	i = fileMap.find (path);
+	i = fileMap.find (resourceId);
 	if (i != fileMap.end ()) {
 		if (i->second.refcount > 0) {
 			--(i->second.refcount);
 			if (i->second.refcount <= 0) {
-				fileCompactList.push_back (i->first);
+				fileCompactList.push_back (resourceId);
+				SDL_AtomicAdd (&compactPendingCount, 1);
 			}
 		}
 	}
@@ -561,6 +1010,7 @@ SDL_Surface *Resource::loadSurface (const StdString &path) {
 	StdString loadpath;
 	SDL_RWops *rw;
 	SDL_Surface *surface;
+	Trace::Scope scope ("Resource::loadSurface", "resource");
 
 	surface = NULL;
 	if (isBundleFile) {
@@ -586,49 +1036,21 @@ SDL_Surface *Resource::loadSurface (const StdString &path) {
 }
 
 SDL_Texture *Resource::loadTexture (const StdString &path) {
-	std::map<StdString, Resource::TextureData>::iterator i;
-	Resource::TextureData data;
-	StdString loadpath;
-	SDL_RWops *rw;
 	SDL_Surface *surface;
 	SDL_Texture *texture;
+	uint64_t id;
+	Trace::Scope scope ("Resource::loadTexture", "resource");
 
-	texture = NULL;
-	SDL_LockMutex (textureMapMutex);
-	i = textureMap.find (path);
-	if (i != textureMap.end ()) {
-		++(i->second.refcount);
-		texture = i->second.texture;
-	}
-	SDL_UnlockMutex (textureMapMutex);
+	id = Resource::getResourceId (path);
+	texture = acquireTexture (id, path);
 	if (texture) {
 		return (texture);
 	}
 
-	surface = NULL;
-	if (isBundleFile) {
-		rw = openFile (path);
-		if (! rw) {
-			return (NULL);
-		}
-		surface = IMG_Load_RW (rw, 1);
-		if (! surface) {
-			Log::info ("bundle IMG_Load_RW failed; path=\"%s\" err=\"%s\"", path.c_str (), SDL_GetError ());
-			return (NULL);
-		}
-	}
-	else {
-		loadpath.sprintf ("%s/%s", dataPath.c_str (), path.c_str ());
-		surface = IMG_Load (loadpath.c_str ());
-		if (! surface) {
-			Log::info ("IMG_Load failed; path=\"%s\" err=\"%s\"", path.c_str (), SDL_GetError ());
-			return (NULL);
-		}
-	}
+	surface = loadSurface (path);
 	if (! surface) {
 		return (NULL);
 	}
-
 	texture = SDL_CreateTextureFromSurface (App::instance->render, surface);
 	SDL_FreeSurface (surface);
 	if (! texture) {
@@ -636,28 +1058,194 @@ SDL_Texture *Resource::loadTexture (const StdString &path) {
 		return (NULL);
 	}
 
-	data.texture = texture;
-	data.refcount = 1;
-	SDL_LockMutex (textureMapMutex);
-	textureMap.insert (std::pair<StdString, Resource::TextureData> (path, data));
-	SDL_UnlockMutex (textureMapMutex);
+	return (insertTexture (id, path, texture, true));
+}
 
-	return (texture);
+bool Resource::loadTextureAsync (const StdString &path, Resource::TextureLoadCallbackContext callback) {
+	std::unordered_map<uint64_t, Resource::TextureData>::iterator i;
+	Resource::TextureLoadRequest *request;
+	Resource::TextureMapStripe *stripe;
+	bool found;
+
+	request = new Resource::TextureLoadRequest ();
+	request->path.assign (path);
+	request->resourceId = Resource::getResourceId (path);
+	request->callback = callback;
+
+	stripe = getTextureMapStripe (request->resourceId);
+	SDL_LockMutex (stripe->mutex);
+	i = stripe->textureMap.find (request->resourceId);
+	found = (i != stripe->textureMap.end ());
+	SDL_UnlockMutex (stripe->mutex);
+
+	SDL_LockMutex (textureUploadListMutex);
+	request->generation = textureUploadGeneration;
+	if (found) {
+		// The texture is already loaded; executeTextureUploads acquires a reference to it without decoding
+		textureUploadList.push_back (request);
+		SDL_UnlockMutex (textureUploadListMutex);
+		return (true);
+	}
+	SDL_UnlockMutex (textureUploadListMutex);
+
+	if (! runDecodeTexture (request)) {
+		Log::debug ("Failed to start texture load task; path=\"%s\"", path.c_str ());
+		delete (request);
+		return (false);
+	}
+	return (true);
 }
 
-SDL_Texture *Resource::createTexture (const StdString &path, SDL_Surface *surface) {
-	std::map<StdString, Resource::TextureData>::iterator i;
-	Resource::TextureData data;
+bool Resource::runDecodeTexture (Resource::TextureLoadRequest *request) {
+	bool shouldstart, isqueued;
+
+	// Requests are decoded by a bounded number of tasks that drain textureDecodeQueue, rather than a thread for each request, so that loading many images at once doesn't start a burst of threads
+	SDL_LockMutex (textureUploadListMutex);
+	textureDecodeList.push_back (request);
+	textureDecodeQueue.push_back (request);
+	shouldstart = (textureDecodeTaskCount < ((maxTextureDecodeTasks > 0) ? maxTextureDecodeTasks : 1));
+	if (shouldstart) {
+		++textureDecodeTaskCount;
+	}
+	SDL_UnlockMutex (textureUploadListMutex);
+	if ((! shouldstart) || TaskGroup::instance->run (TaskGroup::RunContext (Resource::decodeTextures, this))) {
+		return (true);
+	}
+
+	// No task was started, and the request remains queued only if another task is running to take it
+	SDL_LockMutex (textureUploadListMutex);
+	--textureDecodeTaskCount;
+	isqueued = (textureDecodeTaskCount > 0);
+	if (! isqueued) {
+		textureDecodeList.remove (request);
+		textureDecodeQueue.remove (request);
+	}
+	SDL_UnlockMutex (textureUploadListMutex);
+
+	return (isqueued);
+}
+
+void Resource::decodeTextures (void *resourcePtr) {
+	Resource *resource;
+	Resource::TextureLoadRequest *request;
+
+	resource = (Resource *) resourcePtr;
+	SDL_LockMutex (resource->textureUploadListMutex);
+	while (! resource->textureDecodeQueue.empty ()) {
+		request = resource->textureDecodeQueue.front ();
+		resource->textureDecodeQueue.pop_front ();
+		SDL_UnlockMutex (resource->textureUploadListMutex);
+
+		request->surface = resource->loadSurface (request->path);
+		request->isDecoded = true;
+
+		SDL_LockMutex (resource->textureUploadListMutex);
+		if (request->generation != resource->textureUploadGeneration) {
+			SDL_UnlockMutex (resource->textureUploadListMutex);
+			Resource::freeTextureLoadRequest (request);
+			SDL_LockMutex (resource->textureUploadListMutex);
+		}
+		else {
+			resource->textureDecodeList.remove (request);
+			resource->textureUploadList.push_back (request);
+		}
+	}
+	--(resource->textureDecodeTaskCount);
+	SDL_UnlockMutex (resource->textureUploadListMutex);
+}
+
+void Resource::executeTextureUploads () {
+	Resource::TextureLoadRequest *request;
 	SDL_Texture *texture;
+	int count, index;
 
-	texture = NULL;
-	SDL_LockMutex (textureMapMutex);
-	i = textureMap.find (path);
-	if (i != textureMap.end ()) {
-		++(i->second.refcount);
-		texture = i->second.texture;
+	count = maxTextureUploadsPerFrame;
+	if (count <= 0) {
+		count = Resource::DefaultMaxTextureUploadsPerFrame;
+	}
+	textureUploadBatch.clear ();
+	SDL_LockMutex (textureUploadListMutex);
+	while ((count > 0) && (! textureUploadList.empty ())) {
+		textureUploadBatch.push_back (textureUploadList.front ());
+		textureUploadList.pop_front ();
+		--count;
+	}
+	SDL_UnlockMutex (textureUploadListMutex);
+
+	// Callbacks may invoke cancelTextureLoads, which clears callbacks for requests remaining in textureUploadBatch
+	for (index = 0; index < (int) textureUploadBatch.size (); ++index) {
+		request = textureUploadBatch.at (index);
+		texture = acquireTexture (request->resourceId, request->path);
+		if ((! texture) && (! request->isDecoded)) {
+			// The texture was unloaded after the request was queued, and its image data must be decoded
+			if (runDecodeTexture (request)) {
+				continue;
+			}
+		}
+		if ((! texture) && request->surface) {
+			texture = SDL_CreateTextureFromSurface (App::instance->render, request->surface);
+			if (! texture) {
+				Log::err ("SDL_CreateTextureFromSurface failed; path=\"%s\" err=\"%s\"", request->path.c_str (), SDL_GetError ());
+			}
+			else {
+				texture = insertTexture (request->resourceId, request->path, texture, true);
+			}
+		}
+		if (request->surface) {
+			SDL_FreeSurface (request->surface);
+			request->surface = NULL;
+		}
+
+		if (request->callback.callback) {
+			request->callback.callback (request->callback.callbackData, request->path, texture);
+		}
+		else if (texture) {
+			unloadTexture (request->resourceId);
+		}
+		delete (request);
+	}
+	textureUploadBatch.clear ();
+}
+
+void Resource::cancelTextureLoads (void *callbackData) {
+	std::list<Resource::TextureLoadRequest *>::iterator i, end;
+	std::vector<Resource::TextureLoadRequest *>::iterator j, jend;
+
+	SDL_LockMutex (textureUploadListMutex);
+	i = textureUploadList.begin ();
+	end = textureUploadList.end ();
+	while (i != end) {
+		if ((*i)->callback.callbackData == callbackData) {
+			(*i)->callback = Resource::TextureLoadCallbackContext ();
+		}
+		++i;
+	}
+	i = textureDecodeList.begin ();
+	end = textureDecodeList.end ();
+	while (i != end) {
+		if ((*i)->callback.callbackData == callbackData) {
+			(*i)->callback = Resource::TextureLoadCallbackContext ();
+		}
+		++i;
 	}
-	SDL_UnlockMutex (textureMapMutex);
+	SDL_UnlockMutex (textureUploadListMutex);
+
+	j = textureUploadBatch.begin ();
+	jend = textureUploadBatch.end ();
+	while (j != jend) {
+		if ((*j)->callback.callbackData == callbackData) {
+			(*j)->callback = Resource::TextureLoadCallbackContext ();
+		}
+		++j;
+	}
+}
+
+SDL_Texture *Resource::createTexture (const StdString &path, SDL_Surface *surface) {
+	SDL_Texture *texture;
+	uint64_t id;
+
+	id = Resource::getResourceId (path);
+	texture = acquireTexture (id, path);
 	if (texture) {
 		return (texture);
 	}
@@ -667,80 +1255,96 @@ SDL_Texture *Resource::createTexture (const StdString &path, SDL_Surface *surfac
 		return (NULL);
 	}
 
-	data.texture = texture;
-	data.refcount = 1;
-	SDL_LockMutex (textureMapMutex);
-	textureMap.insert (std::pair<StdString, Resource::TextureData> (path, data));
-	SDL_UnlockMutex (textureMapMutex);
-
-	return (texture);
+	return (insertTexture (id, path, texture, true));
 }
 
 SDL_Texture *Resource::createTexture (const StdString &path, int textureWidth, int textureHeight) {
-	std::map<StdString, Resource::TextureData>::iterator i;
-	Resource::TextureData data;
 	SDL_Texture *texture;
+	uint64_t id;
 
 	if ((textureWidth <= 0) || (textureHeight <= 0)) {
 		return (NULL);
 	}
-	texture = NULL;
-	SDL_LockMutex (textureMapMutex);
-	i = textureMap.find (path);
-	if (i != textureMap.end ()) {
-		++(i->second.refcount);
-		texture = i->second.texture;
-	}
-	SDL_UnlockMutex (textureMapMutex);
+	id = Resource::getResourceId (path);
+	texture = acquireTexture (id, path);
 	if (texture) {
 		return (texture);
 	}
 	texture = SDL_CreateTexture (App::instance->render, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, textureWidth, textureHeight);
 	if (! texture) {
-		Log::err ("SDL_CreateTextureFromSurface failed; path=\"%s\" err=\"%s\"", path.c_str (), SDL_GetError ());
+		Log::err ("SDL_CreateTexture failed; path=\"%s\" err=\"%s\"", path.c_str (), SDL_GetError ());
 		return (NULL);
 	}
 
-	data.texture = texture;
-	data.refcount = 1;
-	SDL_LockMutex (textureMapMutex);
-	textureMap.insert (std::pair<StdString, Resource::TextureData> (path, data));
-	SDL_UnlockMutex (textureMapMutex);
+	return (insertTexture (id, path, texture, false));
+}
 
-	return (texture);
+SDL_Texture *Resource::createTexture (uint64_t resourceId, int textureWidth, int textureHeight, int textureAccess) {
+	SDL_Texture *texture;
+
+	if ((textureWidth <= 0) || (textureHeight <= 0)) {
+		return (NULL);
+	}
+	texture = acquireTexture (resourceId, StdString (""));
+	if (texture) {
+		return (texture);
+	}
+	texture = SDL_CreateTexture (App::instance->render, SDL_PIXELFORMAT_RGBA8888, textureAccess, textureWidth, textureHeight);
+	if (! texture) {
+		Log::err ("SDL_CreateTexture failed; resourceId=0x%llx err=\"%s\"", (long long int) resourceId, SDL_GetError ());
+		return (NULL);
+	}
+
+	return (insertTexture (resourceId, StdString (""), texture, false));
 }
 
 void Resource::unloadTexture (const StdString &path) {
-	std::map<StdString, Resource::TextureData>::iterator i;
+	unloadTexture (Resource::getResourceId (path));
+}
 
-	SDL_LockMutex (textureMapMutex);
-	i = textureMap.find (path);
-	if (i != textureMap.end ()) {
+void Resource::unloadTexture (uint64_t resourceId) {
+	std::unordered_map<uint64_t, Resource::TextureData>::iterator i;
+	Resource::TextureMapStripe *stripe;
+
+	stripe = getTextureMapStripe (resourceId);
+	SDL_LockMutex (stripe->mutex);
+	i = stripe->textureMap.find (resourceId);
+	if (i != stripe->textureMap.end ()) {
 		if (i->second.refcount > 0) {
 			--(i->second.refcount);
 
 			if (i->second.refcount <= 0) {
-				textureCompactList.push_back (i->first);
+				// Invalidate any texture cache entry from an earlier release, which would otherwise allow the texture to be freed before reaching its new release sequence
+				i->second.cacheStamp = 0;
+				stripe->compactList.push_back (Resource::CompactEntry (resourceId, SDL_AtomicGet (&releaseSequence)));
+				SDL_AtomicAdd (&compactPendingCount, 1);
 			}
 		}
 	}
 
-	SDL_UnlockMutex (textureMapMutex);
+	SDL_UnlockMutex (stripe->mutex);
 }
 
 Font *Resource::loadFont (const StdString &path, int pointSize) {
-	std::map<StdString, Resource::FontData>::iterator i;
+	std::unordered_map<uint64_t, Resource::FontData>::iterator i;
 	Resource::FontData data;
-	StdString key;
-	Buffer *buffer;
+	Resource::FontFaceData *facedata;
+	StdString name;
 	Font *font;
+	uint64_t id, fileid;
 	int result;
+	Trace::Scope scope ("Resource::loadFont", "resource");
 
 	font = NULL;
-	key = Resource::getFontKey (path, pointSize);
+	id = Resource::getFontId (path, pointSize);
+	fileid = Resource::getResourceId (path);
 	SDL_LockMutex (fontMapMutex);
-	i = fontMap.find (key);
+	i = fontMap.find (id);
 	if (i != fontMap.end ()) {
+		if (i->second.refcount <= 0) {
+			// The font is awaiting compaction and its face reference was released
+			++(fontFaceMap[i->second.fileId].refcount);
+		}
 		++(i->second.refcount);
 		font = i->second.font;
 	}
@@ -748,55 +1352,148 @@ Font *Resource::loadFont (const StdString &path, int pointSize) {
 	if (font) {
 		return (font);
 	}
-	buffer = loadFile (path);
-	if (! buffer) {
+
+	facedata = acquireFontFace (path, fileid);
+	if (! facedata) {
 		return (NULL);
 	}
-
-	font = new Font (freetype, key);
-	result = font->load (buffer, pointSize);
+	name = Resource::getFontName (path, pointSize);
+	font = new Font (facedata->face, facedata->mutex, name);
+	result = font->load (pointSize);
 	if (result != OsUtil::Success) {
 		delete (font);
-		unloadFile (path);
-		Log::err ("Failed to load font resource; key=\"%s\" err=%i", key.c_str (), result);
+		SDL_LockMutex (fontMapMutex);
+		releaseFontFace (fileid);
+		SDL_UnlockMutex (fontMapMutex);
+		Log::err ("Failed to load font resource; name=\"%s\" err=%i", name.c_str (), result);
 		return (NULL);
 	}
 
 	data.font = font;
+	data.fileId = fileid;
 	data.refcount = 1;
 	SDL_LockMutex (fontMapMutex);
-	fontMap.insert (std::pair<StdString, Resource::FontData> (key, data));
+	i = fontMap.find (id);
+	if (i != fontMap.end ()) {
+		// Another thread loaded the same font; use that object instead
+		if (i->second.refcount <= 0) {
+			++(fontFaceMap[i->second.fileId].refcount);
+		}
+		++(i->second.refcount);
+		releaseFontFace (fileid);
+		SDL_UnlockMutex (fontMapMutex);
+		delete (font);
+		return (i->second.font);
+	}
+	fontMap.insert (std::pair<uint64_t, Resource::FontData> (id, data));
 	SDL_UnlockMutex (fontMapMutex);
 
 	return (font);
 }
 
+Resource::FontFaceData *Resource::acquireFontFace (const StdString &path, uint64_t fileId) {
+	std::unordered_map<uint64_t, Resource::FontFaceData>::iterator i;
+	Resource::FontFaceData data, *result;
+	Buffer *buffer;
+	int err;
+
+	result = NULL;
+	SDL_LockMutex (fontMapMutex);
+	i = fontFaceMap.find (fileId);
+	if (i != fontFaceMap.end ()) {
+		++(i->second.refcount);
+		result = &(i->second);
+	}
+	SDL_UnlockMutex (fontMapMutex);
+	if (result) {
+		return (result);
+	}
+
+	// The face references file data directly, and holds the file reference until the face is freed
+	buffer = loadFile (path);
+	if (! buffer) {
+		return (NULL);
+	}
+	err = FT_New_Memory_Face (freetype, (FT_Byte *) buffer->data, buffer->length, 0, &(data.face));
+	if (err != 0) {
+		unloadFile (fileId);
+		Log::err ("Failed to load font; path=\"%s\" err=\"FT_New_Memory_Face: %i\"", path.c_str (), err);
+		return (NULL);
+	}
+	data.mutex = SDL_CreateMutex ();
+	data.refcount = 1;
+
+	SDL_LockMutex (fontMapMutex);
+	i = fontFaceMap.find (fileId);
+	if (i != fontFaceMap.end ()) {
+		++(i->second.refcount);
+		result = &(i->second);
+	}
+	else {
+		fontFaceMap.insert (std::pair<uint64_t, Resource::FontFaceData> (fileId, data));
+		result = &(fontFaceMap[fileId]);
+		data.face = NULL;
+	}
+	SDL_UnlockMutex (fontMapMutex);
+	if (data.face) {
+		FT_Done_Face (data.face);
+		SDL_DestroyMutex (data.mutex);
+		unloadFile (fileId);
+	}
+
+	return (result);
+}
+
+void Resource::releaseFontFace (uint64_t fileId) {
+	std::unordered_map<uint64_t, Resource::FontFaceData>::iterator i;
+
+	i = fontFaceMap.find (fileId);
+	if (i != fontFaceMap.end ()) {
+		if (i->second.refcount > 0) {
+			--(i->second.refcount);
+			if (i->second.refcount <= 0) {
+				fontFaceCompactList.push_back (fileId);
+				SDL_AtomicAdd (&compactPendingCount, 1);
+			}
+		}
+	}
+}
+
 void Resource::unloadFont (const StdString &path, int pointSize) {
-	std::map<StdString, Resource::FontData>::iterator i;
-	StdString key;
-	bool unloaded;
+	std::unordered_map<uint64_t, Resource::FontData>::iterator i;
+	uint64_t id;
 
-	unloaded = false;
-	key = Resource::getFontKey (path, pointSize);
+	id = Resource::getFontId (path, pointSize);
 	SDL_LockMutex (fontMapMutex);
-	i = fontMap.find (key);
+	i = fontMap.find (id);
 	if (i != fontMap.end ()) {
 		if (i->second.refcount > 0) {
 			--(i->second.refcount);
 			if (i->second.refcount <= 0) {
-				fontCompactList.push_back (i->first);
-				unloaded = true;
+				fontCompactList.push_back (Resource::CompactEntry (id, SDL_AtomicGet (&releaseSequence)));
+				SDL_AtomicAdd (&compactPendingCount, 1);
+				releaseFontFace (i->second.fileId);
 			}
 		}
 	}
 	SDL_UnlockMutex (fontMapMutex);
-	if (unloaded) {
-		unloadFile (path);
+}
+
+uint64_t Resource::getFontId (const StdString &path, int pointSize) {
+	uint64_t id;
+	int i;
+
+	// Continue the path's FNV-1a hash with the bytes of pointSize
+	id = Resource::getResourceId (path);
+	for (i = 0; i < 4; ++i) {
+		id ^= (uint64_t) ((pointSize >> (i * 8)) & 0xFF);
+		id *= 0x100000001B3ULL;
 	}
+	return (id & ~(Resource::GeneratedResourceIdFlag));
 }
 
-StdString Resource::getFontKey (const StdString &key, int pointSize) {
-	return (StdString::createSprintf ("%s:%i", key.c_str (), pointSize));
+StdString Resource::getFontName (const StdString &path, int pointSize) {
+	return (StdString::createSprintf ("%s:%i", path.c_str (), pointSize));
 }
 
 uint64_t Resource::getPathId (const StdString &path) {
@@ -33,7 +33,9 @@
 #define RESOURCE_H
 
 #include <map>
+#include <unordered_map>
 #include <vector>
+#include <list>
 #include "SDL2/SDL.h"
 #include "ft2build.h"
 #include FT_FREETYPE_H
@@ -48,6 +50,59 @@ public:
 	~Resource ();
 	static Resource *instance;
 
+	static const int DefaultMaxTextureUploadsPerFrame;
+	static const int DefaultMaxTextureDecodeTasks;
+	static const int64_t DefaultTextureMemoryBudget;
+	static const uint64_t GeneratedResourceIdFlag;
+	static const int TextureMapStripeCount = 8;
+
+	typedef void (*TextureLoadCallback) (void *callbackData, const StdString &path, SDL_Texture *texture);
+	struct TextureLoadCallbackContext {
+		Resource::TextureLoadCallback callback;
+		void *callbackData;
+		TextureLoadCallbackContext ():
+			callback (NULL),
+			callbackData (NULL) { }
+		TextureLoadCallbackContext (Resource::TextureLoadCallback callback, void *callbackData):
+			callback (callback),
+			callbackData (callbackData) { }
+	};
+
+	struct TextureMemoryStats {
+		int textureCount;
+		int64_t textureBytes;
+		int cachedTextureCount;
+		int64_t cachedTextureBytes;
+		int64_t textureMemoryBudget;
+		TextureMemoryStats ():
+			textureCount (0),
+			textureBytes (0),
+			cachedTextureCount (0),
+			cachedTextureBytes (0),
+			textureMemoryBudget (0) { }
+	};
+
+	struct CompactStats {
+		int64_t passCount;
+		int lastFreedCount;
+		int64_t lastFreedBytes;
+		int64_t lastDuration;
+		int64_t totalFreedCount;
+		int64_t totalFreedBytes;
+		CompactStats ():
+			passCount (0),
+			lastFreedCount (0),
+			lastFreedBytes (0),
+			lastDuration (0),
+			totalFreedCount (0),
+			totalFreedBytes (0) { }
+	};
+
+	// Read-write data members
+	int maxTextureUploadsPerFrame;
+	int maxTextureDecodeTasks; // The maximum number of TaskGroup tasks that may decode image data for loadTextureAsync requests at the same time
+	int64_t textureMemoryBudget;
+
 	// Set the source path that should be used for loading file assets. If the path ends in ".dat", it is opened as a bundle file; otherwise, the path is treated as a directory prefix for direct file access.
 	void setSource (const StdString &path);
 
@@ -57,8 +112,20 @@ public:
 	// Close the resource object and free all assets
 	void close ();
 
-	// Free objects associated with resources that are no longer referenced
-	void compact ();
+	// Free objects associated with resources that are no longer referenced. If maxDuration is greater than zero, stop the operation after that number of microseconds has elapsed and leave remaining items for a later call; at least one item is processed by each call, unless held back by the compact sequence. This method must be invoked only from the application's main thread.
+	void compact (int64_t maxDuration = 0);
+
+	// Set the sequence number that should be stamped on textures and fonts released after this call
+	void setReleaseSequence (int sequence);
+
+	// Set the sequence number that limits compact operations, which free a released texture or font only if its stamped sequence number is less than this value. This allows draw lists recorded before a resource was released to execute safely.
+	void setCompactSequence (int sequence);
+
+	// Return a boolean value indicating if the compact method has items to free
+	bool isCompactPending ();
+
+	// Return a CompactStats struct containing counts of objects freed by compact operations
+	Resource::CompactStats getCompactStats ();
 
 	// Return a boolean value indicating whether a resource file exists at the specified path
 	bool fileExists (const StdString &path);
@@ -66,11 +133,18 @@ public:
 	// Open resource data at the specified path and return the resulting SDL_RWops object, or NULL if the file could not be opened. The caller is responsible for closing the SDL_RWops object when it's no longer needed. If fileSize is non-NULL, its value is set to the size of the opened file.
 	SDL_RWops *openFile (const StdString &path, uint64_t *fileSize = NULL);
 
+	// Return the resource ID value that identifies the specified path in resource tables. Resource ID values computed from paths never have GeneratedResourceIdFlag set.
+	static uint64_t getResourceId (const StdString &path);
+
+	// Return a newly generated resource ID value that is not associated with any path, for use with textures created by the application. Generated resource ID values always have GeneratedResourceIdFlag set.
+	uint64_t createResourceId ();
+
 	// Load file data from the specified resource path. Returns a pointer to the resulting Buffer object, or NULL if the file load failed. If a pointer is returned by this method, the referenced path must be unloaded with the unloadFile method when the Buffer is no longer needed.
 	Buffer *loadFile (const StdString &path);
 
-	// Unload previously acquired file resources from the specified path
+	// Unload previously acquired file resources from the specified path or resource ID
 	void unloadFile (const StdString &path);
+	void unloadFile (uint64_t resourceId);
 
 	// Load an SDL_surface asset from an image file at the specified resource path. Returns a pointer to the resulting SDL_surface, or NULL if the surface could not be loaded. If an SDL_surface is returned by this method, the caller is responsible for freeing it with SDL_FreeSurface when it's no longer needed.
 	SDL_Surface *loadSurface (const StdString &path);
@@ -78,16 +152,32 @@ public:
 	// Load an SDL_Texture asset from an image file at the specified resource path. Returns a pointer to the resulting SDL_Texture, or NULL if the texture could not be loaded. This method must be invoked only from the application's main thread.
 	SDL_Texture *loadTexture (const StdString &path);
 
+	// Begin loading an SDL_Texture asset from an image file at the specified resource path, decoding image data in a background task. The resulting texture is created during a later executeTextureUploads call, which passes it to callback on the application's main thread. A non-NULL texture provided to callback holds a reference that must be released with the unloadTexture method; a NULL texture indicates that the load failed. Returns a boolean value indicating if the request was queued.
+	bool loadTextureAsync (const StdString &path, Resource::TextureLoadCallbackContext callback);
+
+	// Create textures from image data decoded by loadTextureAsync requests, up to maxTextureUploadsPerFrame per invocation, and invoke their callbacks. This method must be invoked only from the application's main thread.
+	void executeTextureUploads ();
+
+	// Cancel callbacks for all pending loadTextureAsync requests that were made with the specified callback data pointer. Textures created for cancelled requests are released without being passed to a callback. This method must be invoked only from the application's main thread.
+	void cancelTextureLoads (void *callbackData);
+
 	// Create a texture from a surface and associate it with a path. Returns a pointer to the resulting SDL_Texture, or NULL if the texture could not be created. The surface object is not modified or freed by this method. This method must be invoked only from the application's main thread.
 	SDL_Texture *createTexture (const StdString &path, SDL_Surface *surface);
 
 	// Create a render target texture of the specified size and associate it with a path. Returns a pointer to the resulting SDL_Texture, or NULL if the texture could not be created. This method must be invoked only from the application's main thread.
 	SDL_Texture *createTexture (const StdString &path, int textureWidth, int textureHeight);
 
-	// Unload previously acquired texture resources from the specified path
+	// Create a texture of the specified size and access type and associate it with a resource ID, as provided by createResourceId. Returns a pointer to the resulting SDL_Texture, or NULL if the texture could not be created. This method must be invoked only from the application's main thread.
+	SDL_Texture *createTexture (uint64_t resourceId, int textureWidth, int textureHeight, int textureAccess = SDL_TEXTUREACCESS_TARGET);
+
+	// Unload previously acquired texture resources from the specified path or resource ID. Textures that are no longer referenced remain cached until compaction finds that total texture memory exceeds textureMemoryBudget, at which point the least recently released cached textures are freed. Render target textures and textures associated with generated resource IDs are not cached.
 	void unloadTexture (const StdString &path);
+	void unloadTexture (uint64_t resourceId);
+
+	// Return a TextureMemoryStats struct containing the approximate amount of memory held by loaded textures
+	Resource::TextureMemoryStats getTextureMemoryStats ();
 
-	// Load a Font asset from a ttf file at the specified resource path. Returns a pointer to the resulting Font, or NULL if the font could not be loaded. This method must be invoked only from the application's main thread.
+	// Load a Font asset from a ttf file at the specified resource path. Fonts loaded from the same file share a single FT_Face object. Returns a pointer to the resulting Font, or NULL if the font could not be loaded.
 	Font *loadFont (const StdString &path, int pointSize);
 
 	// Unload previously acquired font resources for the specified path and point size
@@ -109,41 +199,132 @@ private:
 		uint64_t length;
 	};
 
+	struct CompactEntry {
+		uint64_t resourceId;
+		int releaseSequence;
+		CompactEntry ():
+			resourceId (0),
+			releaseSequence (0) { }
+		CompactEntry (uint64_t resourceId, int releaseSequence):
+			resourceId (resourceId),
+			releaseSequence (releaseSequence) { }
+	};
+
 	struct FileData {
+		StdString path;
 		Buffer *data;
 		int refcount;
 	};
 
 	struct TextureData {
+		StdString path;
 		SDL_Texture *texture;
 		int refcount;
+		int64_t byteCount;
+		bool isCacheable;
+		uint64_t cacheStamp;
+	};
+
+	struct TextureCacheEntry {
+		uint64_t resourceId;
+		uint64_t cacheStamp;
+		TextureCacheEntry ():
+			resourceId (0),
+			cacheStamp (0) { }
+		TextureCacheEntry (uint64_t resourceId, uint64_t cacheStamp):
+			resourceId (resourceId),
+			cacheStamp (cacheStamp) { }
 	};
 
 	struct FontData {
 		Font *font;
+		uint64_t fileId;
+		int refcount;
+	};
+
+	struct FontFaceData {
+		FT_Face face;
+		SDL_mutex *mutex;
 		int refcount;
 	};
 
+	struct TextureLoadRequest {
+		StdString path;
+		uint64_t resourceId;
+		SDL_Surface *surface;
+		bool isDecoded;
+		int generation;
+		Resource::TextureLoadCallbackContext callback;
+		TextureLoadRequest ():
+			path (""),
+			resourceId (0),
+			surface (NULL),
+			isDecoded (false),
+			generation (0),
+			callback () { }
+	};
+
+	// A section of the texture table, holding the items whose resource ID values map to it
+	struct TextureMapStripe {
+		std::unordered_map<uint64_t, Resource::TextureData> textureMap;
+		std::vector<Resource::CompactEntry> compactList;
+		int64_t byteCount;
+		SDL_mutex *mutex;
+		TextureMapStripe ():
+			byteCount (0),
+			mutex (NULL) { }
+	};
+
 	StdString dataPath;
 	FT_Library freetype;
 	bool isBundleFile;
 	bool isOpen;
 
-	// A map of resource paths to FileData objects
-	std::map<StdString, Resource::FileData> fileMap;
-	std::vector<StdString> fileCompactList;
+	// A map of resource ID values to FileData objects
+	std::unordered_map<uint64_t, Resource::FileData> fileMap;
+	std::vector<uint64_t> fileCompactList;
 	SDL_mutex *fileMapMutex;
 
-	// A map of resource paths to TextureData objects
-	std::map<StdString, Resource::TextureData> textureMap;
-	std::vector<StdString> textureCompactList;
-	SDL_mutex *textureMapMutex;
+	// A table of resource ID values to TextureData objects, divided into stripes that each hold a separate lock
+	Resource::TextureMapStripe textureMapStripes[Resource::TextureMapStripeCount];
+
+	// A list of unreferenced textures that remain in the texture table, ordered from least to most recently released. This list is accessed only by the application's main thread.
+	std::list<Resource::TextureCacheEntry> textureCacheList;
+	uint64_t nextTextureCacheStamp;
 
-	// A map of font keys to FontData objects
-	std::map<StdString, Resource::FontData> fontMap;
-	std::vector<StdString> fontCompactList;
+	// Counts of objects freed by compact operations. These values are accessed only by the application's main thread, except for compactStats, which is protected by compactStatsMutex.
+	int compactFreedCount;
+	int64_t compactFreedBytes;
+	Resource::CompactStats compactStats;
+	SDL_mutex *compactStatsMutex;
+
+	// Sequence numbers used to hold back compact operations on textures and fonts. Items in texture and font compact lists are ordered by release sequence.
+	SDL_atomic_t releaseSequence;
+	SDL_atomic_t compactSequence;
+
+	// The total count of entries in fileCompactList, fontCompactList, fontFaceCompactList, and each texture map stripe's compactList, changed under the lock that protects each list
+	SDL_atomic_t compactPendingCount;
+
+	// A map of font ID values to FontData objects
+	std::unordered_map<uint64_t, Resource::FontData> fontMap;
+	std::vector<Resource::CompactEntry> fontCompactList;
 	SDL_mutex *fontMapMutex;
 
+	// A map of file resource ID values to FontFaceData objects, protected by fontMapMutex
+	std::unordered_map<uint64_t, Resource::FontFaceData> fontFaceMap;
+	std::vector<uint64_t> fontFaceCompactList;
+
+	// A list of TextureLoadRequest objects holding decoded image data that awaits upload, a list of requests awaiting decode or being decoded, and a queue of requests not yet taken by a decodeTextures task. Requests with a generation value that no longer matches textureUploadGeneration were discarded by clearTextureUploadList and are freed by the task that holds them.
+	std::list<Resource::TextureLoadRequest *> textureUploadList;
+	std::list<Resource::TextureLoadRequest *> textureDecodeList;
+	std::list<Resource::TextureLoadRequest *> textureDecodeQueue;
+	int textureUploadGeneration;
+	int textureDecodeTaskCount;
+	SDL_mutex *textureUploadListMutex;
+
+	// Requests removed from textureUploadList by the executeTextureUploads call in progress, accessed only from the application's main thread
+	std::vector<Resource::TextureLoadRequest *> textureUploadBatch;
+
 	// A map of entry ID values to ArchiveEntry structs
 	std::map<uint64_t, Resource::ArchiveEntry> archiveEntryMap;
 
@@ -156,19 +337,55 @@ private:
 	// Clear the font map
 	void clearFontMap ();
 
-	// Remove unreferenced items from the file map
-	void compactFileMap ();
+	// Remove unreferenced items from the file map, returning false if the operation stopped because deadline was reached. A deadline value of zero indicates no time limit.
+	bool compactFileMap (Uint64 deadline);
+
+	// Remove unreferenced items from the texture map, returning false if the operation stopped because deadline was reached. A deadline value of zero indicates no time limit.
+	bool compactTextureMap (Uint64 deadline);
+
+	// Remove unreferenced items from the font map and font face map, returning false if the operation stopped because deadline was reached. A deadline value of zero indicates no time limit.
+	bool compactFontMap (Uint64 deadline);
+
+	// Return a boolean value indicating if a compact operation has passed the specified deadline
+	static bool isCompactDeadlineReached (Uint64 deadline);
+
+	// Return the texture map stripe that holds items for the specified resource ID
+	Resource::TextureMapStripe *getTextureMapStripe (uint64_t resourceId);
+
+	// Return the texture stored for the specified resource ID after acquiring a reference to it, or NULL if no such texture was found. If path is not empty, the texture is returned only if it was stored with a matching path.
+	SDL_Texture *acquireTexture (uint64_t resourceId, const StdString &path);
+
+	// Add a newly created texture to the texture table, allowing it to remain cached after it becomes unreferenced if isCacheable is true. If the table already holds an item for resourceId, destroy texture and acquire a reference to the existing item instead. Returns the SDL_Texture object stored in the table, or NULL if the resource ID was found to be associated with a different path.
+	SDL_Texture *insertTexture (uint64_t resourceId, const StdString &path, SDL_Texture *texture, bool isCacheable);
+
+	// Destroy the texture referenced by a texture table item and remove it from its stripe. This method must be invoked while holding a lock on the stripe's mutex.
+	void destroyTexture (Resource::TextureMapStripe *stripe, std::unordered_map<uint64_t, Resource::TextureData>::iterator item);
+
+	// Clear the texture upload list and texture decode queue, freeing any decoded image data they hold. Requests held by decodeTextures tasks are freed when those tasks complete.
+	void clearTextureUploadList ();
+
+	// Add request to the texture decode queue, starting a decodeTextures task if fewer than maxTextureDecodeTasks are running. Returns a boolean value indicating if the request was queued.
+	bool runDecodeTexture (Resource::TextureLoadRequest *request);
+
+	// Decode image data for requests taken from the texture decode queue until it is empty, adding each request to the texture upload list, or freeing it if the upload list was cleared while it was decoding. This method is executed by a TaskGroup thread.
+	static void decodeTextures (void *resourcePtr);
+
+	// Free a TextureLoadRequest object and any decoded image data it holds
+	static void freeTextureLoadRequest (Resource::TextureLoadRequest *request);
+
+	// Acquire a reference to the font face for the specified file, loading it if needed. Returns a pointer to the face's FontFaceData item, or NULL if the face could not be loaded.
+	Resource::FontFaceData *acquireFontFace (const StdString &path, uint64_t fileId);
 
-	// Remove unreferenced items from the texture map
-	void compactTextureMap ();
+	// Release a reference to the font face for the specified file. This method must be invoked while holding a lock on fontMapMutex.
+	void releaseFontFace (uint64_t fileId);
 
-	// Remove unreferenced items from the font map
-	void compactFontMap ();
+	// Return the ID value that should be used to store the specified font in the font map
+	static uint64_t getFontId (const StdString &path, int pointSize);
 
-	// Return the key that should be used to store the specified font in the font map
-	static StdString getFontKey (const StdString &key, int pointSize);
+	// Return the name that should be assigned to the specified font
+	static StdString getFontName (const StdString &path, int pointSize);
 
-	// Return an ID value computed from the provided path, using the djb2 algorithm
+	// Return an ID value computed from the provided path, using the djb2 algorithm. This value identifies entries in bundle files and must not be changed.
 	static uint64_t getPathId (const StdString &path);
 };
 
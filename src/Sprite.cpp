@@ -143,6 +143,38 @@ OsUtil::Result Sprite::addTexture (SDL_Texture *texture, const StdString &loadPa
 	return (OsUtil::Success);
 }
 
+OsUtil::Result Sprite::replaceTexture (int index, SDL_Texture *texture, const StdString &loadPath) {
+	std::vector<Sprite::TextureData>::iterator i, end;
+	Sprite::TextureData item;
+
+	if ((index < 0) || (index >= (int) textureList.size ())) {
+		return (OsUtil::InvalidParamError);
+	}
+	item.texture = texture;
+	item.loadPath.assign (loadPath);
+	if (SDL_QueryTexture (item.texture, NULL, NULL, &(item.width), &(item.height)) != 0) {
+		Log::err ("Failed to query sprite texture; path=\"%s\" err=\"%s\"", item.loadPath.c_str (), SDL_GetError ());
+		return (OsUtil::SdlOperationFailedError);
+	}
+	Resource::instance->unloadTexture (textureList.at (index).loadPath);
+	textureList.at (index) = item;
+
+	maxWidth = 0;
+	maxHeight = 0;
+	i = textureList.begin ();
+	end = textureList.end ();
+	while (i != end) {
+		if (i->width > maxWidth) {
+			maxWidth = i->width;
+		}
+		if (i->height > maxHeight) {
+			maxHeight = i->height;
+		}
+		++i;
+	}
+	return (OsUtil::Success);
+}
+
 void Sprite::unload () {
 	std::vector<Sprite::TextureData>::iterator i, end;
 
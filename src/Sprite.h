@@ -55,6 +55,9 @@ public:
 	// Add the provided texture to the sprite's frame set. When the sprite is unloaded, release it from resources using the specified loadPath. Returns a Result value.
 	OsUtil::Result addTexture (SDL_Texture *texture, const StdString &loadPath);
 
+	// Replace the texture at the specified index with the provided texture, releasing the previous texture from resources. When the sprite is unloaded, release the new texture using the specified loadPath. Returns a Result value.
+	OsUtil::Result replaceTexture (int index, SDL_Texture *texture, const StdString &loadPath);
+
 	// Unload previously loaded sprite data
 	void unload ();
 
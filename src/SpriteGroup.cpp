@@ -40,11 +40,13 @@
 
 SpriteGroup::SpriteGroup ()
 : isLoaded (false)
+, pendingTextureLoadCount (0)
 {
 
 }
 
 SpriteGroup::~SpriteGroup () {
+	clearTextureLoads ();
 	clearSpriteList ();
 }
 
@@ -111,17 +113,64 @@ void SpriteGroup::unload () {
 		return;
 	}
 	isLoaded = false;
+	clearTextureLoads ();
 	clearSpriteList ();
 }
 
 void SpriteGroup::resize (int imageScale) {
 	std::vector<Sprite *>::iterator i, end;
+	std::vector<SpriteGroup::TextureLoad>::iterator j, jend;
+	SpriteGroup::TextureLoad item;
 	Sprite *sprite;
-	int result, index;
+	int index, frame;
 
 	if (imageScale < 0) {
 		imageScale = App::instance->imageScale;
 	}
+	clearTextureLoads ();
+	index = 0;
+	i = spriteList.begin ();
+	end = spriteList.end ();
+	while (i != end) {
+		sprite = *i;
+		if (Resource::instance->fileExists (StdString::createSprintf ("%s/%03i/000_%i.png", loadPath.c_str (), index, imageScale))) {
+			for (frame = 0; frame < sprite->frameCount; ++frame) {
+				item.spriteIndex = index;
+				item.frame = frame;
+				item.loadPath.sprintf ("%s/%03i/%03i_%i.png", loadPath.c_str (), index, frame, imageScale);
+				if (! Resource::instance->fileExists (item.loadPath)) {
+					item.loadPath.sprintf ("%s/%03i/%03i.png", loadPath.c_str (), index, frame);
+				}
+				if (! item.loadPath.equals (sprite->getLoadPath (frame))) {
+					textureLoadList.push_back (item);
+				}
+			}
+		}
+		++index;
+		++i;
+	}
+	if (textureLoadList.empty ()) {
+		return;
+	}
+
+	pendingTextureLoadCount = (int) textureLoadList.size ();
+	j = textureLoadList.begin ();
+	jend = textureLoadList.end ();
+	while (j != jend) {
+		if (! Resource::instance->loadTextureAsync (j->loadPath, Resource::TextureLoadCallbackContext (SpriteGroup::textureLoaded, this))) {
+			clearTextureLoads ();
+			reloadSprites (imageScale);
+			return;
+		}
+		++j;
+	}
+}
+
+void SpriteGroup::reloadSprites (int imageScale) {
+	std::vector<Sprite *>::iterator i, end;
+	Sprite *sprite;
+	int result, index;
+
 	index = 0;
 	i = spriteList.begin ();
 	end = spriteList.end ();
@@ -139,6 +188,84 @@ void SpriteGroup::resize (int imageScale) {
 	}
 }
 
+void SpriteGroup::clearTextureLoads () {
+	std::vector<SpriteGroup::TextureLoad>::iterator i, end;
+
+	if (textureLoadList.empty ()) {
+		return;
+	}
+	Resource::instance->cancelTextureLoads (this);
+	i = textureLoadList.begin ();
+	end = textureLoadList.end ();
+	while (i != end) {
+		if (i->texture) {
+			Resource::instance->unloadTexture (i->loadPath);
+			i->texture = NULL;
+		}
+		++i;
+	}
+	textureLoadList.clear ();
+	pendingTextureLoadCount = 0;
+}
+
+void SpriteGroup::textureLoaded (void *groupPtr, const StdString &path, SDL_Texture *texture) {
+	SpriteGroup *group;
+	std::vector<SpriteGroup::TextureLoad>::iterator i, end;
+
+	group = (SpriteGroup *) groupPtr;
+	i = group->textureLoadList.begin ();
+	end = group->textureLoadList.end ();
+	while (i != end) {
+		if ((! i->isComplete) && i->loadPath.equals (path)) {
+			i->isComplete = true;
+			i->texture = texture;
+			--(group->pendingTextureLoadCount);
+			break;
+		}
+		++i;
+	}
+	if (i == end) {
+		if (texture) {
+			Resource::instance->unloadTexture (path);
+		}
+		return;
+	}
+	if (group->pendingTextureLoadCount <= 0) {
+		group->applyTextureLoads ();
+	}
+}
+
+void SpriteGroup::applyTextureLoads () {
+	std::vector<SpriteGroup::TextureLoad>::iterator i, end;
+	Sprite *sprite;
+	int result;
+
+	App::instance->suspendUpdate ();
+	i = textureLoadList.begin ();
+	end = textureLoadList.end ();
+	while (i != end) {
+		if (! i->texture) {
+			Log::err ("Failed to reload texture; path=\"%s\"", i->loadPath.c_str ());
+		}
+		else {
+			sprite = spriteList.at (i->spriteIndex);
+			result = sprite->replaceTexture (i->frame, i->texture, i->loadPath);
+			if (result != OsUtil::Success) {
+				Log::err ("Failed to reload texture; path=\"%s\" err=%i", i->loadPath.c_str (), result);
+				Resource::instance->unloadTexture (i->loadPath);
+			}
+			i->texture = NULL;
+		}
+		++i;
+	}
+	textureLoadList.clear ();
+	pendingTextureLoadCount = 0;
+	App::instance->unsuspendUpdate ();
+
+	// Sprite dimensions may have changed, requiring layout of widgets that draw them
+	App::instance->shouldRefreshUi = true;
+}
+
 Sprite *SpriteGroup::getSprite (int index) {
 	if ((! isLoaded) || (index < 0) || (index >= (int) spriteList.size ())) {
 		return (NULL);
@@ -33,6 +33,7 @@
 #define SPRITE_GROUP_H
 
 #include <vector>
+#include "SDL2/SDL.h"
 #include "StdString.h"
 #include "OsUtil.h"
 #include "Sprite.h"
@@ -52,17 +53,45 @@ public:
 	// Unload previously loaded sprite data
 	void unload ();
 
-	// Reload sprite textures as needed for the specified image scale. If no image scale value is provided, the application image scale is used.
+	// Reload sprite textures as needed for the specified image scale. If no image scale value is provided, the application image scale is used. Replacement textures are loaded with asynchronous resource requests, and sprites continue to hold their previous textures until all replacements are available. This method must be invoked only from the application's main thread.
 	void resize (int imageScale = -1);
 
 	// Return the Sprite object at the specified index, or NULL if no such Sprite was found
 	Sprite *getSprite (int index);
 
 private:
+	struct TextureLoad {
+		int spriteIndex;
+		int frame;
+		StdString loadPath;
+		SDL_Texture *texture;
+		bool isComplete;
+		TextureLoad ():
+			spriteIndex (0),
+			frame (0),
+			loadPath (""),
+			texture (NULL),
+			isComplete (false) { }
+	};
+
 	// Remove all items from the sprite list
 	void clearSpriteList ();
 
+	// Reload sprite textures for the specified image scale, loading each texture before returning
+	void reloadSprites (int imageScale);
+
+	// Cancel pending texture loads and release any textures they have provided
+	void clearTextureLoads ();
+
+	// Replace sprite textures with those provided by texture loads, then clear the texture load list
+	void applyTextureLoads ();
+
+	// Callback functions
+	static void textureLoaded (void *groupPtr, const StdString &path, SDL_Texture *texture);
+
 	std::vector<Sprite *> spriteList;
+	std::vector<SpriteGroup::TextureLoad> textureLoadList;
+	int pendingTextureLoadCount;
 };
 
 #endif
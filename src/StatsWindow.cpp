@@ -43,6 +43,7 @@
 StatsWindow::StatsWindow ()
 : Panel ()
 , isEmptyItemValueIgnored (false)
+, isValueChangeHighlighted (true)
 , maxLineHeight (0.0f)
 {
 	setPadding (UiConfiguration::instance->paddingSize, UiConfiguration::instance->paddingSize);
@@ -92,7 +93,7 @@ void StatsWindow::setItem (const StdString &itemName, const StdString &itemValue
 			found = true;
 			label = i->valueLabel;
 			if (! label->text.equals (itemValue)) {
-				if (! label->text.empty ()) {
+				if (isValueChangeHighlighted && (! label->text.empty ())) {
 					label->textColor.assign (UiConfiguration::instance->primaryTextColor);
 					label->textColor.translate (UiConfiguration::instance->lightPrimaryTextColor, UiConfiguration::instance->longColorTranslateDuration);
 				}
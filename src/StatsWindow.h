@@ -45,6 +45,7 @@ public:
 
 	// Read-write data members
 	bool isEmptyItemValueIgnored;
+	bool isValueChangeHighlighted; // If enabled, item values briefly change color when set to new text
 
 	// Remove all stats items
 	void clearItems ();
@@ -32,6 +32,7 @@
 #include <list>
 #include "SDL2/SDL.h"
 #include "StdString.h"
+#include "Trace.h"
 #include "TaskGroup.h"
 
 TaskGroup *TaskGroup::instance = NULL;
@@ -70,7 +71,16 @@ int TaskGroup::executeTask (void *taskContextPtr) {
 	TaskGroup::TaskContext *ctx;
 
 	ctx = (TaskGroup::TaskContext *) taskContextPtr;
-	ctx->fn.fn (ctx->fn.fnData);
+	if (Trace::instance) {
+		Trace::instance->setThreadName ("task");
+	}
+	{
+		Trace::Scope scope ("TaskGroup::executeTask", "task");
+		ctx->fn.fn (ctx->fn.fnData);
+	}
+	if (Trace::instance) {
+		Trace::instance->releaseThreadBuffer ();
+	}
 	ctx->isRunning = false;
 
 	return (0);
@@ -80,7 +90,6 @@ void TaskGroup::update (int msElapsed) {
 	std::list<TaskGroup::TaskContext>::iterator i, end;
 	std::list<TaskGroup::TaskContext> cblist;
 	int result;
-	bool found;
 
 	SDL_LockMutex (contextListMutex);
 	i = contextList.begin ();
@@ -93,26 +102,19 @@ void TaskGroup::update (int msElapsed) {
 		++i;
 	}
 
-	while (true) {
-		found = false;
-		i = contextList.begin ();
-		end = contextList.end ();
-		while (i != end) {
-			if (i->thread && (! i->isRunning)) {
-				found = true;
-				SDL_WaitThread (i->thread, &result);
-				i->thread = NULL;
-				if (i->endCallback.callback) {
-					cblist.push_back (*i);
-				}
-				contextList.erase (i);
-				break;
+	i = contextList.begin ();
+	end = contextList.end ();
+	while (i != end) {
+		if (i->thread && (! i->isRunning)) {
+			SDL_WaitThread (i->thread, &result);
+			i->thread = NULL;
+			if (i->endCallback.callback) {
+				cblist.push_back (*i);
 			}
-			++i;
-		}
-		if (! found) {
-			break;
+			i = contextList.erase (i);
+			continue;
 		}
+		++i;
 	}
 	SDL_UnlockMutex (contextListMutex);
 
@@ -141,6 +143,16 @@ bool TaskGroup::isStopComplete () {
 	return (result);
 }
 
+int TaskGroup::getTaskCount () {
+	int result;
+
+	SDL_LockMutex (contextListMutex);
+	result = (int) contextList.size ();
+	SDL_UnlockMutex (contextListMutex);
+
+	return (result);
+}
+
 void TaskGroup::waitThreads () {
 	std::list<TaskGroup::TaskContext>::iterator i, end;
 	int result;
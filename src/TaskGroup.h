@@ -82,6 +82,9 @@ public:
 	// Join any running task threads, blocking until the operation completes
 	void waitThreads ();
 
+	// Return the number of tasks that have been queued and have not yet ended
+	int getTaskCount ();
+
 private:
 	// Run a thread that executes a task
 	static int executeTask (void *taskContextPtr);
@@ -0,0 +1,348 @@
+/*
+* Copyright 2018-2022 Membrane Software <author@membranesoftware.com> https://membranesoftware.com
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+* this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+* this list of conditions and the following disclaimer in the documentation
+* and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors
+* may be used to endorse or promote products derived from this software without
+* specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "Config.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <vector>
+#include <map>
+#include "SDL2/SDL.h"
+#include "StdString.h"
+#include "OsUtil.h"
+#include "Trace.h"
+
+Trace *Trace::instance = NULL;
+const int Trace::ThreadEventCapacity = 16384;
+const int Trace::RetiredEventCapacity = 16384;
+
+Trace::Trace ()
+: isEnabled (false)
+, threadBufferMutex (NULL)
+, retiredEvents (NULL)
+, retiredEventCount (0)
+{
+	int i;
+
+	for (i = 0; i < Trace::MaxThreadCount; ++i) {
+		threadBuffers[i].threadId = 0;
+		threadBuffers[i].threadName = NULL;
+		threadBuffers[i].events = NULL;
+		SDL_AtomicSet (&(threadBuffers[i].eventCount), 0);
+	}
+	SDL_AtomicSet (&threadBufferCount, 0);
+	SDL_AtomicSet (&droppedEventCount, 0);
+	threadBufferMutex = SDL_CreateMutex ();
+}
+
+Trace::~Trace () {
+	int i;
+
+	for (i = 0; i < Trace::MaxThreadCount; ++i) {
+		if (threadBuffers[i].events) {
+			free (threadBuffers[i].events);
+			threadBuffers[i].events = NULL;
+		}
+	}
+	if (retiredEvents) {
+		free (retiredEvents);
+		retiredEvents = NULL;
+	}
+	if (threadBufferMutex) {
+		SDL_DestroyMutex (threadBufferMutex);
+		threadBufferMutex = NULL;
+	}
+}
+
+Trace::Scope::Scope (const char *name, const char *category)
+: name (name)
+, category (category)
+, startTime (0)
+{
+	if (Trace::instance && Trace::instance->isEnabled) {
+		startTime = OsUtil::getMonotonicTime ();
+	}
+}
+
+Trace::Scope::~Scope () {
+	if ((startTime > 0) && Trace::instance) {
+		Trace::instance->addEvent (name, category, startTime, OsUtil::getMonotonicTime ());
+	}
+}
+
+void Trace::enable () {
+	isEnabled = true;
+}
+
+Trace::ThreadBuffer *Trace::getThreadBuffer () {
+	Trace::ThreadBuffer *buffer;
+	SDL_threadID id;
+	int count, i;
+
+	id = SDL_ThreadID ();
+	count = SDL_AtomicGet (&threadBufferCount);
+	SDL_MemoryBarrierAcquire ();
+	for (i = 0; i < count; ++i) {
+		if (threadBuffers[i].threadId == id) {
+			return (&(threadBuffers[i]));
+		}
+	}
+
+	// Buffers are assigned only once per thread, so the lock taken here is not contended during normal event recording
+	buffer = NULL;
+	SDL_LockMutex (threadBufferMutex);
+	if (! freeBufferIndexes.empty ()) {
+		buffer = &(threadBuffers[freeBufferIndexes.back ()]);
+		freeBufferIndexes.pop_back ();
+		buffer->threadId = id;
+		SDL_UnlockMutex (threadBufferMutex);
+		return (buffer);
+	}
+	count = SDL_AtomicGet (&threadBufferCount);
+	if (count < Trace::MaxThreadCount) {
+		buffer = &(threadBuffers[count]);
+		buffer->events = (Trace::Event *) malloc (Trace::ThreadEventCapacity * sizeof (Trace::Event));
+		if (! buffer->events) {
+			buffer = NULL;
+		}
+		else {
+			buffer->threadId = id;
+			SDL_MemoryBarrierRelease ();
+			SDL_AtomicSet (&threadBufferCount, count + 1);
+		}
+	}
+	SDL_UnlockMutex (threadBufferMutex);
+
+	return (buffer);
+}
+
+void Trace::setThreadName (const char *name) {
+	Trace::ThreadBuffer *buffer;
+
+	if (! isEnabled) {
+		return;
+	}
+	buffer = getThreadBuffer ();
+	if (buffer) {
+		SDL_AtomicSetPtr (&(buffer->threadName), (void *) name);
+	}
+}
+
+void Trace::releaseThreadBuffer () {
+	Trace::ThreadBuffer *buffer;
+	Trace::RetiredEvent *item;
+	SDL_threadID id;
+	int count, eventcount, startindex, i, k;
+
+	if (! isEnabled) {
+		return;
+	}
+	id = SDL_ThreadID ();
+	SDL_LockMutex (threadBufferMutex);
+	count = SDL_AtomicGet (&threadBufferCount);
+	for (i = 0; i < count; ++i) {
+		buffer = &(threadBuffers[i]);
+		if (buffer->threadId != id) {
+			continue;
+		}
+
+		// The calling thread is the buffer's only writer, so its events can be copied without checking for replacement
+		eventcount = SDL_AtomicGet (&(buffer->eventCount));
+		startindex = eventcount - Trace::ThreadEventCapacity;
+		if (startindex < 0) {
+			startindex = 0;
+		}
+		if (! retiredEvents) {
+			retiredEvents = (Trace::RetiredEvent *) malloc (Trace::RetiredEventCapacity * sizeof (Trace::RetiredEvent));
+		}
+		if (! retiredEvents) {
+			startindex = eventcount;
+		}
+		SDL_AtomicAdd (&droppedEventCount, startindex);
+		for (k = startindex; k < eventcount; ++k) {
+			item = &(retiredEvents[retiredEventCount % Trace::RetiredEventCapacity]);
+			item->event = buffer->events[k % Trace::ThreadEventCapacity];
+			item->threadId = id;
+			item->threadName = (const char *) SDL_AtomicGetPtr (&(buffer->threadName));
+			++retiredEventCount;
+		}
+
+		buffer->threadId = 0;
+		SDL_AtomicSetPtr (&(buffer->threadName), NULL);
+		SDL_AtomicSet (&(buffer->eventCount), 0);
+		freeBufferIndexes.push_back (i);
+		break;
+	}
+	SDL_UnlockMutex (threadBufferMutex);
+}
+
+void Trace::addEvent (const char *name, const char *category, int64_t startTime, int64_t endTime) {
+	Trace::ThreadBuffer *buffer;
+	Trace::Event *event;
+	int index;
+
+	if (! isEnabled) {
+		return;
+	}
+	buffer = getThreadBuffer ();
+	if (! buffer) {
+		SDL_AtomicAdd (&droppedEventCount, 1);
+		return;
+	}
+	index = SDL_AtomicGet (&(buffer->eventCount));
+	event = &(buffer->events[index % Trace::ThreadEventCapacity]);
+	event->name = name;
+	event->category = category;
+	event->startTime = startTime;
+	event->duration = endTime - startTime;
+
+	// SDL_AtomicSet is only an acquire barrier, so the release barrier is needed to publish the event before readers can observe the advanced count
+	SDL_MemoryBarrierRelease ();
+	SDL_AtomicSet (&(buffer->eventCount), index + 1);
+}
+
+int Trace::getDroppedEventCount () {
+	int count, eventcount, i, result;
+
+	SDL_LockMutex (threadBufferMutex);
+	result = SDL_AtomicGet (&droppedEventCount);
+	count = SDL_AtomicGet (&threadBufferCount);
+	for (i = 0; i < count; ++i) {
+		eventcount = SDL_AtomicGet (&(threadBuffers[i].eventCount));
+		if (eventcount > Trace::ThreadEventCapacity) {
+			result += eventcount - Trace::ThreadEventCapacity;
+		}
+	}
+	if (retiredEventCount > Trace::RetiredEventCapacity) {
+		result += retiredEventCount - Trace::RetiredEventCapacity;
+	}
+	SDL_UnlockMutex (threadBufferMutex);
+
+	return (result);
+}
+
+void Trace::copyThreadEvents (Trace::ThreadBuffer *buffer, std::vector<Trace::RetiredEvent> *destList) {
+	Trace::RetiredEvent item;
+	int startindex, endindex, skipcount, copystart, k;
+
+	// Copy the ring, then skip events that the owning thread may have replaced while the copy was in progress. The writer can be storing the event at index endindex without yet having advanced eventCount, so the event at endindex - ThreadEventCapacity is also skipped.
+	copystart = (int) destList->size ();
+	item.threadId = buffer->threadId;
+	item.threadName = (const char *) SDL_AtomicGetPtr (&(buffer->threadName));
+	endindex = SDL_AtomicGet (&(buffer->eventCount));
+	SDL_MemoryBarrierAcquire ();
+	startindex = endindex - Trace::ThreadEventCapacity;
+	if (startindex < 0) {
+		startindex = 0;
+	}
+	for (k = startindex; k < endindex; ++k) {
+		item.event = buffer->events[k % Trace::ThreadEventCapacity];
+		destList->push_back (item);
+	}
+	SDL_MemoryBarrierAcquire ();
+	skipcount = SDL_AtomicGet (&(buffer->eventCount)) - Trace::ThreadEventCapacity + 1 - startindex;
+	if (skipcount > (endindex - startindex)) {
+		skipcount = endindex - startindex;
+	}
+	if (skipcount > 0) {
+		destList->erase (destList->begin () + copystart, destList->begin () + copystart + skipcount);
+	}
+}
+
+OsUtil::Result Trace::writeFile (const StdString &filename) {
+	std::vector<Trace::RetiredEvent> events;
+	std::vector<Trace::RetiredEvent>::iterator j, jend;
+	std::map<SDL_threadID, const char *> threadnames;
+	std::map<SDL_threadID, const char *>::iterator n, nend;
+	Trace::ThreadBuffer *buffer;
+	const char *threadname;
+	int count, startindex, pid, i, k;
+	bool isfirst;
+	FILE *fp;
+
+	// Holding threadBufferMutex prevents buffers from being claimed or released during the copy, while their owning threads continue to add events
+	SDL_LockMutex (threadBufferMutex);
+	startindex = retiredEventCount - Trace::RetiredEventCapacity;
+	if (startindex < 0) {
+		startindex = 0;
+	}
+	for (k = startindex; k < retiredEventCount; ++k) {
+		events.push_back (retiredEvents[k % Trace::RetiredEventCapacity]);
+	}
+	count = SDL_AtomicGet (&threadBufferCount);
+	SDL_MemoryBarrierAcquire ();
+	for (i = 0; i < count; ++i) {
+		buffer = &(threadBuffers[i]);
+		if (buffer->threadId == 0) {
+			continue;
+		}
+		threadname = (const char *) SDL_AtomicGetPtr (&(buffer->threadName));
+		if (threadname) {
+			threadnames[buffer->threadId] = threadname;
+		}
+		copyThreadEvents (buffer, &events);
+	}
+	SDL_UnlockMutex (threadBufferMutex);
+
+	j = events.begin ();
+	jend = events.end ();
+	while (j != jend) {
+		if (j->threadName && (threadnames.find (j->threadId) == threadnames.end ())) {
+			threadnames[j->threadId] = j->threadName;
+		}
+		++j;
+	}
+
+	fp = fopen (filename.c_str (), "wb");
+	if (! fp) {
+		return (OsUtil::FileOpenFailedError);
+	}
+
+	// Events are written as complete ("X") events, each holding a begin time and duration in microseconds
+	pid = OsUtil::getProcessId ();
+	isfirst = true;
+	fprintf (fp, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+	n = threadnames.begin ();
+	nend = threadnames.end ();
+	while (n != nend) {
+		fprintf (fp, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%i,\"tid\":%llu,\"args\":{\"name\":\"%s\"}}", isfirst ? "" : ",", pid, (unsigned long long) n->first, n->second);
+		isfirst = false;
+		++n;
+	}
+	j = events.begin ();
+	jend = events.end ();
+	while (j != jend) {
+		fprintf (fp, "%s\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%i,\"tid\":%llu}", isfirst ? "" : ",", j->event.name, j->event.category, ((double) j->event.startTime) / 1000.0f, ((double) j->event.duration) / 1000.0f, pid, (unsigned long long) j->threadId);
+		isfirst = false;
+		++j;
+	}
+	fprintf (fp, "\n]}\n");
+	fclose (fp);
+	return (OsUtil::Success);
+}
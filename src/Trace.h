@@ -0,0 +1,133 @@
+/*
+* Copyright 2018-2022 Membrane Software <author@membranesoftware.com> https://membranesoftware.com
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+* this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+* this list of conditions and the following disclaimer in the documentation
+* and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors
+* may be used to endorse or promote products derived from this software without
+* specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*/
+// Class that records timed events from application threads and writes them as Chrome trace event JSON
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include <vector>
+#include "SDL2/SDL.h"
+#include "StdString.h"
+#include "OsUtil.h"
+
+class Trace {
+public:
+	Trace ();
+	~Trace ();
+	static Trace *instance;
+
+	// The maximum number of threads that can record events at the same time. Threads that start while all buffers are in use are not traced.
+	static const int MaxThreadCount = 64;
+
+	// The number of events held for each thread. Once a thread's buffer is full, each new event replaces the thread's oldest event.
+	static const int ThreadEventCapacity;
+
+	// The number of events held from threads that have released their buffers. Once full, each newly retired event replaces the oldest retired event.
+	static const int RetiredEventCapacity;
+
+	struct Event {
+		const char *name;
+		const char *category;
+		int64_t startTime; // Monotonic clock value in nanoseconds
+		int64_t duration; // nanoseconds
+	};
+
+	// Object that records a trace event covering its own lifetime, for use as a local variable
+	class Scope {
+	public:
+		// Begin the event. name and category must remain valid for the lifetime of the trace, as with string literals.
+		Scope (const char *name, const char *category);
+
+		// End the event and add it to the calling thread's trace buffer
+		~Scope ();
+
+	private:
+		const char *name;
+		const char *category;
+		int64_t startTime;
+	};
+
+	// Read-only data members
+	bool isEnabled;
+
+	// Enable the recording of trace events. This method must be invoked before starting any thread to be traced.
+	void enable ();
+
+	// Set the name written for the calling thread. name must remain valid for the lifetime of the trace.
+	void setThreadName (const char *name);
+
+	// Move the calling thread's held events to the retired event ring and return its trace buffer for use by other threads. A short-lived thread should invoke this method before exiting.
+	void releaseThreadBuffer ();
+
+	// Add an event to the calling thread's trace buffer. name and category must remain valid for the lifetime of the trace.
+	void addEvent (const char *name, const char *category, int64_t startTime, int64_t endTime);
+
+	// Return the number of events discarded because no trace buffer was available, or because they were replaced by newer events
+	int getDroppedEventCount ();
+
+	// Write all held events to the specified file in Chrome trace event format, for viewing with chrome://tracing or Perfetto. Returns a Result value.
+	OsUtil::Result writeFile (const StdString &filename);
+
+private:
+	// A thread's trace buffer, holding a ring of the thread's most recent events. Only the owning thread writes events, storing each event before advancing eventCount, so that readers can copy events without locking and then discard any that the writer may have replaced during the copy.
+	struct ThreadBuffer {
+		SDL_threadID threadId;
+		void *threadName;
+		Trace::Event *events;
+		SDL_atomic_t eventCount; // The number of events recorded by the thread, including events since replaced
+	};
+
+	// An event held after its thread released the buffer that recorded it
+	struct RetiredEvent {
+		Trace::Event event;
+		SDL_threadID threadId;
+		const char *threadName;
+	};
+
+	// Return the calling thread's trace buffer, assigning one if needed, or NULL if all buffers are in use
+	Trace::ThreadBuffer *getThreadBuffer ();
+
+	// Copy held events from the specified buffer into destList. Events that the owning thread may have replaced during the copy are discarded.
+	void copyThreadEvents (Trace::ThreadBuffer *buffer, std::vector<Trace::RetiredEvent> *destList);
+
+	// Buffers at indexes below threadBufferCount have been allocated. A buffer's events are set before threadBufferCount advances past it. threadId is zero for a released buffer, and changes only while threadBufferMutex is held by the thread claiming or releasing the buffer, so a thread never matches a buffer owned by another thread.
+	Trace::ThreadBuffer threadBuffers[Trace::MaxThreadCount];
+	SDL_atomic_t threadBufferCount;
+	std::vector<int> freeBufferIndexes;
+	SDL_mutex *threadBufferMutex;
+	SDL_atomic_t droppedEventCount; // Events discarded because no buffer was available, or replaced before or after their buffer was released
+
+	// Ring of retired events, accessed only while threadBufferMutex is held
+	Trace::RetiredEvent *retiredEvents;
+	int retiredEventCount; // The number of events retired, including events since replaced
+};
+
+#endif
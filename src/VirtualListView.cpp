@@ -0,0 +1,295 @@
+/*
+* Copyright 2018-2022 Membrane Software <author@membranesoftware.com> https://membranesoftware.com
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+* this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+* this list of conditions and the following disclaimer in the documentation
+* and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors
+* may be used to endorse or promote products derived from this software without
+* specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "Config.h"
+#include <stdlib.h>
+#include <math.h>
+#include <vector>
+#include "SDL2/SDL.h"
+#include "ClassId.h"
+#include "UiConfiguration.h"
+#include "Widget.h"
+#include "Panel.h"
+#include "VirtualListView.h"
+
+VirtualListView::VirtualListView (float viewWidth, float viewHeight, float rowHeight, const VirtualListView::DataSourceContext &dataSource)
+: Panel ()
+, itemCount (0)
+, rowHeight (rowHeight)
+, scrollPosition (0.0f)
+, firstVisibleItemIndex (0)
+, dataSource (dataSource)
+, shouldRefreshRows (true)
+, shouldRebindRows (false)
+, rowMutex (NULL)
+{
+	classId = ClassId::VirtualListView;
+	rowMutex = SDL_CreateMutex ();
+	if (this->rowHeight < 1.0f) {
+		this->rowHeight = 1.0f;
+	}
+	setFixedSize (true, viewWidth, viewHeight);
+}
+
+VirtualListView::~VirtualListView () {
+	if (rowMutex) {
+		SDL_DestroyMutex (rowMutex);
+		rowMutex = NULL;
+	}
+}
+
+bool VirtualListView::isWidgetType (Widget *widget) {
+	return (widget && (widget->classId == ClassId::VirtualListView));
+}
+
+VirtualListView *VirtualListView::castWidget (Widget *widget) {
+	return (VirtualListView::isWidgetType (widget) ? (VirtualListView *) widget : NULL);
+}
+
+void VirtualListView::setItemCount (int count) {
+	if (count < 0) {
+		count = 0;
+	}
+	if (count == itemCount) {
+		return;
+	}
+	itemCount = count;
+	if (scrollPosition > getMaxScrollPosition ()) {
+		scrollPosition = getMaxScrollPosition ();
+	}
+	shouldRefreshRows = true;
+}
+
+void VirtualListView::setRowHeight (float height) {
+	if (height < 1.0f) {
+		height = 1.0f;
+	}
+	if (FLOAT_EQUALS (height, rowHeight)) {
+		return;
+	}
+	rowHeight = height;
+	if (scrollPosition > getMaxScrollPosition ()) {
+		scrollPosition = getMaxScrollPosition ();
+	}
+	shouldRefreshRows = true;
+}
+
+void VirtualListView::setViewSize (float viewWidth, float viewHeight) {
+	setFixedSize (true, viewWidth, viewHeight);
+	if (scrollPosition > getMaxScrollPosition ()) {
+		scrollPosition = getMaxScrollPosition ();
+	}
+	shouldRefreshRows = true;
+}
+
+float VirtualListView::getMaxScrollPosition () {
+	double h;
+
+	h = (((double) itemCount) * rowHeight) - height;
+	if (h < 0.0f) {
+		h = 0.0f;
+	}
+	return ((float) h);
+}
+
+void VirtualListView::setScrollPosition (float position) {
+	float max;
+
+	max = getMaxScrollPosition ();
+	if (position > max) {
+		position = max;
+	}
+	if (position < 0.0f) {
+		position = 0.0f;
+	}
+	if (FLOAT_EQUALS (position, scrollPosition)) {
+		return;
+	}
+	scrollPosition = position;
+	shouldRefreshRows = true;
+}
+
+void VirtualListView::scrollToItem (int itemIndex) {
+	float top, bottom;
+
+	if ((itemIndex < 0) || (itemIndex >= itemCount)) {
+		return;
+	}
+	top = (float) (((double) itemIndex) * rowHeight);
+	bottom = top + rowHeight;
+	if (top < scrollPosition) {
+		setScrollPosition (top);
+	}
+	else if (bottom > (scrollPosition + height)) {
+		setScrollPosition (bottom - height);
+	}
+}
+
+void VirtualListView::refreshItems () {
+	shouldRebindRows = true;
+	shouldRefreshRows = true;
+}
+
+Widget *VirtualListView::getItemRow (int itemIndex) {
+	Widget *row;
+	int slot;
+
+	row = NULL;
+	SDL_LockMutex (rowMutex);
+	if ((itemIndex >= 0) && (! rowPool.empty ())) {
+		slot = itemIndex % (int) rowPool.size ();
+		if (rowItemIndexes[slot] == itemIndex) {
+			row = rowPool[slot];
+		}
+	}
+	SDL_UnlockMutex (rowMutex);
+
+	return (row);
+}
+
+int VirtualListView::getRowItemIndex (Widget *rowWidget) {
+	int i, count, result;
+
+	result = -1;
+	SDL_LockMutex (rowMutex);
+	count = (int) rowPool.size ();
+	for (i = 0; i < count; ++i) {
+		if (rowPool[i] == rowWidget) {
+			result = rowItemIndexes[i];
+			break;
+		}
+	}
+	SDL_UnlockMutex (rowMutex);
+
+	return (result);
+}
+
+void VirtualListView::doUpdate (int msElapsed) {
+	if (shouldRefreshRows) {
+		shouldRefreshRows = false;
+		resetRowPool ();
+		refreshRows ();
+	}
+	Panel::doUpdate (msElapsed);
+}
+
+bool VirtualListView::doProcessMouseState (const Widget::MouseState &mouseState) {
+	int delta;
+
+	if (Panel::doProcessMouseState (mouseState)) {
+		return (true);
+	}
+	if (! mouseState.isEntered) {
+		return (false);
+	}
+	delta = mouseState.wheelDown - mouseState.wheelUp;
+	if (delta == 0) {
+		return (false);
+	}
+	setScrollPosition (scrollPosition + ((float) delta * height * UiConfiguration::instance->mouseWheelScrollSpeed));
+	return (true);
+}
+
+void VirtualListView::resetRowPool () {
+	std::vector<int>::iterator i, end;
+	Widget *row;
+	int count;
+
+	// One more row than fits in the view covers a partially visible row at each edge
+	count = (int) ceilf (height / rowHeight) + 1;
+	SDL_LockMutex (rowMutex);
+	if (count == (int) rowPool.size ()) {
+		SDL_UnlockMutex (rowMutex);
+		return;
+	}
+	while (count > (int) rowPool.size ()) {
+		row = dataSource.createRow ? dataSource.createRow (dataSource.callbackData) : NULL;
+		if (! row) {
+			break;
+		}
+		row->isVisible = false;
+		addWidget (row);
+		rowPool.push_back (row);
+		rowItemIndexes.push_back (-1);
+	}
+	while (count < (int) rowPool.size ()) {
+		rowPool.back ()->isDestroyed = true;
+		rowPool.pop_back ();
+		rowItemIndexes.pop_back ();
+	}
+
+	// Each item binds to the row at slot (itemIndex % pool size), so existing bindings are invalid after a pool size change
+	i = rowItemIndexes.begin ();
+	end = rowItemIndexes.end ();
+	while (i != end) {
+		*i = -1;
+		++i;
+	}
+	SDL_UnlockMutex (rowMutex);
+}
+
+void VirtualListView::refreshRows () {
+	Widget *row;
+	int poolsize, first, item, slot;
+
+	SDL_LockMutex (rowMutex);
+	poolsize = (int) rowPool.size ();
+	if (poolsize <= 0) {
+		SDL_UnlockMutex (rowMutex);
+		shouldRebindRows = false;
+		return;
+	}
+
+	first = (int) floorf (scrollPosition / rowHeight);
+	if (first < 0) {
+		first = 0;
+	}
+	firstVisibleItemIndex = first;
+
+	// Consecutive item indexes map to distinct slots, so a scroll of one row rebinds only the row that leaves the view
+	for (item = first; item < (first + poolsize); ++item) {
+		slot = item % poolsize;
+		row = rowPool[slot];
+		if (item >= itemCount) {
+			row->isVisible = false;
+			rowItemIndexes[slot] = -1;
+			continue;
+		}
+		if (shouldRebindRows || (rowItemIndexes[slot] != item)) {
+			rowItemIndexes[slot] = item;
+			if (dataSource.bindRow) {
+				dataSource.bindRow (dataSource.callbackData, row, item);
+			}
+		}
+		row->position.assign (0.0f, (float) ((((double) item) * rowHeight) - scrollPosition));
+		row->isVisible = true;
+	}
+	shouldRebindRows = false;
+	SDL_UnlockMutex (rowMutex);
+}
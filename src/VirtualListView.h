@@ -0,0 +1,122 @@
+/*
+* Copyright 2018-2022 Membrane Software <author@membranesoftware.com> https://membranesoftware.com
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+* this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+* this list of conditions and the following disclaimer in the documentation
+* and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors
+* may be used to endorse or promote products derived from this software without
+* specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*/
+// Panel that shows a scrolling list of rows from a data source of any size, binding a small pool of row widgets to the items currently in view
+
+#ifndef VIRTUAL_LIST_VIEW_H
+#define VIRTUAL_LIST_VIEW_H
+
+#include <vector>
+#include "Widget.h"
+#include "Panel.h"
+
+class VirtualListView : public Panel {
+public:
+	typedef Widget *(*CreateRowCallback) (void *data);
+	typedef void (*BindRowCallback) (void *data, Widget *rowWidget, int itemIndex);
+	struct DataSourceContext {
+		VirtualListView::CreateRowCallback createRow;
+		VirtualListView::BindRowCallback bindRow;
+		void *callbackData;
+		DataSourceContext ():
+			createRow (NULL),
+			bindRow (NULL),
+			callbackData (NULL) { }
+		DataSourceContext (VirtualListView::CreateRowCallback createRow, VirtualListView::BindRowCallback bindRow, void *callbackData):
+			createRow (createRow),
+			bindRow (bindRow),
+			callbackData (callbackData) { }
+	};
+
+	// dataSource.createRow is invoked to create each pooled row widget, and dataSource.bindRow is invoked to set a pooled row widget's content for an item index whenever that item scrolls into view
+	VirtualListView (float viewWidth, float viewHeight, float rowHeight, const VirtualListView::DataSourceContext &dataSource);
+	virtual ~VirtualListView ();
+
+	// Read-only data members
+	int itemCount;
+	float rowHeight;
+	float scrollPosition;
+	int firstVisibleItemIndex;
+
+	// Set the number of items available from the data source
+	void setItemCount (int count);
+
+	// Set the height of each row
+	void setRowHeight (float height);
+
+	// Set the size of the list's view area
+	void setViewSize (float viewWidth, float viewHeight);
+
+	// Set the list's scroll position, measured in pixels from the top of the first row
+	void setScrollPosition (float position);
+
+	// Scroll the list as needed to show the specified item index
+	void scrollToItem (int itemIndex);
+
+	// Bind all pooled rows again on the next update, as appropriate when item content changes without a change in item count
+	void refreshItems ();
+
+	// Return the row widget currently bound to the specified item index, or NULL if the item is not in view
+	Widget *getItemRow (int itemIndex);
+
+	// Return the item index currently bound to the specified row widget, or -1 if the widget is not a bound row
+	int getRowItemIndex (Widget *rowWidget);
+
+	// Return a boolean value indicating if the provided Widget is a member of this class
+	static bool isWidgetType (Widget *widget);
+
+	// Return a typecasted pointer to the provided widget, or NULL if the widget does not appear to be of the correct type
+	static VirtualListView *castWidget (Widget *widget);
+
+protected:
+	// Execute operations to update object state as appropriate for an elapsed millisecond time period
+	virtual void doUpdate (int msElapsed);
+
+	// Execute operations appropriate when the widget receives new mouse state and return a boolean value indicating if mouse wheel events were consumed and should no longer be processed
+	virtual bool doProcessMouseState (const Widget::MouseState &mouseState);
+
+private:
+	// Return the maximum scroll position for the current item count, row height, and view height
+	float getMaxScrollPosition ();
+
+	// Create or destroy pooled rows as needed for the current view height and row height
+	void resetRowPool ();
+
+	// Bind and position pooled rows for the items in view at the current scroll position
+	void refreshRows ();
+
+	VirtualListView::DataSourceContext dataSource;
+	std::vector<Widget *> rowPool;
+	std::vector<int> rowItemIndexes;
+	bool shouldRefreshRows;
+	bool shouldRebindRows;
+	SDL_mutex *rowMutex;
+};
+
+#endif
@@ -29,6 +29,7 @@
 */
 #include "Config.h"
 #include <stdlib.h>
+#include <vector>
 #include <math.h>
 #include "SDL2/SDL.h"
 #include "App.h"
@@ -39,6 +40,7 @@
 #include "Widget.h"
 
 const int Widget::MinZLevel = -10;
+int Widget::refreshGeneration = 0;
 
 Widget::Widget ()
 : id (0)
@@ -55,12 +57,20 @@ Widget::Widget ()
 , screenY (0.0f)
 , isKeyFocused (false)
 , tooltipAlignment (Widget::BottomAlignment)
+, parentWidget (NULL)
+, isLayoutDirty (true)
 , width (0.0f)
 , height (0.0f)
 , destroyClock (0)
 , isFixedCenter (false)
 , isMouseEntered (false)
 , isMousePressed (false)
+, drawKey (0)
+, drawKeySequence (0)
+, drawCacheKey (0)
+, drawCacheDrawnCount (0)
+, drawCacheCulledCount (0)
+, lastRefreshGeneration (-1)
 , refcount (0)
 , refcountMutex (NULL)
 {
@@ -68,6 +78,7 @@ Widget::Widget ()
 }
 
 Widget::~Widget () {
+	clearDrawCache ();
 	if (refcountMutex) {
 		SDL_DestroyMutex (refcountMutex);
 		refcountMutex = NULL;
@@ -131,7 +142,6 @@ void Widget::update (int msElapsed, float originX, float originY) {
 		return;
 	}
 
-	position.update (msElapsed);
 	screenX = position.x + originX;
 	screenY = position.y + originY;
 	hasScreenPosition = true;
@@ -139,7 +149,6 @@ void Widget::update (int msElapsed, float originX, float originY) {
 	doUpdate (msElapsed);
 
 	if (isFixedCenter) {
-		fixedCenterPosition.update (msElapsed);
 		x = fixedCenterPosition.x - (width / 2.0f);
 		y = fixedCenterPosition.y - (height / 2.0f);
 		if (! position.equals (x, y)) {
@@ -158,29 +167,203 @@ void Widget::doUpdate (int msElapsed) {
 	// Default implementation does nothing
 }
 
-void Widget::draw (SDL_Texture *targetTexture, float originX, float originY) {
+bool Widget::isDrawVisible (const SDL_Rect &clipRect, float originX, float originY) {
+	int x, y;
+
+	x = (int) (originX + position.x);
+	y = (int) (originY + position.y);
+	if (((x + (int) width) <= clipRect.x) || (x >= (clipRect.x + clipRect.w))) {
+		return (false);
+	}
+	if (((y + (int) height) <= clipRect.y) || (y >= (clipRect.y + clipRect.h))) {
+		return (false);
+	}
+	return (true);
+}
+
+void Widget::draw (DrawList *drawList, float originX, float originY) {
+	std::vector<DrawList::WidgetRange> childranges;
+	DrawList::WidgetRange range;
+	uint64_t key;
+	int rangeindex;
+
 	if (isDestroyed) {
 		return;
 	}
-	if (targetTexture) {
-		if (! isTextureTargetDrawEnabled) {
-			return;
+	if (drawList->targetTexture && (! isTextureTargetDrawEnabled)) {
+		return;
+	}
+	if (! drawList->isRecording ()) {
+		doDraw (drawList, originX, originY);
+		return;
+	}
+
+	key = findDrawKey (drawList, drawList->clipRect, originX, originY);
+	rangeindex = drawList->getWidgetRangeCount ();
+	range.widget = this;
+	range.originX = originX;
+	range.originY = originY;
+	range.commandStart = drawList->getCommandCount ();
+	range.drawnCount = drawList->drawnWidgetCount;
+	range.culledCount = drawList->culledWidgetCount;
+	if ((key != 0) && (key == drawCacheKey)) {
+		replayDrawCache (drawList);
+		++(drawList->cachedWidgetCount);
+		range.commandEnd = drawList->getCommandCount ();
+		range.drawnCount = drawList->drawnWidgetCount - range.drawnCount;
+		range.culledCount = drawList->culledWidgetCount - range.culledCount;
+		drawList->endWidgetRange (rangeindex, range, NULL);
+		return;
+	}
+
+	doDraw (drawList, originX, originY);
+	range.commandEnd = drawList->getCommandCount ();
+	range.drawnCount = drawList->drawnWidgetCount - range.drawnCount;
+	range.culledCount = drawList->culledWidgetCount - range.culledCount;
+	drawList->endWidgetRange (rangeindex, range, &childranges);
+	if (key != 0) {
+		storeDrawCache (drawList, key, range.commandStart, childranges, range.drawnCount, range.culledCount);
+	}
+	else if (drawCacheKey != 0) {
+		clearDrawCache ();
+	}
+}
+
+void Widget::replayDrawCache (DrawList *drawList) {
+	std::vector<DrawList::WidgetRange>::iterator i, end;
+	int pos;
+
+	pos = 0;
+	i = drawCacheChildren.begin ();
+	end = drawCacheChildren.end ();
+	while (i != end) {
+		drawList->addCommands (drawCacheCommands, pos, i->commandStart);
+		i->widget->draw (drawList, i->originX, i->originY);
+		pos = i->commandStart;
+		++i;
+	}
+	drawList->addCommands (drawCacheCommands, pos, (int) drawCacheCommands.size ());
+	drawList->drawnWidgetCount += drawCacheDrawnCount;
+	drawList->culledWidgetCount += drawCacheCulledCount;
+}
+
+void Widget::storeDrawCache (DrawList *drawList, uint64_t key, int commandStart, const std::vector<DrawList::WidgetRange> &childRanges, int drawnCount, int culledCount) {
+	std::vector<DrawList::WidgetRange>::const_iterator i, end;
+	DrawList::WidgetRange child;
+	int pos, count;
+
+	count = drawList->getCommandCount () - commandStart;
+	i = childRanges.cbegin ();
+	end = childRanges.cend ();
+	while (i != end) {
+		count -= (i->commandEnd - i->commandStart);
+		++i;
+	}
+	if (count > DrawList::MaxRetainedCommandCount) {
+		if (drawCacheKey != 0) {
+			clearDrawCache ();
 		}
-		SDL_SetRenderTarget (App::instance->render, targetTexture);
+		return;
+	}
+
+	// References to the new set of children are acquired before clearDrawCache releases the previous set, since the two sets usually share most items
+	i = childRanges.cbegin ();
+	end = childRanges.cend ();
+	while (i != end) {
+		i->widget->retain ();
+		++i;
+	}
+	clearDrawCache ();
+
+	drawCacheKey = key;
+	drawCacheDrawnCount = drawnCount;
+	drawCacheCulledCount = culledCount;
+	drawCacheCommands.reserve (count);
+	pos = commandStart;
+	i = childRanges.cbegin ();
+	end = childRanges.cend ();
+	while (i != end) {
+		drawList->getCommands (pos, i->commandStart, &drawCacheCommands);
+		child = *i;
+		child.commandStart = (int) drawCacheCommands.size ();
+		child.commandEnd = child.commandStart;
+		drawCacheChildren.push_back (child);
+		drawCacheDrawnCount -= i->drawnCount;
+		drawCacheCulledCount -= i->culledCount;
+		pos = i->commandEnd;
+		++i;
+	}
+	drawList->getCommands (pos, drawList->getCommandCount (), &drawCacheCommands);
+}
+
+void Widget::clearDrawCache () {
+	std::vector<DrawList::WidgetRange>::iterator i, end;
+
+	i = drawCacheChildren.begin ();
+	end = drawCacheChildren.end ();
+	while (i != end) {
+		i->widget->release ();
+		++i;
 	}
-	doDraw (targetTexture, originX, originY);
-	if (targetTexture) {
-		SDL_SetRenderTarget (App::instance->render, NULL);
+	drawCacheChildren.clear ();
+	drawCacheKey = 0;
+	drawCacheDrawnCount = 0;
+	drawCacheCulledCount = 0;
+	std::vector<DrawList::Command> ().swap (drawCacheCommands);
+}
+
+uint64_t Widget::findDrawKey (DrawList *drawList, const SDL_Rect &clipRect, float originX, float originY) {
+	if ((drawKeySequence != drawList->sequence) || (drawList->sequence <= 0)) {
+		drawKey = getDrawKey (drawList, clipRect, originX, originY);
+		drawKeySequence = drawList->sequence;
 	}
+	return (drawKey);
 }
 
-void Widget::doDraw (SDL_Texture *targetTexture, float originX, float originY) {
+void Widget::doDraw (DrawList *drawList, float originX, float originY) {
 	// Default implementation does nothing
 }
 
+uint64_t Widget::getDrawKey (DrawList *drawList, const SDL_Rect &clipRect, float originX, float originY) {
+	// Default implementation returns zero, disabling retained draw commands
+	return (0);
+}
+
 void Widget::refresh () {
-	// Superclass method takes no action
 	doRefresh ();
+	isLayoutDirty = false;
+	lastRefreshGeneration = Widget::refreshGeneration;
+}
+
+bool Widget::isRefreshNeeded () {
+	return (isLayoutDirty || (lastRefreshGeneration != Widget::refreshGeneration));
+}
+
+void Widget::invalidateLayout () {
+	Widget *widget;
+
+	// A dirty widget's ancestors are always dirty, so propagation can stop at the first ancestor already marked
+	isLayoutDirty = true;
+	widget = parentWidget;
+	while (widget && (! widget->isLayoutDirty)) {
+		widget->isLayoutDirty = true;
+		widget = widget->parentWidget;
+	}
+}
+
+void Widget::invalidateAllLayouts () {
+	++(Widget::refreshGeneration);
+}
+
+void Widget::assignSize (float sizeWidth, float sizeHeight) {
+	bool changed;
+
+	changed = (! FLOAT_EQUALS (width, sizeWidth)) || (! FLOAT_EQUALS (height, sizeHeight));
+	width = sizeWidth;
+	height = sizeHeight;
+	if (changed) {
+		invalidateLayout ();
+	}
 }
 
 void Widget::doRefresh () {
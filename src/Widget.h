@@ -33,10 +33,12 @@
 #define WIDGET_H
 
 #include <stdint.h>
+#include <vector>
 #include "SDL2/SDL.h"
 #include "StdString.h"
 #include "StringList.h"
 #include "Position.h"
+#include "DrawList.h"
 
 class Widget {
 public:
@@ -130,6 +132,8 @@ public:
 	bool isKeyFocused;
 	StdString tooltipText;
 	Widget::Alignment tooltipAlignment;
+	Widget *parentWidget; // The panel holding the widget as a child, or NULL if the widget has not been added to a panel
+	bool isLayoutDirty; // Set if the widget's size or visibility, or that of any descendant, may have changed since the widget's last refresh
 
 	// Read-only data members. Widget subclasses should maintain these values for proper layout handling.
 	float width, height;
@@ -149,12 +153,27 @@ public:
 	// Execute operations to update object state as appropriate for an elapsed millisecond time period and origin position
 	void update (int msElapsed, float originX, float originY);
 
-	// Add draw commands for execution by the App. If targetTexture is non-NULL, render to that texture instead the default render target.
-	void draw (SDL_Texture *targetTexture = NULL, float originX = 0.0f, float originY = 0.0f);
+	// Add draw commands to drawList. If the list holds a non-NULL targetTexture, commands render to that texture instead of the default render target.
+	void draw (DrawList *drawList, float originX = 0.0f, float originY = 0.0f);
+
+	// Return a boolean value indicating if content drawn by the widget at the specified origin position could appear within clipRect
+	virtual bool isDrawVisible (const SDL_Rect &clipRect, float originX, float originY);
+
+	// Return the widget's draw key for the recording sequence of drawList, computing it with the getDrawKey method if not already known
+	uint64_t findDrawKey (DrawList *drawList, const SDL_Rect &clipRect, float originX, float originY);
 
 	// Refresh the widget's layout as appropriate for the current set of UiConfiguration values
 	void refresh ();
 
+	// Return a boolean value indicating if a refresh of the widget's parent should also refresh the widget, because its layout was invalidated or UiConfiguration values changed since its last refresh
+	bool isRefreshNeeded ();
+
+	// Set isLayoutDirty for the widget and each of its ancestors, causing the next refresh pass to include them
+	void invalidateLayout ();
+
+	// Require the next refresh pass to include every widget, as appropriate when UiConfiguration values have changed
+	static void invalidateAllLayouts ();
+
 	// Return the topmost child widget at the specified screen position, or NULL if no such widget was found. If requireMouseHoverEnabled is true, return a widget only if it has enabled the isMouseHoverEnabled option.
 	virtual Widget *findWidget (float screenPositionX, float screenPositionY, bool requireMouseHoverEnabled = false);
 
@@ -168,6 +187,7 @@ public:
 	bool processKeyEvent (SDL_Keycode keycode, bool isShiftDown, bool isControlDown);
 
 	struct MouseState {
+		int positionX, positionY;
 		int positionDeltaX, positionDeltaY;
 		int wheelUp;
 		int wheelDown;
@@ -177,7 +197,7 @@ public:
 		bool isLeftClickReleased;
 		bool isLeftClickEntered;
 		bool isLongPressed;
-		MouseState (): positionDeltaX (0), positionDeltaY (0), wheelUp (0), wheelDown (0), isEntered (false), enterDeltaX (0.0f), enterDeltaY (0.0f), isLeftClicked (false), isLeftClickReleased (false), isLeftClickEntered (false), isLongPressed (false) { }
+		MouseState (): positionX (-1), positionY (-1), positionDeltaX (0), positionDeltaY (0), wheelUp (0), wheelDown (0), isEntered (false), enterDeltaX (0.0f), enterDeltaY (0.0f), isLeftClicked (false), isLeftClickReleased (false), isLeftClickEntered (false), isLongPressed (false) { }
 	};
 	// Update the widget as appropriate for the specified mouse state and return a boolean value indicating if mouse wheel events were consumed and should no longer be processed
 	bool processMouseState (const Widget::MouseState &mouseState);
@@ -242,8 +262,11 @@ protected:
 	// Execute subclass-specific operations to update object state as appropriate for an elapsed millisecond time period
 	virtual void doUpdate (int msElapsed);
 
-	// Add subclass-specific draw commands for execution by the App. If targetTexture is non-NULL, it has been set as the render target and draw commands should adjust coordinates as appropriate.
-	virtual void doDraw (SDL_Texture *targetTexture, float originX, float originY);
+	// Add subclass-specific draw commands to drawList. If the list holds a non-NULL targetTexture, draw commands render to that texture and should adjust coordinates as appropriate.
+	virtual void doDraw (DrawList *drawList, float originX, float originY);
+
+	// Return a hash of all values that affect commands added by doDraw with the specified clip rectangle and origin position, or zero if the widget's draw commands should not be retained for replay
+	virtual uint64_t getDrawKey (DrawList *drawList, const SDL_Rect &clipRect, float originX, float originY);
 
 	// Execute subclass-specific operations to refresh the widget's layout as appropriate for the current set of UiConfiguration values
 	virtual void doRefresh ();
@@ -266,7 +289,32 @@ protected:
 	bool isMouseEntered;
 	bool isMousePressed;
 
+	// Retained draw commands, accessed only by the thread that records draw lists. drawCacheCommands holds only commands added by the widget itself; drawCacheChildren holds a range for each child drawn during the recording, with commandStart set to the index in drawCacheCommands where the child's commands belong. The widget holds a reference to each child in drawCacheChildren.
+	uint64_t drawKey;
+	int64_t drawKeySequence;
+	uint64_t drawCacheKey;
+	std::vector<DrawList::Command> drawCacheCommands;
+	std::vector<DrawList::WidgetRange> drawCacheChildren;
+	int drawCacheDrawnCount;
+	int drawCacheCulledCount;
+
+	// Add retained draw commands to drawList, drawing each retained child at its recorded position
+	void replayDrawCache (DrawList *drawList);
+
+	// Store commands added to drawList since commandStart as retained draw commands for the specified key, replacing commands from childRanges with child references
+	void storeDrawCache (DrawList *drawList, uint64_t key, int commandStart, const std::vector<DrawList::WidgetRange> &childRanges, int drawnCount, int culledCount);
+
+	// Clear retained draw commands and release retained child references
+	void clearDrawCache ();
+
+	// Assign the widget's width and height values, invalidating the layout of the widget and its ancestors if either value changed
+	void assignSize (float sizeWidth, float sizeHeight);
+
 private:
+	// The refreshGeneration value at the widget's last refresh. Widgets with an older value are refreshed by the next refresh pass that reaches them.
+	static int refreshGeneration;
+	int lastRefreshGeneration;
+
 	int refcount;
 	SDL_mutex *refcountMutex;
 };